@@ -12,80 +12,549 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {
+  own_page_cleaner_ = std::make_unique<PageCleaner>(std::vector<BufferPoolManagerInstance *>{this});
+  page_cleaner_ = own_page_cleaner_.get();
+}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
     : pool_size_(pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(pool_size) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
   // We allocate a consecutive memory space for the buffer pool.
   pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  replacer_ = Replacer::Create(replacer_type, pool_size);
+  in_replacer_ = std::make_unique<std::atomic<bool>[]>(pool_size_);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
+    in_replacer_[i] = false;
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  own_page_cleaner_.reset();
+  // The reads write into the frames.
+  for (auto &[frame_id, pending_read] : pending_reads_) {
+    pending_read.done_.wait();
+  }
   delete[] pages_;
-  delete replacer_;
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
-  // Make sure you call DiskManager::WritePage!
-  return false;
+  ValidatePageId(page_id);
+  frame_id_t frame_id;
+  // Pin the page so that it cannot be evicted while we write it out.
+  if (!page_table_.Find(page_id, &frame_id) || !TryPin(frame_id, page_id)) {
+    std::scoped_lock latch(latch_);
+    if (!page_table_.Find(page_id, &frame_id) || !TryPin(frame_id, page_id)) {
+      return false;
+    }
+  }
+  Page *page = &pages_[frame_id];
+  page->is_dirty_ = false;
+  disk_manager_->WritePage(page_id, page->GetData());
+  UnpinFrame(frame_id);
+  return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
+  for (size_t i = 0; i < pool_size_; ++i) {
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page *page = &pages_[frame_id];
+    page_id_t page_id = page->GetPageId();
+    // Frames that are free or being evicted are skipped, an evicted page is written back by its evictor.
+    if (page_id == INVALID_PAGE_ID || !TryPin(frame_id, page_id)) {
+      continue;
+    }
+    if (page->IsDirty()) {
+      page->is_dirty_ = false;
+      disk_manager_->WritePage(page_id, page->GetData());
+    }
+    UnpinFrame(frame_id);
+  }
 }
 
-Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
-  // 0.   Make sure you call AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-  return nullptr;
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) { return NewPgImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  std::unique_lock latch(latch_);
+  frame_id_t frame_id;
+  if (!FindFrame(&latch, &frame_id, strategy)) {
+    return nullptr;
+  }
+  *page_id = AllocatePage();
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = *page_id;
+  page->is_dirty_ = false;
+  replacer_->RecordAccess(frame_id);
+  page_table_.Insert(*page_id, frame_id);
+  AddToRing(strategy, frame_id, *page_id);
+  // Publishing the pin count makes the frame visible to optimistic fetches.
+  page->pin_count_.store(1, std::memory_order_release);
+  return page;
 }
 
-Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-  // 2.     If R is dirty, write it back to the disk.
-  // 3.     Delete R from the page table and insert P.
-  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  return nullptr;
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) { return FetchPgImp(page_id, nullptr); }
+
+Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  ValidatePageId(page_id);
+  frame_id_t frame_id;
+  // Fast path: the page is cached, pin it without taking the latch.
+  if (page_table_.Find(page_id, &frame_id) && TryPin(frame_id, page_id)) {
+    return &pages_[frame_id];
+  }
+
+  std::unique_lock latch(latch_);
+  while (true) {
+    // Another thread may have brought the page in while we were waiting for the latch. Frames in the page table
+    // cannot be in the middle of an eviction while we hold the latch, so pinning it fails only if the page is being
+    // prefetched.
+    while (page_table_.Find(page_id, &frame_id)) {
+      if (TryPin(frame_id, page_id)) {
+        return &pages_[frame_id];
+      }
+      auto it = pending_reads_.find(frame_id);
+      BUSTUB_ASSERT(it != pending_reads_.end(), "A cached page must be pinnable while holding the latch.");
+      // Wait for the read without holding up the rest of the pool. If it failed, the page is gone from the page table
+      // and is read in below.
+      auto done = it->second.done_;
+      latch.unlock();
+      done.wait();
+      latch.lock();
+      ReapPendingReads();
+    }
+    if (!FindFrame(&latch, &frame_id, strategy)) {
+      return nullptr;
+    }
+    // Waiting for a frame gives up the latch, and the page may have been read in by someone else in the meantime.
+    frame_id_t cached_frame_id;
+    if (!page_table_.Find(page_id, &cached_frame_id)) {
+      break;
+    }
+    FreeFrame(frame_id);
+  }
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page_table_.Insert(page_id, frame_id);
+  AddToRing(strategy, frame_id, page_id);
+  // Read the page without holding up the rest of the pool. Until it is published, the frame is pending like a
+  // prefetched one, so that other fetches of the page wait for it and nobody claims the frame.
+  std::promise<bool> read;
+  pending_reads_.emplace(frame_id, PendingRead{nullptr, read.get_future().share()});
+  latch.unlock();
+  disk_manager_->ReadPage(page_id, page->GetData());
+  latch.lock();
+  pending_reads_.erase(frame_id);
+  replacer_->RecordAccess(frame_id);
+  page->pin_count_.store(1, std::memory_order_release);
+  read.set_value(true);
+  return page;
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
-  // 0.   Make sure you call DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  return false;
+  ValidatePageId(page_id);
+  std::unique_lock latch(latch_);
+  frame_id_t frame_id;
+  Page *page;
+  while (true) {
+    // A page that is being prefetched cannot be claimed, let its read land first. The read would otherwise complete
+    // into a frame that holds another page by then.
+    while (page_table_.Find(page_id, &frame_id) && pending_reads_.count(frame_id) != 0) {
+      auto done = pending_reads_[frame_id].done_;
+      latch.unlock();
+      done.wait();
+      latch.lock();
+      ReapPendingReads();
+    }
+    if (!page_table_.Find(page_id, &frame_id)) {
+      DeallocatePage(page_id);
+      return true;
+    }
+    page = &pages_[frame_id];
+    int unpinned = 0;
+    if (page->pin_count_.compare_exchange_strong(unpinned, EVICTING_PIN_COUNT)) {
+      break;
+    }
+    // The page cleaner may be writing the page out, its pin goes away once the write is done. A pin of a caller
+    // makes the delete fail.
+    if (cleaning_frames_.load() == 0) {
+      return false;
+    }
+    frame_available_.wait_for(latch, FRAME_WAIT_TIMEOUT);
+  }
+  page_table_.Remove(page_id);
+  DeallocatePage(page_id);
+  page->ResetMemory();
+  replacer_->Remove(frame_id);
+  in_replacer_[frame_id] = false;
+  FreeFrame(frame_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].GetPageId() != page_id) {
+    return false;
+  }
+  // Mark the page dirty before giving up the pin, so that an evictor claiming the frame sees the flag.
+  if (is_dirty) {
+    pages_[frame_id].is_dirty_ = true;
+  }
+  return UnpinFrame(frame_id);
+}
+
+bool BufferPoolManagerInstance::TryPin(frame_id_t frame_id, page_id_t page_id, bool reference) {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load(std::memory_order_acquire);
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acq_rel));
+  // The frame cannot change pages while we hold a pin, but it may have done so between the lookup and the pin.
+  if (page->GetPageId() != page_id) {
+    UnpinFrame(frame_id);
+    return false;
+  }
+  if (reference) {
+    replacer_->RecordAccess(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load(std::memory_order_acquire);
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_acq_rel));
+  // Only frames that the replacer has forgotten about need to be handed back to it.
+  if (pin_count == 1 && !in_replacer_[frame_id].exchange(true)) {
+    replacer_->Unpin(frame_id);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FindVictimFrame(std::unique_lock<std::mutex> *latch, frame_id_t *frame_id,
+                                                bool wait) {
+  while (true) {
+    ReapPendingReads();
+    // A fetch that looked a frame up before it was freed may still hold a transient pin on it, try the next one.
+    for (size_t i = 0; i < free_list_.size(); i++) {
+      frame_id_t free_frame = free_list_.front();
+      free_list_.pop_front();
+      int unpinned = 0;
+      if (pages_[free_frame].pin_count_.compare_exchange_strong(unpinned, EVICTING_PIN_COUNT)) {
+        *frame_id = free_frame;
+        return true;
+      }
+      free_list_.push_back(free_frame);
+    }
+
+    frame_id_t victim;
+    std::vector<frame_id_t> unlogged_frames;
+    while (replacer_->Victim(&victim)) {
+      // Forget the frame before looking at its pin count, so that a concurrent last unpin puts it back.
+      in_replacer_[victim] = false;
+      Page *page = &pages_[victim];
+      if (page->GetPageId() == INVALID_PAGE_ID) {
+        continue;  // stale entry of a frame on the free list, left by a failed optimistic pin
+      }
+      int unpinned = 0;
+      if (!page->pin_count_.compare_exchange_strong(unpinned, EVICTING_PIN_COUNT)) {
+        continue;  // pinned again since it was unpinned; its next last unpin puts it back
+      }
+      if (!IsLogged(page)) {
+        page->pin_count_.store(0, std::memory_order_release);
+        unlogged_frames.push_back(victim);
+        continue;
+      }
+      EvictFrame(victim);
+      *frame_id = victim;
+      ReturnToReplacer(unlogged_frames);
+      return true;
+    }
+    ReturnToReplacer(unlogged_frames);
+    if (!wait) {
+      return false;
+    }
+    // Prefetched frames become evictable once their reads complete. Wait for one without holding the latch.
+    if (!pending_reads_.empty()) {
+      auto done = pending_reads_.begin()->second.done_;
+      latch->unlock();
+      done.wait();
+      latch->lock();
+      continue;
+    }
+    // Frames pinned by the page cleaner come back as soon as their write is done, and transient pins on free frames
+    // are dropped right away. Anything else is pinned by a caller, which we do not wait for.
+    if (cleaning_frames_.load() == 0 && free_list_.empty()) {
+      return false;
+    }
+    // The cleaner does not take the latch to signal, so a wake-up can be missed; bound the wait.
+    frame_available_.wait_for(*latch, FRAME_WAIT_TIMEOUT);
+  }
+}
+
+bool BufferPoolManagerInstance::FindFrame(std::unique_lock<std::mutex> *latch, frame_id_t *frame_id,
+                                          BufferAccessStrategy *strategy, bool wait) {
+  if (strategy != nullptr) {
+    auto &ring = strategy->rings_[this];
+    if (ring.entries_.size() == RingCapacity(strategy)) {
+      auto &entry = ring.entries_[ring.next_];
+      if (ReclaimRingFrame(entry.frame_id_, entry.page_id_)) {
+        *frame_id = entry.frame_id_;
+        return true;
+      }
+    }
+  }
+  return FindVictimFrame(latch, frame_id, wait);
+}
+
+void BufferPoolManagerInstance::AddToRing(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id) {
+  if (strategy == nullptr) {
+    return;
+  }
+  auto &ring = strategy->rings_[this];
+  if (ring.entries_.size() < RingCapacity(strategy)) {
+    ring.entries_.push_back({frame_id, page_id});
+    return;
+  }
+  ring.entries_[ring.next_] = {frame_id, page_id};
+  ring.next_ = (ring.next_ + 1) % ring.entries_.size();
 }
 
-bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) { return false; }
+bool BufferPoolManagerInstance::ReclaimRingFrame(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = &pages_[frame_id];
+  // The page may have been evicted and the frame reused for a page of someone else.
+  if (page->GetPageId() != page_id) {
+    return false;
+  }
+  // A page that is pinned, being cleaned or being read ahead stays where it is.
+  int unpinned = 0;
+  if (!page->pin_count_.compare_exchange_strong(unpinned, EVICTING_PIN_COUNT)) {
+    return false;
+  }
+  if (!IsLogged(page)) {
+    page->pin_count_.store(0, std::memory_order_release);
+    return false;
+  }
+  replacer_->Remove(frame_id);
+  in_replacer_[frame_id] = false;
+  EvictFrame(frame_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::FreeFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  page->pin_count_.store(0, std::memory_order_release);
+  free_list_.push_back(frame_id);
+  frame_available_.notify_all();
+}
+
+bool BufferPoolManagerInstance::IsLogged(Page *page) const {
+  // WAL: the page may only reach the disk after the log records that changed it.
+  return !page->IsDirty() || !enable_logging || log_manager_ == nullptr ||
+         page->GetLSN() <= log_manager_->GetPersistentLSN();
+}
+
+void BufferPoolManagerInstance::ReturnToReplacer(const std::vector<frame_id_t> &frame_ids) {
+  for (auto frame_id : frame_ids) {
+    // An unpin since the frame was passed over may have put it back already.
+    if (!in_replacer_[frame_id].exchange(true)) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  if (page->IsDirty()) {
+    // The page cleaner fell behind, write the page here and have it catch up.
+    disk_manager_->WritePage(page->GetPageId(), page->GetData());
+    page->is_dirty_ = false;
+    if (page_cleaner_ != nullptr) {
+      page_cleaner_->Wake();
+    }
+  }
+  page_table_.Remove(page->GetPageId());
+  page->page_id_ = INVALID_PAGE_ID;
+}
+
+void BufferPoolManagerInstance::PrefetchImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  frame_id_t frame_id;
+  std::vector<page_id_t> missing_page_ids;
+  for (auto page_id : page_ids) {
+    ValidatePageId(page_id);
+    if (!page_table_.Find(page_id, &frame_id)) {
+      missing_page_ids.push_back(page_id);
+    }
+  }
+  if (missing_page_ids.empty()) {
+    return;
+  }
+
+  auto batch = std::make_shared<std::vector<DiskRequest>>();
+  // The requests must not move once their futures are handed out.
+  batch->reserve(missing_page_ids.size());
+  std::unique_lock latch(latch_);
+  for (auto page_id : missing_page_ids) {
+    if (page_table_.Find(page_id, &frame_id)) {
+      continue;
+    }
+    // Read-ahead is not worth waiting for a frame.
+    if (!FindFrame(&latch, &frame_id, strategy, false)) {
+      break;
+    }
+    Page *page = &pages_[frame_id];
+    page->ResetMemory();
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    page_table_.Insert(page_id, frame_id);
+    AddToRing(strategy, frame_id, page_id);
+    // The pin count stays at EVICTING_PIN_COUNT until the read completes.
+    batch->emplace_back(false, page->GetData(), page_id);
+    pending_reads_.emplace(frame_id, PendingRead{batch, batch->back().done_});
+  }
+  if (!batch->empty()) {
+    disk_manager_->SubmitRequests(batch->data(), batch->size());
+  }
+}
+
+void BufferPoolManagerInstance::ReapPendingReads() {
+  for (auto it = pending_reads_.begin(); it != pending_reads_.end();) {
+    if (it->second.done_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      ++it;
+      continue;
+    }
+    frame_id_t frame_id = it->first;
+    Page *page = &pages_[frame_id];
+    if (it->second.done_.get()) {
+      // Count the read as an access, a frame without history would be the first victim of LRU-K.
+      replacer_->RecordAccess(frame_id);
+      page->pin_count_.store(0, std::memory_order_release);
+      if (!in_replacer_[frame_id].exchange(true)) {
+        replacer_->Unpin(frame_id);
+      }
+    } else {
+      page_table_.Remove(page->GetPageId());
+      page->page_id_ = INVALID_PAGE_ID;
+      page->pin_count_.store(0, std::memory_order_release);
+      free_list_.push_back(frame_id);
+    }
+    it = pending_reads_.erase(it);
+  }
+}
+
+size_t BufferPoolManagerInstance::CleanFrames(size_t target_frames) {
+  size_t clean_frames;
+  {
+    std::scoped_lock latch(latch_);
+    clean_frames = free_list_.size();
+  }
+  if (clean_frames >= target_frames) {
+    return 0;
+  }
+
+  // Pinned frames are not evicted next, so look past them.
+  std::vector<frame_id_t> candidates;
+  replacer_->PeekVictims(2 * target_frames, &candidates);
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_frames;
+  for (auto frame_id : candidates) {
+    if (clean_frames >= target_frames) {
+      break;
+    }
+    Page *page = &pages_[frame_id];
+    page_id_t page_id = page->GetPageId();
+    if (page_id == INVALID_PAGE_ID || page->GetPinCount() != 0) {
+      continue;
+    }
+    clean_frames++;
+    if (!page->IsDirty()) {
+      continue;
+    }
+    // Keep the frame from being evicted until the write is done; the pin does not count as an access.
+    cleaning_frames_++;
+    if (!TryPin(frame_id, page_id, false)) {
+      cleaning_frames_--;
+      continue;
+    }
+    dirty_frames.emplace_back(page_id, frame_id);
+  }
+  if (dirty_frames.empty()) {
+    return 0;
+  }
+  std::sort(dirty_frames.begin(), dirty_frames.end());
+
+  // Write copies of the pages, so that they can be modified while the writes are in flight.
+  auto buffer = static_cast<char *>(std::aligned_alloc(DISK_IO_ALIGNMENT, dirty_frames.size() * PAGE_SIZE));
+  std::vector<DiskRequest> requests;
+  std::vector<frame_id_t> written_frames;
+  requests.reserve(dirty_frames.size());
+  for (const auto &[page_id, frame_id] : dirty_frames) {
+    Page *page = &pages_[frame_id];
+    // Never wait for a page latch while holding pins, a latch holder may be waiting for an eviction.
+    if (page->TryRLatch()) {
+      if (page->IsDirty() && IsLogged(page)) {
+        char *data = buffer + requests.size() * PAGE_SIZE;
+        memcpy(data, page->GetData(), PAGE_SIZE);
+        page->is_dirty_ = false;
+        requests.emplace_back(true, data, page_id);
+        written_frames.push_back(frame_id);
+        page->RUnlatch();
+        continue;
+      }
+      page->RUnlatch();
+    }
+    UnpinFrame(frame_id);
+    cleaning_frames_--;
+  }
+
+  disk_manager_->SubmitRequests(requests.data(), requests.size());
+  bool written = DiskManager::WaitForRequests(requests.data(), requests.size());
+  for (auto frame_id : written_frames) {
+    if (!written) {
+      pages_[frame_id].is_dirty_ = true;
+    }
+    UnpinFrame(frame_id);
+    cleaning_frames_--;
+  }
+  frame_available_.notify_all();
+  std::free(buffer);
+  return written ? requests.size() : 0;
+}
 
 page_id_t BufferPoolManagerInstance::AllocatePage() {
   const page_id_t next_page_id = next_page_id_;
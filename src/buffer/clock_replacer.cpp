@@ -14,16 +14,86 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages),
+      in_clock_(num_pages, false),
+      referenced_(std::make_unique<std::atomic<bool>[]>(num_pages)) {
+  for (size_t i = 0; i < num_pages_; i++) {
+    referenced_[i] = false;
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // Accesses keep setting bits while the hand sweeps, so stop giving second chances after two full rounds.
+  for (size_t steps = 0;; steps++) {
+    size_t frame = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
+    if (!in_clock_[frame]) {
+      continue;
+    }
+    if (referenced_[frame].exchange(false) && steps < 2 * num_pages_) {
+      continue;
+    }
+    in_clock_[frame] = false;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(frame);
+    return true;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (!in_clock_[frame_id]) {
+    return;
+  }
+  in_clock_[frame_id] = false;
+  size_--;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (in_clock_[frame_id]) {
+    return;
+  }
+  in_clock_[frame_id] = true;
+  referenced_[frame_id] = true;
+  size_++;
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  // Most accesses find the bit already set, do not dirty the cache line for them.
+  if (!referenced_[frame_id].load(std::memory_order_relaxed)) {
+    referenced_[frame_id].store(true, std::memory_order_relaxed);
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  Pin(frame_id);
+  referenced_[frame_id] = false;
+}
+
+size_t ClockReplacer::Size() {
+  std::scoped_lock latch(latch_);
+  return size_;
+}
+
+void ClockReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock latch(latch_);
+  // The first round of the hand takes the frames whose bits are clear, the second one the rest.
+  for (int round = 0; round < 2; round++) {
+    for (size_t i = 0; i < num_pages_ && frame_ids->size() < max_frames; i++) {
+      size_t frame = (hand_ + i) % num_pages_;
+      if (in_clock_[frame] && referenced_[frame].load(std::memory_order_relaxed) == (round == 1)) {
+        frame_ids->push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <cstdint>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period, uint64_t clock_tick)
+    : num_pages_(num_pages),
+      k_(k),
+      correlated_period_(correlated_period),
+      clock_tick_(clock_tick),
+      num_accesses_(std::make_unique<std::atomic<uint64_t>[]>(num_pages)),
+      last_access_(std::make_unique<std::atomic<uint64_t>[]>(num_pages)),
+      num_references_(std::make_unique<std::atomic<size_t>[]>(num_pages)),
+      history_(std::make_unique<std::atomic<uint64_t>[]>(num_pages * k)),
+      evictable_(num_pages, false),
+      eviction_keys_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one reference per frame.");
+  BUSTUB_ASSERT(clock_tick > 0, "The clock has to move.");
+  for (size_t i = 0; i < num_pages_; i++) {
+    num_accesses_[i] = 0;
+    last_access_[i] = 0;
+    num_references_[i] = 0;
+  }
+  for (size_t i = 0; i < num_pages_ * k_; i++) {
+    history_[i] = 0;
+  }
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch(latch_);
+  if (eviction_order_.empty()) {
+    return false;
+  }
+  while (!RefreshFirst()) {
+  }
+  frame_id_t victim = eviction_order_.begin()->second;
+  EraseFrame(victim);
+  ClearHistory(victim);
+  *frame_id = victim;
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (!evictable_[frame_id]) {
+    return;
+  }
+  EraseFrame(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  if (evictable_[frame_id]) {
+    return;
+  }
+  evictable_[frame_id] = true;
+  eviction_keys_[frame_id] = EvictionKey(frame_id);
+  eviction_order_.emplace(eviction_keys_[frame_id], frame_id);
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  // The first access to a page and every clock_tick_-th one after it move the clock, all others only read it.
+  uint64_t now;
+  if (num_accesses_[frame_id].fetch_add(1, std::memory_order_relaxed) % clock_tick_ == 0) {
+    now = current_timestamp_.fetch_add(1, std::memory_order_relaxed) + 1;
+  } else {
+    now = current_timestamp_.load(std::memory_order_relaxed);
+  }
+  uint64_t last = last_access_[frame_id].exchange(now, std::memory_order_relaxed);
+  if (last != 0 && now - last <= correlated_period_) {
+    return;  // part of the same reference
+  }
+  size_t num_references = num_references_[frame_id].load(std::memory_order_relaxed);
+  history_[frame_id * k_ + num_references % k_].store(now, std::memory_order_relaxed);
+  num_references_[frame_id].store(num_references + 1, std::memory_order_relaxed);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  Pin(frame_id);
+  ClearHistory(frame_id);
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock latch(latch_);
+  return eviction_order_.size();
+}
+
+void LRUKReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock latch(latch_);
+  // Take the first frames out of the order as they become current, and put them back afterwards.
+  std::vector<std::pair<std::pair<bool, uint64_t>, frame_id_t>> victims;
+  while (frame_ids->size() < max_frames && !eviction_order_.empty()) {
+    if (RefreshFirst()) {
+      victims.push_back(*eviction_order_.begin());
+      frame_ids->push_back(victims.back().second);
+      eviction_order_.erase(eviction_order_.begin());
+    }
+  }
+  eviction_order_.insert(victims.begin(), victims.end());
+}
+
+bool LRUKReplacer::RefreshFirst() {
+  auto first = eviction_order_.begin();
+  frame_id_t frame_id = first->second;
+  auto key = EvictionKey(frame_id);
+  if (key == first->first) {
+    return true;
+  }
+  eviction_order_.erase(first);
+  eviction_keys_[frame_id] = key;
+  eviction_order_.emplace(key, frame_id);
+  return false;
+}
+
+void LRUKReplacer::EraseFrame(frame_id_t frame_id) {
+  evictable_[frame_id] = false;
+  eviction_order_.erase({eviction_keys_[frame_id], frame_id});
+}
+
+std::pair<bool, uint64_t> LRUKReplacer::EvictionKey(frame_id_t frame_id) const {
+  size_t num_references = num_references_[frame_id].load(std::memory_order_relaxed);
+  if (num_references < k_) {
+    // Infinite backward K-distance, fall back to LRU among these.
+    return {false, last_access_[frame_id].load(std::memory_order_relaxed)};
+  }
+  return {true, history_[frame_id * k_ + (num_references - k_) % k_].load(std::memory_order_relaxed)};
+}
+
+void LRUKReplacer::ClearHistory(frame_id_t frame_id) {
+  num_accesses_[frame_id].store(0, std::memory_order_relaxed);
+  last_access_[frame_id].store(0, std::memory_order_relaxed);
+  num_references_[frame_id].store(0, std::memory_order_relaxed);
+}
+
+}  // namespace bustub
@@ -14,16 +14,79 @@
 
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : referenced_(std::make_unique<std::atomic<bool>[]>(num_pages)) {
+  lru_map_.reserve(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    referenced_[i] = false;
+  }
+}
 
 LRUReplacer::~LRUReplacer() = default;
 
-bool LRUReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool LRUReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock latch(latch_);
+  // Give recently referenced frames a second chance, but only for one round over the list.
+  size_t second_chances = 0;
+  while (!lru_list_.empty()) {
+    frame_id_t victim = lru_list_.front();
+    if (referenced_[victim].exchange(false) && second_chances++ < lru_list_.size()) {
+      lru_list_.splice(lru_list_.end(), lru_list_, lru_list_.begin());
+      continue;
+    }
+    *frame_id = victim;
+    lru_map_.erase(victim);
+    lru_list_.pop_front();
+    return true;
+  }
+  return false;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  auto it = lru_map_.find(frame_id);
+  if (it == lru_map_.end()) {
+    return;
+  }
+  lru_list_.erase(it->second);
+  lru_map_.erase(it);
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock latch(latch_);
+  // A frame that is already evictable keeps its position.
+  if (lru_map_.count(frame_id) != 0) {
+    return;
+  }
+  // The position at the back already accounts for the accesses so far.
+  referenced_[frame_id] = false;
+  lru_map_.emplace(frame_id, lru_list_.insert(lru_list_.end(), frame_id));
+}
 
-size_t LRUReplacer::Size() { return 0; }
+void LRUReplacer::RecordAccess(frame_id_t frame_id) {
+  // Most accesses find the bit already set, do not dirty the cache line for them.
+  if (!referenced_[frame_id].load(std::memory_order_relaxed)) {
+    referenced_[frame_id].store(true, std::memory_order_relaxed);
+  }
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  Pin(frame_id);
+  referenced_[frame_id] = false;
+}
+
+size_t LRUReplacer::Size() {
+  std::scoped_lock latch(latch_);
+  return lru_list_.size();
+}
+
+void LRUReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::scoped_lock latch(latch_);
+  // Referenced frames are passed over by the next round of victims.
+  for (auto it = lru_list_.begin(); it != lru_list_.end() && frame_ids->size() < max_frames; ++it) {
+    if (!referenced_[*it].load(std::memory_order_relaxed)) {
+      frame_ids->push_back(*it);
+    }
+  }
+}
 
 }  // namespace bustub
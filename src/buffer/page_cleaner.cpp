@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_cleaner.cpp
+//
+// Identification: src/buffer/page_cleaner.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_cleaner.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+namespace bustub {
+
+PageCleaner::PageCleaner(std::vector<BufferPoolManagerInstance *> instances, size_t target_percent)
+    : instances_(std::move(instances)), target_percent_(target_percent) {
+  thread_ = std::thread(&PageCleaner::Run, this);
+}
+
+PageCleaner::~PageCleaner() {
+  {
+    std::scoped_lock latch(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void PageCleaner::Wake() {
+  {
+    std::scoped_lock latch(latch_);
+    woken_ = true;
+  }
+  cv_.notify_one();
+}
+
+void PageCleaner::Run() {
+  std::unique_lock latch(latch_);
+  while (!shutdown_) {
+    cv_.wait_for(latch, page_cleaner_interval, [&] { return woken_ || shutdown_; });
+    if (shutdown_) {
+      break;
+    }
+    woken_ = false;
+    latch.unlock();
+    for (auto *instance : instances_) {
+      instance->CleanFrames(std::max<size_t>(1, instance->GetPoolSize() * target_percent_ / 100));
+    }
+    latch.lock();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(16) {
+  // Keep the load factor (including tombstones) well below one half.
+  while (capacity_ < 4 * num_frames) {
+    capacity_ <<= 1;
+  }
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].store(Pack(EMPTY_KEY, 0), std::memory_order_relaxed);
+  }
+}
+
+size_t PageTable::HomeSlot(page_id_t page_id) const {
+  // Fibonacci hashing spreads both sequential page ids and the strided ids of a parallel buffer pool.
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> 32) &
+         (capacity_ - 1);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t slot_index = HomeSlot(page_id);
+  for (size_t i = 0; i < capacity_; i++) {
+    uint64_t slot = slots_[slot_index].load(std::memory_order_acquire);
+    page_id_t key = KeyOf(slot);
+    if (key == page_id) {
+      *frame_id = FrameOf(slot);
+      return true;
+    }
+    if (key == EMPTY_KEY) {
+      return false;
+    }
+    slot_index = (slot_index + 1) & (capacity_ - 1);
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t slot_index = HomeSlot(page_id);
+  for (size_t i = 0; i < capacity_; i++) {
+    page_id_t key = KeyOf(slots_[slot_index].load(std::memory_order_relaxed));
+    BUSTUB_ASSERT(key != page_id, "Page is already in the page table.");
+    // The page is not in the table, so the first free slot on its probe sequence can be used.
+    if (key == EMPTY_KEY || key == TOMBSTONE_KEY) {
+      slots_[slot_index].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    slot_index = (slot_index + 1) & (capacity_ - 1);
+  }
+  UNREACHABLE("Page table is full.");
+}
+
+bool PageTable::Remove(page_id_t page_id) {
+  size_t slot_index = HomeSlot(page_id);
+  for (size_t i = 0; i < capacity_; i++) {
+    page_id_t key = KeyOf(slots_[slot_index].load(std::memory_order_relaxed));
+    if (key == page_id) {
+      slots_[slot_index].store(Pack(TOMBSTONE_KEY, 0), std::memory_order_release);
+      // No probe sequence runs past an empty slot, so a run of tombstones right before one can be emptied again.
+      while (KeyOf(slots_[(slot_index + 1) & (capacity_ - 1)].load(std::memory_order_relaxed)) == EMPTY_KEY &&
+             KeyOf(slots_[slot_index].load(std::memory_order_relaxed)) == TOMBSTONE_KEY) {
+        slots_[slot_index].store(Pack(EMPTY_KEY, 0), std::memory_order_release);
+        slot_index = (slot_index - 1) & (capacity_ - 1);
+      }
+      return true;
+    }
+    if (key == EMPTY_KEY) {
+      return false;
+    }
+    slot_index = (slot_index + 1) & (capacity_ - 1);
+  }
+  return false;
+}
+
+}  // namespace bustub
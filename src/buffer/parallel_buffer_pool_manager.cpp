@@ -15,55 +15,77 @@
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
-  // Allocate and create individual BufferPoolManagerInstances
+                                                     LogManager *log_manager, ReplacerType replacer_type) {
+  std::vector<BufferPoolManagerInstance *> instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(pool_size, num_instances, i, disk_manager,
+                                                                        log_manager, replacer_type));
+    instances.push_back(instances_.back().get());
+  }
+  page_cleaner_ = std::make_unique<PageCleaner>(instances);
+  for (auto &instance : instances_) {
+    instance->SetPageCleaner(page_cleaner_.get());
+  }
 }
 
-// Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
-ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+ParallelBufferPoolManager::~ParallelBufferPoolManager() { page_cleaner_.reset(); }
 
-size_t ParallelBufferPoolManager::GetPoolSize() {
-  // Get size of all BufferPoolManagerInstances
-  return 0;
-}
+size_t ParallelBufferPoolManager::GetPoolSize() { return instances_.size() * instances_[0]->GetPoolSize(); }
 
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
-  // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  return nullptr;
+  return instances_[page_id % instances_.size()].get();
 }
 
 Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) {
-  // Fetch page for page_id from responsible BufferPoolManagerInstance
-  return nullptr;
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
 }
 
 bool ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  // Unpin page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
 }
 
 bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
-  // Flush page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
 }
 
-Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
-  // create new page. We will request page allocation in a round robin manner from the underlying
-  // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) { return NewPgImp(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  // Start at a different instance every time, and try each of them once.
+  size_t start = next_instance_++;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPageWithStrategy(page_id, strategy);
+    if (page != nullptr) {
+      return page;
+    }
+  }
   return nullptr;
 }
 
 bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
-  // Delete page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::PrefetchImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    instance_page_ids[page_id % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->Prefetch(instance_page_ids[i], strategy);
+    }
+  }
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
+  for (auto &instance : instances_) {
+    instance->FlushAllPages();
+  }
 }
 
 }  // namespace bustub
@@ -0,0 +1,34 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+std::unique_ptr<Replacer> Replacer::Create(ReplacerType type, size_t num_pages) {
+  switch (type) {
+    case ReplacerType::LRU:
+      return std::make_unique<LRUReplacer>(num_pages);
+    case ReplacerType::CLOCK:
+      return std::make_unique<ClockReplacer>(num_pages);
+    case ReplacerType::LRU_K:
+      return std::make_unique<LRUKReplacer>(num_pages);
+  }
+  UNREACHABLE("Unknown replacer type.");
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,21 +27,159 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *header = buffer_pool_manager_->NewPage(&header_page_id_);
+  if (header == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the pages of the hash table");
+  }
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(header->GetData());
+  header_page->SetPageId(header_page_id_);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  size_t num_blocks = (num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE;
+  block_page_ids_ = NewBlocks(std::clamp<size_t>(num_blocks, 1, HEADER_ARRAY_SIZE));
+  UpdateHeaderPage();
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+std::vector<page_id_t> HASH_TABLE_TYPE::NewBlocks(size_t num_blocks) {
+  std::vector<page_id_t> block_page_ids;
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&block_page_id);
+    if (page == nullptr) {
+      DeleteBlocks(block_page_ids);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the pages of the hash table");
+    }
+    reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData())->Init();
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    block_page_ids.push_back(block_page_id);
+  }
+  return block_page_ids;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteBlocks(const std::vector<page_id_t> &block_page_ids) {
+  for (page_id_t block_page_id : block_page_ids) {
+    buffer_pool_manager_->DeletePage(block_page_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::UpdateHeaderPage() {
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id_)->GetData());
+  header_page->SetSize(block_page_ids_.size() * BLOCK_ARRAY_SIZE);
+  header_page->ClearBlockPageIds();
+  for (page_id_t block_page_id : block_page_ids_) {
+    header_page->AddBlockPageId(block_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  uint64_t hash = Hash(key);
+  ReadLatchGuard guard(&table_latch_);
+  page_id_t block_page_id = HashToPageId(hash);
+  Page *page = FetchPage(block_page_id);
+  page->RLatch();
+  bool found = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData())->GetValue(key, hash, comparator_, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(block_page_id, false);
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
+/*
+ * Only the block is latched, unless it is full and the table has to grow.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  bool full;
+  bool inserted;
+  {
+    ReadLatchGuard guard(&table_latch_);
+    page_id_t block_page_id = HashToPageId(Hash(key));
+    Page *page = FetchPage(block_page_id);
+    page->WLatch();
+    bool dirty;
+    inserted = InsertIntoBlock(reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData()), key, value, &full, &dirty);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(block_page_id, dirty);
+  }
+  if (full) {
+    return GrowInsert(transaction, key, value);
+  }
+  return inserted;
+}
+
+/*
+ * Once the tombstones are at least half of the occupied slots of a full block,
+ * rehashing the block in place leaves it at most half occupied.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::InsertIntoBlock(HASH_TABLE_BLOCK_TYPE *block, const KeyType &key, const ValueType &value,
+                                      bool *full, bool *dirty) {
+  *full = false;
+  *dirty = false;
+  if (block->IsFull()) {
+    if (block->NumReadable() * 2 > block->NumOccupied()) {
+      *full = true;
+      return false;
+    }
+    std::vector<MappingType> pairs;
+    for (slot_offset_t bucket_ind = 0; bucket_ind < BLOCK_ARRAY_SIZE; bucket_ind++) {
+      if (block->IsReadable(bucket_ind)) {
+        pairs.emplace_back(block->KeyAt(bucket_ind), block->ValueAt(bucket_ind));
+      }
+    }
+    block->Init();
+    for (const auto &pair : pairs) {
+      block->Insert(pair.first, pair.second, Hash(pair.first), comparator_);
+    }
+    *dirty = true;
+  }
+  bool inserted = block->Insert(key, value, Hash(key), comparator_);
+  *dirty = *dirty || inserted;
+  return inserted;
+}
+
+/*
+ * Nobody else holds a block while the table latch is held exclusively, so the
+ * blocks are not latched.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::GrowInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  WriteLatchGuard guard(&table_latch_);
+  bool inserted = false;
+  while (true) {
+    page_id_t block_page_id = HashToPageId(Hash(key));
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(FetchPage(block_page_id)->GetData());
+    bool full;
+    bool dirty;
+    inserted = InsertIntoBlock(block, key, value, &full, &dirty);
+    buffer_pool_manager_->UnpinPage(block_page_id, dirty);
+    if (!full || !Grow(block_page_ids_.size() * 2)) {
+      break;
+    }
+  }
+  return inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +187,93 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  uint64_t hash = Hash(key);
+  ReadLatchGuard guard(&table_latch_);
+  page_id_t block_page_id = HashToPageId(hash);
+  Page *page = FetchPage(block_page_id);
+  page->WLatch();
+  bool removed = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData())->Remove(key, value, hash, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(block_page_id, removed);
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  WriteLatchGuard guard(&table_latch_);
+  Grow((2 * initial_size + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::Grow(size_t num_blocks) {
+  num_blocks = std::min<size_t>(num_blocks, HEADER_ARRAY_SIZE);
+  while (num_blocks > block_page_ids_.size()) {
+    std::vector<page_id_t> new_block_page_ids = NewBlocks(num_blocks);
+    bool moved;
+    try {
+      moved = MoveBlocks(new_block_page_ids);
+    } catch (const Exception &) {
+      // The old blocks are still whole, so the table keeps them.
+      DeleteBlocks(new_block_page_ids);
+      throw;
+    }
+    if (moved) {
+      DeleteBlocks(block_page_ids_);
+      block_page_ids_ = std::move(new_block_page_ids);
+      UpdateHeaderPage();
+      return true;
+    }
+    DeleteBlocks(new_block_page_ids);
+    num_blocks = std::min<size_t>(num_blocks * 2, HEADER_ARRAY_SIZE);
+    if (num_blocks == new_block_page_ids.size()) {
+      break;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::MoveBlocks(const std::vector<page_id_t> &new_block_page_ids) {
+  for (page_id_t block_page_id : block_page_ids_) {
+    auto *block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(FetchPage(block_page_id)->GetData());
+    bool moved = true;
+    for (slot_offset_t bucket_ind = 0; moved && bucket_ind < BLOCK_ARRAY_SIZE; bucket_ind++) {
+      if (!block->IsReadable(bucket_ind)) {
+        continue;
+      }
+      KeyType key = block->KeyAt(bucket_ind);
+      uint64_t hash = Hash(key);
+      page_id_t new_block_page_id = new_block_page_ids[(hash >> 32) % new_block_page_ids.size()];
+      Page *new_page = buffer_pool_manager_->FetchPage(new_block_page_id);
+      if (new_page == nullptr) {
+        buffer_pool_manager_->UnpinPage(block_page_id, false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a hash table page");
+      }
+      auto *new_block = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(new_page->GetData());
+      moved = !new_block->IsFull();
+      if (moved) {
+        new_block->Insert(key, block->ValueAt(bucket_ind), hash, comparator_);
+      }
+      buffer_pool_manager_->UnpinPage(new_block_page_id, moved);
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, false);
+    if (!moved) {
+      return false;
+    }
+  }
+  return true;
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  ReadLatchGuard guard(&table_latch_);
+  return block_page_ids_.size() * BLOCK_ARRAY_SIZE;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
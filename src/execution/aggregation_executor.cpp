@@ -9,7 +9,12 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <exception>
+#include <algorithm>
+#include <future>  // NOLINT
+#include <iterator>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "execution/executors/aggregation_executor.h"
@@ -18,12 +23,220 @@ namespace bustub {
 
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), aht_(plan->GetAggregates(), plan->GetAggregateTypes()) {
+  children_.push_back(std::move(child));
+}
 
-void AggregationExecutor::Init() {}
+AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::vector<std::unique_ptr<AbstractExecutor>> &&children,
+                                         std::vector<std::shared_ptr<ParallelState>> &&shared_state)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      children_(std::move(children)),
+      shared_state_(std::move(shared_state)),
+      aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
+      run_schema_(MakeRunSchema()) {}
+
+void AggregationExecutor::Init() {
+  ClearPending();
+  aht_.Clear();
+  if (children_.size() > 1) {
+    AggregateInParallel();
+  } else {
+    AbstractExecutor *child = children_.front().get();
+    child->Init();
+    ForEachRow(child, [this](const AggregateKey &key, const AggregateValue &value) { aht_.InsertCombine(key, value); });
+  }
+  aht_iterator_ = aht_.Begin();
+}
+
+template <typename Consumer>
+void AggregationExecutor::ForEachRow(AbstractExecutor *child, Consumer &&consume) {
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  std::vector<std::vector<Value>> group_by_columns(group_bys.size());
+  std::vector<std::vector<Value>> aggregate_columns(aggregates.size());
+  TupleBatch batch;
+  while (child->NextBatch(&batch)) {
+    for (uint32_t i = 0; i < group_bys.size(); i++) {
+      group_bys[i]->EvaluateBatch(batch, &group_by_columns[i]);
+    }
+    for (uint32_t i = 0; i < aggregates.size(); i++) {
+      aggregates[i]->EvaluateBatch(batch, &aggregate_columns[i]);
+    }
+    AggregateKey key;
+    AggregateValue value;
+    for (uint32_t row = 0; row < batch.Size(); row++) {
+      key.group_bys_.clear();
+      for (const auto &column : group_by_columns) {
+        key.group_bys_.push_back(column[row]);
+      }
+      value.aggregates_.clear();
+      for (const auto &column : aggregate_columns) {
+        value.aggregates_.push_back(column[row]);
+      }
+      consume(key, value);
+    }
+  }
+}
+
+/*
+ * In the first phase, every worker aggregates the output of its copy of the child into a hash table of its own, which
+ * holds at most AGGREGATION_LOCAL_GROUPS groups so that it stays in the cache. A row of a new group that finds the
+ * table full spills the groups of the table into the runs of the worker, a SpillFile for each partition, and the
+ * worker goes on with the emptied table. The frequent groups are thus aggregated in the cache, and a run only gets one
+ * partial aggregate of a group for each spill.
+ *
+ * In the second phase, NextBatch merges the runs of all the workers for a partition into the hash table, emits its
+ * groups, and only then merges the next partition, so the hash table never holds more than one partition.
+ */
+void AggregationExecutor::AggregateInParallel() {
+  for (auto &state : shared_state_) {
+    state->Reset();
+  }
+  runs_.clear();
+  runs_.resize(children_.size());
+  for (auto &runs : runs_) {
+    for (uint32_t partition = 0; partition < AGGREGATION_PARTITIONS; partition++) {
+      runs.push_back(std::make_unique<SpillFile>(exec_ctx_->GetBufferPoolManager(), run_schema_.get()));
+    }
+  }
+  RunOnWorkers([this](uint32_t worker) { PreAggregate(worker); });
+  next_partition_ = 0;
+}
+
+/*
+ * A copy may be waiting for the input of an Exchange whose other consumers failed, so a worker that fails cancels the
+ * shared state for the others.
+ */
+void AggregationExecutor::RunOnWorkers(const std::function<void(uint32_t)> &task) {
+  std::vector<std::exception_ptr> errors(children_.size());
+  std::vector<std::future<void>> workers;
+  for (uint32_t worker = 0; worker < children_.size(); worker++) {
+    workers.push_back(exec_ctx_->GetWorkerPool()->Submit([this, &task, &errors, worker] {
+      try {
+        task(worker);
+      } catch (...) {
+        errors[worker] = std::current_exception();
+        for (auto &state : shared_state_) {
+          state->Cancel();
+        }
+      }
+    }));
+  }
+  for (auto &worker : workers) {
+    worker.wait();
+  }
+  for (auto &error : errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+std::unique_ptr<Schema> AggregationExecutor::MakeRunSchema() const {
+  std::vector<Column> columns;
+  for (const auto &expr : plan_->GetGroupBys()) {
+    TypeId type = expr->GetReturnType();
+    if (type == TypeId::VARCHAR) {
+      columns.emplace_back("", type, PAGE_SIZE);
+    } else {
+      columns.emplace_back("", type);
+    }
+  }
+  // The aggregates start out as integers, see SimpleAggregationHashTable::GenerateInitialAggregateValue.
+  for (uint32_t i = 0; i < plan_->GetAggregates().size(); i++) {
+    TypeId type = plan_->GetAggregates()[i]->GetReturnType();
+    if (plan_->GetAggregateTypes()[i] == AggregationType::CountAggregate ||
+        (type != TypeId::BIGINT && type != TypeId::DECIMAL)) {
+      type = TypeId::INTEGER;
+    }
+    columns.emplace_back("", type);
+  }
+  return std::make_unique<Schema>(columns);
+}
+
+void AggregationExecutor::PreAggregate(uint32_t worker) {
+  AbstractExecutor *child = children_[worker].get();
+  std::vector<std::unique_ptr<SpillFile>> &runs = runs_[worker];
+  SimpleAggregationHashTable local(plan_->GetAggregates(), plan_->GetAggregateTypes());
+  std::vector<Value> values;
+  auto spill = [&](AggregateKey &&key, AggregateValue &&value) {
+    size_t partition = PartitionOf(key);
+    values.clear();
+    std::move(key.group_bys_.begin(), key.group_bys_.end(), std::back_inserter(values));
+    std::move(value.aggregates_.begin(), value.aggregates_.end(), std::back_inserter(values));
+    for (uint32_t i = 0; i < values.size(); i++) {
+      TypeId type = run_schema_->GetColumn(i).GetType();
+      if (values[i].GetTypeId() != type) {
+        values[i] = values[i].CastAs(type);
+      }
+    }
+    runs[partition]->Append(Tuple(values, run_schema_.get()));
+  };
+  child->Init();
+  ForEachRow(child, [&](const AggregateKey &key, const AggregateValue &value) {
+    if (!local.InsertCombine(key, value, AGGREGATION_LOCAL_GROUPS)) {
+      local.Drain(spill);
+      local.InsertCombine(key, value);
+    }
+  });
+  local.Drain(spill);
+}
+
+void AggregationExecutor::MergePartition(size_t partition) {
+  const size_t num_group_bys = plan_->GetGroupBys().size();
+  const uint32_t num_columns = run_schema_->GetColumnCount();
+  TupleBatch batch;
+  for (auto &runs : runs_) {
+    std::unique_ptr<SpillFile> run = std::move(runs[partition]);
+    while (run->NextBatch(&batch)) {
+      for (uint32_t row = 0; row < batch.Size(); row++) {
+        AggregateKey key;
+        AggregateValue value;
+        for (uint32_t col_idx = 0; col_idx < num_columns; col_idx++) {
+          auto &values = col_idx < num_group_bys ? key.group_bys_ : value.aggregates_;
+          values.push_back(batch.GetValue(row, col_idx));
+        }
+        aht_.InsertMerge(std::move(key), std::move(value));
+      }
+    }
+  }
+}
+
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
 
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool AggregationExecutor::NextBatch(TupleBatch *batch) {
+  const Schema *output_schema = GetOutputSchema();
+  const AbstractExpression *having = plan_->GetHaving();
+  batch->Reset(output_schema);
+  while (!batch->IsFull()) {
+    if (aht_iterator_ == aht_.End()) {
+      if (runs_.empty() || next_partition_ == AGGREGATION_PARTITIONS) {
+        break;
+      }
+      // The groups of the hash table were all emitted, so it can hold the next partition instead.
+      aht_.Clear();
+      MergePartition(next_partition_++);
+      aht_iterator_ = aht_.Begin();
+      continue;
+    }
+    const auto &group_bys = aht_iterator_.Key().group_bys_;
+    const auto &aggregates = aht_iterator_.Val().aggregates_;
+    ++aht_iterator_;
+    if (having != nullptr && !having->EvaluateAggregate(group_bys, aggregates).GetAs<bool>()) {
+      continue;
+    }
+    std::vector<Value> values;
+    values.reserve(output_schema->GetColumnCount());
+    for (const auto &column : output_schema->GetColumns()) {
+      values.push_back(column.GetExpr()->EvaluateAggregate(group_bys, aggregates));
+    }
+    batch->Append(std::move(values), RID());
+  }
+  return !batch->IsEmpty();
+}
 
-const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
+const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return children_.front().get(); }
 
 }  // namespace bustub
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.cpp
+//
+// Identification: src/execution/exchange_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/exchange_executor.h"
+
+#include <exception>
+#include <utility>
+
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+ExchangeProducers::ExchangeProducers(const ExchangePlanNode *plan, WorkerPool *worker_pool,
+                                     std::vector<std::unique_ptr<AbstractExecutor>> &&producers,
+                                     std::vector<std::shared_ptr<ParallelState>> &&shared_state,
+                                     uint32_t num_partitions)
+    : plan_(plan),
+      worker_pool_(worker_pool),
+      producers_(std::move(producers)),
+      shared_state_(std::move(shared_state)),
+      num_partitions_(num_partitions) {}
+
+void ExchangeProducers::Reset() {
+  std::scoped_lock lock(latch_);
+  Stop();
+  queues_.clear();
+  state_ = State::Idle;
+}
+
+void ExchangeProducers::Cancel() {
+  std::scoped_lock lock(latch_);
+  Stop();
+  state_ = State::Cancelled;
+}
+
+bool ExchangeProducers::NextBatch(uint32_t partition, TupleBatch *batch) {
+  ExchangeQueue *queue;
+  {
+    std::scoped_lock lock(latch_);
+    if (state_ == State::Cancelled) {
+      return false;
+    }
+    if (state_ == State::Idle) {
+      for (auto &state : shared_state_) {
+        state->Reset();
+      }
+      for (uint32_t i = 0; i < num_partitions_; i++) {
+        queues_.push_back(std::make_unique<ExchangeQueue>(producers_.size()));
+      }
+      for (auto &producer : producers_) {
+        runs_.push_back(worker_pool_->Submit([this, producer = producer.get()] { Produce(producer); }));
+      }
+      state_ = State::Running;
+    }
+    queue = queues_[partition].get();
+  }
+  return queue->Pop(batch);
+}
+
+/*
+ * A hash Exchange collects the rows of each partition in a batch of their own, and pushes the batch once it is full,
+ * so that the consumers get full batches however many partitions there are. A partition whose consumer is gone is
+ * skipped; the producer stops once every consumer is gone.
+ */
+void ExchangeProducers::Produce(AbstractExecutor *producer) {
+  const Schema *schema = producer->GetOutputSchema();
+  std::vector<bool> open(num_partitions_, true);
+  uint32_t num_open = num_partitions_;
+  auto push = [&](uint32_t partition, TupleBatch &&batch) {
+    if (open[partition] && !queues_[partition]->Push(std::move(batch))) {
+      open[partition] = false;
+      num_open--;
+    }
+  };
+
+  std::exception_ptr error;
+  try {
+    producer->Init();
+    TupleBatch batch;
+    std::vector<TupleBatch> partitions(num_partitions_, TupleBatch(schema));
+    std::vector<hash_t> hashes;
+    std::vector<Value> keys;
+    while (num_open > 0 && producer->NextBatch(&batch)) {
+      if (num_partitions_ == 1) {
+        push(0, std::move(batch));
+        continue;
+      }
+      if (plan_->GetExchangeType() == ExchangeType::Broadcast) {
+        for (uint32_t partition = 0; partition + 1 < num_partitions_; partition++) {
+          push(partition, TupleBatch(batch));
+        }
+        push(num_partitions_ - 1, std::move(batch));
+        continue;
+      }
+      hashes.assign(batch.Size(), 0);
+      for (const auto *partition_key : plan_->GetPartitionKeys()) {
+        partition_key->EvaluateBatch(batch, &keys);
+        for (uint32_t row = 0; row < batch.Size(); row++) {
+          hashes[row] = HashUtil::CombineHashes(hashes[row], HashUtil::HashValue(&keys[row]));
+        }
+      }
+      for (uint32_t row = 0; row < batch.Size(); row++) {
+        uint32_t partition = hashes[row] % num_partitions_;
+        partitions[partition].AppendRow(batch, row);
+        if (partitions[partition].IsFull()) {
+          push(partition, std::move(partitions[partition]));
+          partitions[partition].Reset(schema);
+        }
+      }
+    }
+    for (uint32_t partition = 0; partition < num_partitions_; partition++) {
+      if (!partitions[partition].IsEmpty()) {
+        push(partition, std::move(partitions[partition]));
+      }
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto &queue : queues_) {
+    queue->ProducerDone(error);
+  }
+}
+
+void ExchangeProducers::Stop() {
+  for (auto &queue : queues_) {
+    queue->Close();
+  }
+  for (auto &state : shared_state_) {
+    state->Cancel();
+  }
+  for (auto &run : runs_) {
+    run.wait();
+  }
+  runs_.clear();
+}
+
+ExchangeExecutor::ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan,
+                                   std::shared_ptr<ExchangeProducers> producers, uint32_t partition)
+    : AbstractExecutor(exec_ctx), plan_(plan), producers_(std::move(producers)), partition_(partition) {}
+
+/*
+ * The consumers of a partitioned Exchange run in parallel, and the operator that runs them resets the producers before
+ * it initializes them. The only consumer of an Exchange resets the producers itself.
+ */
+void ExchangeExecutor::Init() {
+  ClearPending();
+  if (producers_->GetNumPartitions() == 1) {
+    producers_->Reset();
+  }
+}
+
+bool ExchangeExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
+
+bool ExchangeExecutor::NextBatch(TupleBatch *batch) {
+  if (!producers_->NextBatch(partition_, batch)) {
+    batch->Reset(GetOutputSchema());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace bustub
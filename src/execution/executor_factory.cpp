@@ -14,11 +14,15 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "common/exception.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/delete_executor.h"
 #include "execution/executors/distinct_executor.h"
+#include "execution/executors/exchange_executor.h"
+#include "execution/executors/gather_executor.h"
 #include "execution/executors/hash_join_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
@@ -27,93 +31,226 @@
 #include "execution/executors/nested_loop_join_executor.h"
 #include "execution/executors/seq_scan_executor.h"
 #include "execution/executors/update_executor.h"
+#include "execution/morsel_dispenser.h"
 #include "storage/index/generic_key.h"
 
 namespace bustub {
 
+/** @return the Exchange that a plan is, if it deals its input out to its consumers in the given way */
+static const ExchangePlanNode *AsExchange(const AbstractPlanNode *plan, ExchangeType exchange_type) {
+  auto exchange_plan = dynamic_cast<const ExchangePlanNode *>(plan);
+  return exchange_plan != nullptr && exchange_plan->GetExchangeType() == exchange_type ? exchange_plan : nullptr;
+}
+
+/*
+ * A copy of a plan that must see all of its input gets its share of it from an
+ * Exchange below: a hash Exchange for a distinct, an aggregation or the two
+ * sides of a hash join, or a broadcast Exchange for the build side alone.
+ * Copies of a plan that writes, limits its output or rescans its inner side are
+ * never correct: they would write a row once per copy, share the write sets of
+ * one transaction, return a limit per copy, or rescan scans that the copies
+ * share.
+ */
+static void CheckCopiesOf(const AbstractPlanNode *plan) {
+  switch (plan->GetType()) {
+    case PlanType::Insert:
+    case PlanType::Update:
+    case PlanType::Delete:
+      throw NotImplementedException("cannot run copies of a plan that modifies a table");
+    case PlanType::Limit:
+      throw NotImplementedException("cannot run copies of a limit");
+    case PlanType::NestedLoopJoin:
+      throw NotImplementedException("cannot run copies of a nested loop join");
+    case PlanType::Distinct:
+    case PlanType::Aggregation:
+      if (AsExchange(plan->GetChildAt(0), ExchangeType::Hash) == nullptr) {
+        throw NotImplementedException("copies of a distinct or an aggregation need a hash exchange below");
+      }
+      break;
+    case PlanType::HashJoin:
+      if (AsExchange(plan->GetChildAt(0), ExchangeType::Broadcast) == nullptr &&
+          (AsExchange(plan->GetChildAt(0), ExchangeType::Hash) == nullptr ||
+           AsExchange(plan->GetChildAt(1), ExchangeType::Hash) == nullptr)) {
+        throw NotImplementedException("copies of a hash join need a broadcast build side or two hash exchanges below");
+      }
+      break;
+    default:
+      break;
+  }
+}
+
 std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx,
                                                                   const AbstractPlanNode *plan) {
+  std::vector<std::shared_ptr<ParallelState>> shared_state;
+  return std::move(CreateExecutors(exec_ctx, plan, 1, &shared_state).front());
+}
+
+std::vector<std::unique_ptr<AbstractExecutor>> ExecutorFactory::CreateExecutors(
+    ExecutorContext *exec_ctx, const AbstractPlanNode *plan, uint32_t num_copies,
+    std::vector<std::shared_ptr<ParallelState>> *shared_state) {
+  if (num_copies > 1) {
+    CheckCopiesOf(plan);
+  }
+  std::vector<std::unique_ptr<AbstractExecutor>> executors;
   switch (plan->GetType()) {
-    // Create a new sequential scan executor
+    // Create new sequential scan executors, which split the table between them
     case PlanType::SeqScan: {
-      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan));
+      auto seq_scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan);
+      std::shared_ptr<MorselDispenser> dispenser;
+      if (num_copies > 1) {
+        auto *table_info = exec_ctx->GetCatalog()->GetTable(seq_scan_plan->GetTableOid());
+        dispenser = std::make_shared<MorselDispenser>(table_info->table_.get());
+        shared_state->push_back(dispenser);
+      }
+      for (uint32_t i = 0; i < num_copies; i++) {
+        executors.push_back(std::make_unique<SeqScanExecutor>(exec_ctx, seq_scan_plan, dispenser));
+      }
+      break;
     }
 
-    // Create a new index scan executor
+    // Create new index scan executors
     case PlanType::IndexScan: {
-      return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan));
+      for (uint32_t i = 0; i < num_copies; i++) {
+        executors.push_back(
+            std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan)));
+      }
+      break;
     }
 
-    // Create a new insert executor
+    // Create new insert executors
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan);
-      auto child_executor =
-          insert_plan->IsRawInsert() ? nullptr : ExecutorFactory::CreateExecutor(exec_ctx, insert_plan->GetChildPlan());
-      return std::make_unique<InsertExecutor>(exec_ctx, insert_plan, std::move(child_executor));
+      std::vector<std::unique_ptr<AbstractExecutor>> children(num_copies);
+      if (!insert_plan->IsRawInsert()) {
+        children = CreateExecutors(exec_ctx, insert_plan->GetChildPlan(), num_copies, shared_state);
+      }
+      for (auto &child_executor : children) {
+        executors.push_back(std::make_unique<InsertExecutor>(exec_ctx, insert_plan, std::move(child_executor)));
+      }
+      break;
     }
 
-    // Create a new update executor
+    // Create new update executors
     case PlanType::Update: {
       auto update_plan = dynamic_cast<const UpdatePlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, update_plan->GetChildPlan());
-      return std::make_unique<UpdateExecutor>(exec_ctx, update_plan, std::move(child_executor));
+      for (auto &child_executor : CreateExecutors(exec_ctx, update_plan->GetChildPlan(), num_copies, shared_state)) {
+        executors.push_back(std::make_unique<UpdateExecutor>(exec_ctx, update_plan, std::move(child_executor)));
+      }
+      break;
     }
 
-    // Create a new delete executor
+    // Create new delete executors
     case PlanType::Delete: {
       auto delete_plan = dynamic_cast<const DeletePlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, delete_plan->GetChildPlan());
-      return std::make_unique<DeleteExecutor>(exec_ctx, delete_plan, std::move(child_executor));
+      for (auto &child_executor : CreateExecutors(exec_ctx, delete_plan->GetChildPlan(), num_copies, shared_state)) {
+        executors.push_back(std::make_unique<DeleteExecutor>(exec_ctx, delete_plan, std::move(child_executor)));
+      }
+      break;
     }
 
-    // Create a new limit executor
+    // Create new limit executors
     case PlanType::Limit: {
       auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
-      return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
+      for (auto &child_executor : CreateExecutors(exec_ctx, limit_plan->GetChildPlan(), num_copies, shared_state)) {
+        executors.push_back(std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor)));
+      }
+      break;
     }
 
-    // Create a new distinct executor
+    // Create new distinct executors
     case PlanType::Distinct: {
       auto distinct_plan = dynamic_cast<const DistinctPlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, distinct_plan->GetChildPlan());
-      return std::make_unique<DistinctExecutor>(exec_ctx, distinct_plan, std::move(child_executor));
+      for (auto &child_executor :
+           CreateExecutors(exec_ctx, distinct_plan->GetChildPlan(), num_copies, shared_state)) {
+        executors.push_back(std::make_unique<DistinctExecutor>(exec_ctx, distinct_plan, std::move(child_executor)));
+      }
+      break;
     }
 
-    // Create a new aggregation executor
+    // Create new aggregation executors, each of which runs its own copies of the child plan if it has several workers
     case PlanType::Aggregation: {
       auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan());
-      return std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
+      if (agg_plan->GetNumWorkers() > 1) {
+        for (uint32_t i = 0; i < num_copies; i++) {
+          std::vector<std::shared_ptr<ParallelState>> agg_state;
+          auto children =
+              CreateExecutors(exec_ctx, agg_plan->GetChildPlan(), agg_plan->GetNumWorkers(), &agg_state);
+          executors.push_back(
+              std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(children), std::move(agg_state)));
+        }
+        break;
+      }
+      for (auto &child_executor : CreateExecutors(exec_ctx, agg_plan->GetChildPlan(), num_copies, shared_state)) {
+        executors.push_back(std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor)));
+      }
+      break;
     }
 
-    // Create a new nested-loop join executor
+    // Create new nested-loop join executors
     case PlanType::NestedLoopJoin: {
       auto nested_loop_join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetLeftPlan());
-      auto right = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetRightPlan());
-      return std::make_unique<NestedLoopJoinExecutor>(exec_ctx, nested_loop_join_plan, std::move(left),
-                                                      std::move(right));
+      auto left = CreateExecutors(exec_ctx, nested_loop_join_plan->GetLeftPlan(), num_copies, shared_state);
+      auto right = CreateExecutors(exec_ctx, nested_loop_join_plan->GetRightPlan(), num_copies, shared_state);
+      for (uint32_t i = 0; i < num_copies; i++) {
+        executors.push_back(std::make_unique<NestedLoopJoinExecutor>(exec_ctx, nested_loop_join_plan,
+                                                                     std::move(left[i]), std::move(right[i])));
+      }
+      break;
     }
 
-    // Create a new nested-index join executor
+    // Create new nested-index join executors
     case PlanType::NestedIndexJoin: {
       auto nested_index_join_plan = dynamic_cast<const NestedIndexJoinPlanNode *>(plan);
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_index_join_plan->GetChildPlan());
-      return std::make_unique<NestIndexJoinExecutor>(exec_ctx, nested_index_join_plan, std::move(left));
+      for (auto &left : CreateExecutors(exec_ctx, nested_index_join_plan->GetChildPlan(), num_copies, shared_state)) {
+        executors.push_back(std::make_unique<NestIndexJoinExecutor>(exec_ctx, nested_index_join_plan, std::move(left)));
+      }
+      break;
     }
 
-    // Create a new hash join executor
+    // Create new hash join executors
     case PlanType::HashJoin: {
       auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetLeftPlan());
-      auto right = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetRightPlan());
-      return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
+      auto left = CreateExecutors(exec_ctx, hash_join_plan->GetLeftPlan(), num_copies, shared_state);
+      auto right = CreateExecutors(exec_ctx, hash_join_plan->GetRightPlan(), num_copies, shared_state);
+      for (uint32_t i = 0; i < num_copies; i++) {
+        executors.push_back(
+            std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left[i]), std::move(right[i])));
+      }
+      break;
+    }
+
+    // Create new gather executors, each of which runs its own copies of the child plan
+    case PlanType::Gather: {
+      auto gather_plan = dynamic_cast<const GatherPlanNode *>(plan);
+      for (uint32_t i = 0; i < num_copies; i++) {
+        std::vector<std::shared_ptr<ParallelState>> gather_state;
+        auto children = CreateExecutors(exec_ctx, gather_plan->GetChildPlan(), gather_plan->GetNumWorkers(),
+                                        &gather_state);
+        executors.push_back(
+            std::make_unique<GatherExecutor>(exec_ctx, gather_plan, std::move(children), std::move(gather_state)));
+      }
+      break;
+    }
+
+    // Create new exchange executors, which consume one partition each of the same producers
+    case PlanType::Exchange: {
+      auto exchange_plan = dynamic_cast<const ExchangePlanNode *>(plan);
+      std::vector<std::shared_ptr<ParallelState>> exchange_state;
+      auto children =
+          CreateExecutors(exec_ctx, exchange_plan->GetChildPlan(), exchange_plan->GetNumWorkers(), &exchange_state);
+      auto producers = std::make_shared<ExchangeProducers>(exchange_plan, exec_ctx->GetWorkerPool(),
+                                                           std::move(children), std::move(exchange_state), num_copies);
+      shared_state->push_back(producers);
+      for (uint32_t i = 0; i < num_copies; i++) {
+        executors.push_back(std::make_unique<ExchangeExecutor>(exec_ctx, exchange_plan, producers, i));
+      }
+      break;
     }
 
     default:
       UNREACHABLE("Unsupported plan type.");
   }
+  return executors;
 }
 
 }  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_executor.cpp
+//
+// Identification: src/execution/gather_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/gather_executor.h"
+
+#include <exception>
+#include <utility>
+
+namespace bustub {
+
+GatherExecutor::GatherExecutor(ExecutorContext *exec_ctx, const GatherPlanNode *plan,
+                               std::vector<std::unique_ptr<AbstractExecutor>> &&children,
+                               std::vector<std::shared_ptr<ParallelState>> &&shared_state)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      children_(std::move(children)),
+      shared_state_(std::move(shared_state)) {}
+
+GatherExecutor::~GatherExecutor() { Stop(); }
+
+void GatherExecutor::Init() {
+  Stop();
+  ClearPending();
+  for (auto &state : shared_state_) {
+    state->Reset();
+  }
+  queue_ = std::make_unique<ExchangeQueue>(children_.size());
+  for (auto &child : children_) {
+    producers_.push_back(exec_ctx_->GetWorkerPool()->Submit([this, child = child.get()] { Produce(child); }));
+  }
+}
+
+bool GatherExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
+
+bool GatherExecutor::NextBatch(TupleBatch *batch) {
+  if (!queue_->Pop(batch)) {
+    batch->Reset(GetOutputSchema());
+    return false;
+  }
+  return true;
+}
+
+void GatherExecutor::Produce(AbstractExecutor *child) {
+  std::exception_ptr error;
+  try {
+    child->Init();
+    TupleBatch batch;
+    while (child->NextBatch(&batch) && queue_->Push(std::move(batch))) {
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+  queue_->ProducerDone(error);
+}
+
+/*
+ * A copy may be waiting for the input of an Exchange whose other consumers are gone, so the shared state is cancelled
+ * along with the queue before the gather waits for the copies.
+ */
+void GatherExecutor::Stop() {
+  if (queue_ != nullptr) {
+    queue_->Close();
+  }
+  for (auto &state : shared_state_) {
+    state->Cancel();
+  }
+  for (auto &producer : producers_) {
+    producer.wait();
+  }
+  producers_.clear();
+}
+
+}  // namespace bustub
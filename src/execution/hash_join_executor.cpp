@@ -12,15 +12,342 @@
 
 #include "execution/executors/hash_join_executor.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace bustub {
 
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_child_(std::move(left_child)),
+      right_child_(std::move(right_child)),
+      build_rows_(NUM_PARTITIONS),
+      build_bytes_(NUM_PARTITIONS),
+      hash_tables_(NUM_PARTITIONS),
+      radix_partitions_(NUM_PARTITIONS),
+      chunk_bases_(NUM_PARTITIONS + 1),
+      build_spills_(NUM_PARTITIONS),
+      probe_spills_(NUM_PARTITIONS) {}
+
+void HashJoinExecutor::Init() {
+  left_child_->Init();
+  right_child_->Init();
+  ClearPending();
+  pending_.clear();
+  probe_file_.reset();
+  level_ = 0;
+  Build([this](TupleBatch *batch) { return left_child_->NextBatch(batch); });
+  probe_batch_.Reset(right_child_->GetOutputSchema());
+  probe_order_.clear();
+  probe_pos_ = 0;
+  build_matches_.clear();
+  match_pos_ = 0;
+}
+
+/*
+ * Rows with a NULL join key never match, and are left out of the partitions.
+ */
+template <typename Source>
+void HashJoinExecutor::Build(Source &&next_batch) {
+  const Schema *schema = left_child_->GetOutputSchema();
+  for (uint32_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+    build_rows_[partition].Reset(schema);
+    build_bytes_[partition] = 0;
+    hash_tables_[partition].clear();
+    build_spills_[partition].reset();
+    probe_spills_[partition].reset();
+  }
+  size_t resident_bytes = 0;
+  TupleBatch batch;
+  std::vector<Value> keys;
+  while (next_batch(&batch)) {
+    plan_->LeftJoinKeyExpression()->EvaluateBatch(batch, &keys);
+    for (uint32_t row = 0; row < batch.Size(); row++) {
+      if (keys[row].IsNull()) {
+        continue;
+      }
+      uint32_t partition = PartitionOf(HashUtil::HashValue(&keys[row]));
+      if (build_spills_[partition] != nullptr) {
+        build_spills_[partition]->Append(batch, row);
+        continue;
+      }
+      size_t bytes = RowBytes(batch, row);
+      build_rows_[partition].AppendRow(batch, row);
+      build_bytes_[partition] += bytes;
+      resident_bytes += bytes;
+    }
+    while (resident_bytes > plan_->GetMemoryBudget() && level_ < MAX_SPILL_LEVEL) {
+      uint32_t largest = 0;
+      for (uint32_t partition = 1; partition < NUM_PARTITIONS; partition++) {
+        if (build_bytes_[partition] > build_bytes_[largest]) {
+          largest = partition;
+        }
+      }
+      resident_bytes -= build_bytes_[largest];
+      SpillPartition(largest);
+    }
+  }
+  for (uint32_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+    uint32_t num_chunks = 0;
+    if (build_spills_[partition] != nullptr) {
+      probe_spills_[partition] =
+          std::make_unique<SpillFile>(exec_ctx_->GetBufferPoolManager(), right_child_->GetOutputSchema());
+    } else if (plan_->IsRadixPartitioned()) {
+      BuildRadixPartition(partition);
+      num_chunks = 1U << radix_partitions_[partition].bits_;
+    } else {
+      plan_->LeftJoinKeyExpression()->EvaluateBatch(build_rows_[partition], &keys);
+      for (uint32_t row = 0; row < build_rows_[partition].Size(); row++) {
+        hash_tables_[partition].emplace(HashJoinKey{keys[row]}, row);
+      }
+    }
+    chunk_bases_[partition + 1] = chunk_bases_[partition] + num_chunks;
+  }
+}
+
+/*
+ * The rows are ordered by chunk with a counting sort, and a chunk of n rows gets a table of at least 2n slots, so that
+ * probes end at an empty slot after a few slots.
+ */
+void HashJoinExecutor::BuildRadixPartition(uint32_t partition) {
+  TupleBatch &rows = build_rows_[partition];
+  RadixPartition &radix = radix_partitions_[partition];
+  std::vector<Value> keys;
+  plan_->LeftJoinKeyExpression()->EvaluateBatch(rows, &keys);
+  std::vector<hash_t> hashes(rows.Size());
+  for (uint32_t row = 0; row < rows.Size(); row++) {
+    hashes[row] = HashUtil::HashValue(&keys[row]);
+  }
+
+  radix.bits_ = 0;
+  while ((build_bytes_[partition] >> radix.bits_) > static_cast<size_t>(HASH_JOIN_RADIX_CHUNK_BYTES) &&
+         radix.bits_ < MAX_RADIX_BITS) {
+    radix.bits_++;
+  }
+  uint32_t num_chunks = 1U << radix.bits_;
+  std::vector<uint32_t> chunk_rows(num_chunks + 1, 0);
+  for (uint32_t row = 0; row < rows.Size(); row++) {
+    chunk_rows[ChunkOf(hashes[row], radix.bits_) + 1]++;
+  }
+  for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+    chunk_rows[chunk + 1] += chunk_rows[chunk];
+  }
+  std::vector<uint32_t> order(rows.Size());
+  std::vector<uint32_t> next_row(chunk_rows.begin(), chunk_rows.end() - 1);
+  for (uint32_t row = 0; row < rows.Size(); row++) {
+    order[next_row[ChunkOf(hashes[row], radix.bits_)]++] = row;
+  }
+  TupleBatch ordered_rows(rows.GetSchema());
+  std::vector<hash_t> ordered_hashes;
+  ordered_hashes.reserve(rows.Size());
+  radix.keys_.clear();
+  radix.keys_.reserve(rows.Size());
+  for (uint32_t row : order) {
+    ordered_rows.AppendRow(rows, row);
+    ordered_hashes.push_back(hashes[row]);
+    radix.keys_.push_back(std::move(keys[row]));
+  }
+  rows = std::move(ordered_rows);
+
+  radix.chunk_slots_.assign(num_chunks + 1, 0);
+  for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+    uint32_t size = chunk_rows[chunk + 1] - chunk_rows[chunk];
+    uint32_t num_slots = size == 0 ? 0 : 2;
+    while (num_slots < 2 * size) {
+      num_slots *= 2;
+    }
+    radix.chunk_slots_[chunk + 1] = radix.chunk_slots_[chunk] + num_slots;
+  }
+  radix.slots_.assign(radix.chunk_slots_.back(), RadixSlot{0, EMPTY_ROW});
+  for (uint32_t chunk = 0; chunk < num_chunks; chunk++) {
+    RadixSlot *slots = radix.slots_.data() + radix.chunk_slots_[chunk];
+    uint32_t mask = radix.chunk_slots_[chunk + 1] - radix.chunk_slots_[chunk] - 1;
+    for (uint32_t row = chunk_rows[chunk]; row < chunk_rows[chunk + 1]; row++) {
+      auto hash = static_cast<uint32_t>(ordered_hashes[row] >> 32);
+      uint32_t slot = hash & mask;
+      while (slots[slot].row_ != EMPTY_ROW) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = RadixSlot{hash, row};
+    }
+  }
+}
+
+void HashJoinExecutor::SpillPartition(uint32_t partition) {
+  const Schema *schema = left_child_->GetOutputSchema();
+  auto spill = std::make_unique<SpillFile>(exec_ctx_->GetBufferPoolManager(), schema);
+  for (uint32_t row = 0; row < build_rows_[partition].Size(); row++) {
+    spill->Append(build_rows_[partition], row);
+  }
+  build_spills_[partition] = std::move(spill);
+  build_rows_[partition] = TupleBatch(schema);
+  build_bytes_[partition] = 0;
+}
+
+size_t HashJoinExecutor::RowBytes(const TupleBatch &batch, uint32_t row) {
+  size_t bytes = sizeof(RID);
+  const Schema *schema = batch.GetSchema();
+  for (uint32_t col_idx = 0; col_idx < schema->GetColumnCount(); col_idx++) {
+    bytes += sizeof(Value);
+    const Value &value = batch.GetValue(row, col_idx);
+    if (!schema->GetColumn(col_idx).IsInlined() && !value.IsNull()) {
+      bytes += value.GetLength();
+    }
+  }
+  return bytes;
+}
+
+/*
+ * A batch of probe rows never mixes rows of two passes, whose partitions are those of different levels.
+ */
+bool HashJoinExecutor::NextProbeRows() {
+  const uint32_t max_rows = plan_->IsRadixPartitioned() ? RADIX_PROBE_BATCHES * TupleBatch::BATCH_SIZE : 1;
+  probe_order_.clear();
+  probe_pos_ = 0;
+  while (true) {
+    probe_batch_.Reset(right_child_->GetOutputSchema());
+    TupleBatch batch;
+    while (probe_batch_.Size() < max_rows &&
+           (probe_file_ == nullptr ? right_child_->NextBatch(&batch) : probe_file_->NextBatch(&batch))) {
+      if (probe_batch_.IsEmpty()) {
+        probe_batch_ = std::move(batch);
+      } else {
+        probe_batch_.AppendBatch(batch);
+      }
+    }
+    if (!probe_batch_.IsEmpty()) {
+      break;
+    }
+    if (!StartNextPass()) {
+      return false;
+    }
+  }
+
+  plan_->RightJoinKeyExpression()->EvaluateBatch(probe_batch_, &probe_keys_);
+  probe_hashes_.resize(probe_batch_.Size());
+  for (uint32_t row = 0; row < probe_batch_.Size(); row++) {
+    if (probe_keys_[row].IsNull()) {
+      continue;
+    }
+    probe_hashes_[row] = HashUtil::HashValue(&probe_keys_[row]);
+    uint32_t partition = PartitionOf(probe_hashes_[row]);
+    if (probe_spills_[partition] != nullptr) {
+      probe_spills_[partition]->Append(probe_batch_, row);
+      continue;
+    }
+    probe_order_.push_back(row);
+  }
+  if (!plan_->IsRadixPartitioned()) {
+    return true;
+  }
+
+  // Order the rows by chunk, with a counting sort on the chunks of all the partitions.
+  auto chunk_of = [this](uint32_t row) {
+    uint32_t partition = PartitionOf(probe_hashes_[row]);
+    return chunk_bases_[partition] + ChunkOf(probe_hashes_[row], radix_partitions_[partition].bits_);
+  };
+  std::vector<uint32_t> next_row(chunk_bases_.back() + 1, 0);
+  for (uint32_t row : probe_order_) {
+    next_row[chunk_of(row) + 1]++;
+  }
+  for (uint32_t chunk = 0; chunk + 1 < next_row.size(); chunk++) {
+    next_row[chunk + 1] += next_row[chunk];
+  }
+  std::vector<uint32_t> order(probe_order_.size());
+  for (uint32_t row : probe_order_) {
+    order[next_row[chunk_of(row)]++] = row;
+  }
+  probe_order_ = std::move(order);
+  return true;
+}
+
+/*
+ * A pair of partitions without probe rows has no matches, so it does not need a pass.
+ */
+bool HashJoinExecutor::StartNextPass() {
+  for (uint32_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+    if (build_spills_[partition] != nullptr && probe_spills_[partition]->GetNumRows() > 0) {
+      pending_.push_back({std::move(build_spills_[partition]), std::move(probe_spills_[partition]), level_ + 1});
+    }
+    build_spills_[partition].reset();
+    probe_spills_[partition].reset();
+  }
+  if (pending_.empty()) {
+    return false;
+  }
+  SpilledPartition next = std::move(pending_.back());
+  pending_.pop_back();
+  level_ = next.level_;
+  Build([&next](TupleBatch *batch) { return next.build_->NextBatch(batch); });
+  probe_file_ = std::move(next.probe_);
+  return true;
+}
+
+void HashJoinExecutor::FindMatches(uint32_t row) {
+  match_row_ = row;
+  match_partition_ = PartitionOf(probe_hashes_[row]);
+  build_matches_.clear();
+  match_pos_ = 0;
+  if (plan_->IsRadixPartitioned()) {
+    ProbeChunk(match_partition_, row);
+    return;
+  }
+  auto range = hash_tables_[match_partition_].equal_range(HashJoinKey{probe_keys_[row]});
+  for (auto it = range.first; it != range.second; ++it) {
+    build_matches_.push_back(it->second);
+  }
+}
+
+void HashJoinExecutor::ProbeChunk(uint32_t partition, uint32_t row) {
+  const RadixPartition &radix = radix_partitions_[partition];
+  uint32_t chunk = ChunkOf(probe_hashes_[row], radix.bits_);
+  uint32_t num_slots = radix.chunk_slots_[chunk + 1] - radix.chunk_slots_[chunk];
+  if (num_slots == 0) {
+    return;
+  }
+  const RadixSlot *slots = radix.slots_.data() + radix.chunk_slots_[chunk];
+  auto hash = static_cast<uint32_t>(probe_hashes_[row] >> 32);
+  for (uint32_t slot = hash & (num_slots - 1); slots[slot].row_ != EMPTY_ROW; slot = (slot + 1) & (num_slots - 1)) {
+    if (slots[slot].hash_ == hash &&
+        radix.keys_[slots[slot].row_].CompareEquals(probe_keys_[row]) == CmpBool::CmpTrue) {
+      build_matches_.push_back(slots[slot].row_);
+    }
+  }
+}
 
-void HashJoinExecutor::Init() {}
+bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
 
-bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool HashJoinExecutor::NextBatch(TupleBatch *batch) {
+  const Schema *output_schema = GetOutputSchema();
+  batch->Reset(output_schema);
+  left_matches_.Reset(left_child_->GetOutputSchema());
+  right_matches_.Reset(right_child_->GetOutputSchema());
+  // A probe row with more matches than fit in the batch goes on in the next batch.
+  while (!left_matches_.IsFull()) {
+    if (match_pos_ == build_matches_.size()) {
+      if (probe_pos_ == probe_order_.size()) {
+        if (!NextProbeRows()) {
+          break;
+        }
+        continue;
+      }
+      FindMatches(probe_order_[probe_pos_++]);
+    }
+    for (; !left_matches_.IsFull() && match_pos_ < build_matches_.size(); match_pos_++) {
+      left_matches_.AppendRow(build_rows_[match_partition_], build_matches_[match_pos_]);
+      right_matches_.AppendRow(probe_batch_, match_row_);
+    }
+  }
+  for (uint32_t col_idx = 0; col_idx < output_schema->GetColumnCount(); col_idx++) {
+    output_schema->GetColumn(col_idx).GetExpr()->EvaluateJoinBatch(left_matches_, right_matches_,
+                                                                   batch->MutableColumn(col_idx));
+  }
+  batch->MutableRids()->resize(left_matches_.Size());
+  return !batch->IsEmpty();
+}
 
 }  // namespace bustub
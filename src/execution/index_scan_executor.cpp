@@ -11,12 +11,104 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "storage/index/b_plus_tree_index.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  IndexInfo *index_info = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info->table_name_);
+  switch (index_info->key_size_) {
+    case 4:
+      StartScan<4>(index_info->index_.get());
+      break;
+    case 8:
+      StartScan<8>(index_info->index_.get());
+      break;
+    case 16:
+      StartScan<16>(index_info->index_.get());
+      break;
+    case 32:
+      StartScan<32>(index_info->index_.get());
+      break;
+    case 64:
+      StartScan<64>(index_info->index_.get());
+      break;
+    default:
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "no B+ tree index with this key size");
+  }
+  tuples_.clear();
+  tuple_index_ = 0;
+}
+
+template <size_t KeySize>
+void IndexScanExecutor::StartScan(Index *index) {
+  auto *tree_index = dynamic_cast<BPlusTreeIndex<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *>(index);
+  if (tree_index == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "index scans need a B+ tree index");
+  }
+  // The function must be copyable, and the iterator is not.
+  auto iterator = std::make_shared<IndexIterator<GenericKey<KeySize>, RID, GenericComparator<KeySize>>>(
+      tree_index->ScanRange(plan_->GetLowKey(), plan_->IsLowInclusive(), plan_->GetHighKey(),
+                            plan_->IsHighInclusive()));
+  next_batch_ = [iterator](std::vector<RID> *rids) { return iterator->NextBatch(rids); };
+}
 
-void IndexScanExecutor::Init() {}
+bool IndexScanExecutor::FetchNextTuples() {
+  std::vector<RID> rids;
+  do {
+    if (!next_batch_(&rids)) {
+      return false;
+    }
+  } while (rids.empty());
+  // Read the tuples in page order, then hand them out in the key order of the RIDs.
+  std::vector<RID> page_order(rids);
+  auto less = [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); };
+  std::sort(page_order.begin(), page_order.end(), less);
+  std::vector<Tuple> page_tuples;
+  if (!table_info_->table_->GetTuples(page_order, &page_tuples, exec_ctx_->GetTransaction())) {
+    return false;
+  }
+  tuples_.clear();
+  tuple_index_ = 0;
+  for (const RID &rid : rids) {
+    auto it = std::lower_bound(page_tuples.begin(), page_tuples.end(), rid,
+                               [&](const Tuple &tuple, const RID &key) { return less(tuple.GetRid(), key); });
+    // A tuple that was deleted since it was indexed is not read.
+    if (it != page_tuples.end() && it->GetRid() == rid) {
+      tuples_.push_back(std::move(*it));
+    }
+  }
+  return true;
+}
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  auto predicate = plan_->GetPredicate();
+  while (true) {
+    while (tuple_index_ == tuples_.size()) {
+      if (!FetchNextTuples()) {
+        return false;
+      }
+    }
+    const Tuple &table_tuple = tuples_[tuple_index_++];
+    if (predicate == nullptr || predicate->Evaluate(&table_tuple, &table_info_->schema_).GetAs<bool>()) {
+      std::vector<Value> values;
+      values.reserve(GetOutputSchema()->GetColumnCount());
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values.push_back(column.GetExpr()->Evaluate(&table_tuple, &table_info_->schema_));
+      }
+      *tuple = Tuple(values, GetOutputSchema());
+      *rid = table_tuple.GetRid();
+      return true;
+    }
+  }
+}
 
 }  // namespace bustub
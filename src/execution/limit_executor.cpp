@@ -10,16 +10,34 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+
 #include "execution/executors/limit_executor.h"
 
 namespace bustub {
 
 LimitExecutor::LimitExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *plan,
                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void LimitExecutor::Init() {
+  child_executor_->Init();
+  ClearPending();
+  count_ = 0;
+}
 
-void LimitExecutor::Init() {}
+bool LimitExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
 
-bool LimitExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool LimitExecutor::NextBatch(TupleBatch *batch) {
+  if (count_ >= plan_->GetLimit() || !child_executor_->NextBatch(batch)) {
+    batch->Reset(GetOutputSchema());
+    return false;
+  }
+  batch->Truncate(static_cast<uint32_t>(std::min<size_t>(batch->Size(), plan_->GetLimit() - count_)));
+  count_ += batch->Size();
+  return true;
+}
 
 }  // namespace bustub
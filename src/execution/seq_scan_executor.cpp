@@ -12,12 +12,186 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+/** Marks the columns of the input that an expression reads. */
+static void CollectColumns(const AbstractExpression *expr, std::vector<bool> *read_columns) {
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    (*read_columns)[column->GetColIdx()] = true;
+  }
+  for (const auto *child : expr->GetChildren()) {
+    CollectColumns(child, read_columns);
+  }
+}
+
+/** @return true if the output columns are the columns of the table, in order and with the same types */
+static bool OutputsTableColumns(const Schema *output_schema, const Schema &table_schema) {
+  if (output_schema->GetColumnCount() != table_schema.GetColumnCount()) {
+    return false;
+  }
+  for (uint32_t col_idx = 0; col_idx < output_schema->GetColumnCount(); col_idx++) {
+    const Column &output_column = output_schema->GetColumn(col_idx);
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(output_column.GetExpr());
+    if (column == nullptr || column->GetColIdx() != col_idx ||
+        output_column.GetType() != table_schema.GetColumn(col_idx).GetType()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan,
+                                 std::shared_ptr<MorselDispenser> dispenser)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())),
+      table_iter_(table_info_->table_->End()),
+      outputs_table_tuples_(OutputsTableColumns(plan->OutputSchema(), table_info_->schema_)),
+      dispenser_(std::move(dispenser)) {
+  std::vector<bool> read_columns(table_info_->schema_.GetColumnCount(), false);
+  if (plan_->GetPredicate() != nullptr) {
+    CollectColumns(plan_->GetPredicate(), &read_columns);
+  }
+  for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+    CollectColumns(column.GetExpr(), &read_columns);
+  }
+  for (uint32_t col_idx = 0; col_idx < read_columns.size(); col_idx++) {
+    if (read_columns[col_idx]) {
+      scan_columns_.push_back(col_idx);
+    }
+  }
+}
+
+void SeqScanExecutor::Init() {
+  ClearPending();
+  if (dispenser_ != nullptr) {
+    // The dispenser is reset by the operator that runs the copies of the scan.
+    morsel_.clear();
+    morsel_pos_ = 0;
+    page_tuples_.clear();
+    tuple_pos_ = 0;
+    return;
+  }
+  auto *table = table_info_->table_.get();
+  table_iter_ = table->Begin(exec_ctx_->GetTransaction(), table->ScanNeedsBufferRing() ? &strategy_ : nullptr);
+}
+
+/*
+ * Next evaluates the expressions on each tuple of the table as it is, instead of decoding the tuples into a batch and
+ * building each output tuple back from the values of the batch.
+ */
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  TableIterator end = table_info_->table_->End();
+  while (true) {
+    const Tuple *table_tuple;
+    if (dispenser_ != nullptr) {
+      if (tuple_pos_ == page_tuples_.size() && !ReadMorselPage()) {
+        return false;
+      }
+      table_tuple = &page_tuples_[tuple_pos_++];
+    } else {
+      if (table_iter_ == end) {
+        return false;
+      }
+      table_tuple = &*table_iter_;
+    }
+    bool matches = Matches(*table_tuple);
+    if (matches) {
+      MakeOutputTuple(*table_tuple, tuple);
+      *rid = table_tuple->GetRid();
+    }
+    if (dispenser_ == nullptr) {
+      ++table_iter_;
+    }
+    if (matches) {
+      return true;
+    }
+  }
+}
+
+bool SeqScanExecutor::Matches(const Tuple &table_tuple) const {
+  const AbstractExpression *predicate = plan_->GetPredicate();
+  if (predicate == nullptr) {
+    return true;
+  }
+  Value value = predicate->Evaluate(&table_tuple, &table_info_->schema_);
+  return !value.IsNull() && value.GetAs<bool>();
+}
+
+void SeqScanExecutor::MakeOutputTuple(const Tuple &table_tuple, Tuple *tuple) const {
+  if (outputs_table_tuples_) {
+    *tuple = table_tuple;
+    return;
+  }
+  const Schema *output_schema = plan_->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(output_schema->GetColumnCount());
+  for (const auto &column : output_schema->GetColumns()) {
+    values.push_back(column.GetExpr()->Evaluate(&table_tuple, &table_info_->schema_));
+  }
+  *tuple = Tuple(values, output_schema);
+}
+
+bool SeqScanExecutor::NextBatch(TupleBatch *batch) {
+  const Schema *output_schema = GetOutputSchema();
+  auto predicate = plan_->GetPredicate();
+  TableIterator end = table_info_->table_->End();
+  batch->Reset(output_schema);
+  while (batch->IsEmpty()) {
+    table_batch_.Reset(&table_info_->schema_);
+    if (dispenser_ != nullptr) {
+      ReadMorsels();
+    } else {
+      for (; !table_batch_.IsFull() && table_iter_ != end; ++table_iter_) {
+        table_batch_.Append(*table_iter_, table_iter_->GetRid(), scan_columns_);
+      }
+    }
+    if (table_batch_.IsEmpty()) {
+      break;
+    }
+    if (predicate != nullptr) {
+      predicate->EvaluateBatch(table_batch_, &selection_);
+      table_batch_.Select(selection_);
+    }
+    for (uint32_t col_idx = 0; col_idx < output_schema->GetColumnCount(); col_idx++) {
+      output_schema->GetColumn(col_idx).GetExpr()->EvaluateBatch(table_batch_, batch->MutableColumn(col_idx));
+    }
+    *batch->MutableRids() = table_batch_.GetRids();
+  }
+  return !batch->IsEmpty();
+}
 
-void SeqScanExecutor::Init() {}
+void SeqScanExecutor::ReadMorsels() {
+  while (!table_batch_.IsFull() && (tuple_pos_ < page_tuples_.size() || ReadMorselPage())) {
+    const Tuple &tuple = page_tuples_[tuple_pos_++];
+    table_batch_.Append(tuple, tuple.GetRid(), scan_columns_);
+  }
+}
 
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool SeqScanExecutor::ReadMorselPage() {
+  auto *table = table_info_->table_.get();
+  BufferAccessStrategy *ring = table->ScanNeedsBufferRing() ? &strategy_ : nullptr;
+  page_tuples_.clear();
+  tuple_pos_ = 0;
+  while (page_tuples_.empty()) {
+    if (morsel_pos_ == morsel_.size()) {
+      if (!dispenser_->Next(&morsel_)) {
+        return false;
+      }
+      morsel_pos_ = 0;
+      table->Prefetch(morsel_.front(), ring, morsel_.size() - 1);
+    }
+    if (!table->GetPageTuples(morsel_[morsel_pos_++], &page_tuples_, exec_ctx_->GetTransaction(), ring)) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a page of the scanned table.");
+    }
+  }
+  return true;
+}
 
 }  // namespace bustub
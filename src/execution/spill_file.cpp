@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_file.cpp
+//
+// Identification: src/execution/spill_file.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/spill_file.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+SpillFile::SpillFile(BufferPoolManager *bpm, const Schema *schema)
+    : bpm_(bpm), schema_(schema), page_(std::make_unique<TmpTuplePage>()) {
+  page_->Init(INVALID_PAGE_ID, PAGE_SIZE);
+}
+
+SpillFile::~SpillFile() {
+  for (size_t i = num_read_pages_; i < page_ids_.size(); i++) {
+    bpm_->DeletePage(page_ids_[i]);
+  }
+}
+
+void SpillFile::Append(const TupleBatch &batch, uint32_t row) { Append(batch.GetTuple(row)); }
+
+void SpillFile::Append(const Tuple &tuple) {
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  if (!page_->Insert(tuple, &tmp_tuple)) {
+    Flush();
+    if (!page_->Insert(tuple, &tmp_tuple)) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "Tuple is too large to spill.");
+    }
+  }
+  num_rows_++;
+}
+
+void SpillFile::Flush() {
+  page_id_t page_id;
+  Page *page = bpm_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't create a page to spill to.");
+  }
+  memcpy(page->GetData(), page_->GetData(), PAGE_SIZE);
+  reinterpret_cast<TmpTuplePage *>(page)->SetTablePageId(page_id);
+  bpm_->UnpinPage(page_id, true);
+  page_ids_.push_back(page_id);
+  page_->Init(INVALID_PAGE_ID, PAGE_SIZE);
+}
+
+/*
+ * The rows of the page being filled are read last, without ever going to the buffer pool.
+ */
+bool SpillFile::NextBatch(TupleBatch *batch) {
+  batch->Reset(schema_);
+  while (!batch->IsFull()) {
+    if (num_read_pages_ < page_ids_.size()) {
+      page_id_t page_id = page_ids_[num_read_pages_];
+      Page *page = bpm_->FetchPage(page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a spilled page.");
+      }
+      bool read_all = ReadPage(reinterpret_cast<TmpTuplePage *>(page), batch);
+      bpm_->UnpinPage(page_id, false);
+      if (read_all) {
+        bpm_->DeletePage(page_id);
+        num_read_pages_++;
+      }
+    } else if (page_->GetFreeSpacePointer() < PAGE_SIZE) {
+      if (ReadPage(page_.get(), batch)) {
+        page_->Init(INVALID_PAGE_ID, PAGE_SIZE);
+      }
+    } else {
+      break;
+    }
+  }
+  return !batch->IsEmpty();
+}
+
+bool SpillFile::ReadPage(TmpTuplePage *page, TupleBatch *batch) {
+  if (read_offset_ == 0) {
+    read_offset_ = page->GetFreeSpacePointer();
+  }
+  Tuple tuple;
+  while (read_offset_ < PAGE_SIZE && !batch->IsFull()) {
+    read_offset_ = page->Get(read_offset_, &tuple);
+    batch->Append(tuple, RID());
+  }
+  if (read_offset_ < PAGE_SIZE) {
+    return false;
+  }
+  read_offset_ = 0;
+  return true;
+}
+
+}  // namespace bustub
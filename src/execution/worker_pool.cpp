@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.cpp
+//
+// Identification: src/execution/worker_pool.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/worker_pool.h"
+
+#include <utility>
+
+namespace bustub {
+
+WorkerPool::~WorkerPool() {
+  {
+    std::scoped_lock lock(latch_);
+    stopped_ = true;
+    cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+std::future<void> WorkerPool::Submit(std::function<void()> task) {
+  std::packaged_task<void()> packaged(std::move(task));
+  auto future = packaged.get_future();
+  std::scoped_lock lock(latch_);
+  tasks_.push_back(std::move(packaged));
+  if (tasks_.size() > num_idle_) {
+    workers_.emplace_back([this] { Work(); });
+  } else {
+    cv_.notify_one();
+  }
+  return future;
+}
+
+size_t WorkerPool::GetNumWorkers() {
+  std::scoped_lock lock(latch_);
+  return workers_.size();
+}
+
+void WorkerPool::Work() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    num_idle_++;
+    cv_.wait(lock, [&] { return stopped_ || !tasks_.empty(); });
+    num_idle_--;
+    if (tasks_.empty()) {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
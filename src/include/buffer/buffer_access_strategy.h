@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class BufferPoolManagerInstance;
+
+/**
+ * BufferAccessStrategy keeps a bulk operation, such as a full table scan or a table load, from flushing the rest of
+ * the buffer pool. The operation reads the pages it misses into a small private ring of frames and keeps recycling
+ * those frames, much like the ring buffers of PostgreSQL.
+ *
+ * Only misses go through the ring: a page that is already cached is shared as usual. The ring fills up with frames
+ * taken from the pool the normal way. Once it is full, a miss reuses the oldest frame of the ring, unless the page in
+ * it is pinned or was evicted by someone else in the meantime; then that slot is refilled from the pool. A dirty page
+ * is written back before its frame is reused.
+ *
+ * A strategy belongs to a single operation and must not be shared between threads. The ring is split evenly between
+ * the instances of a parallel buffer pool.
+ */
+class BufferAccessStrategy {
+ public:
+  /** @param ring_size the number of frames in the ring */
+  explicit BufferAccessStrategy(size_t ring_size = BUFFER_RING_SIZE) : ring_size_(ring_size) {}
+
+  /** @return the number of frames in the ring */
+  size_t GetRingSize() const { return ring_size_; }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  /** A frame of the ring and the page that was read into it. */
+  struct RingEntry {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+  };
+
+  /** The part of the ring in one buffer pool instance. */
+  struct Ring {
+    std::vector<RingEntry> entries_;
+    /** The entry to recycle next, once the ring is full. */
+    size_t next_{0};
+  };
+
+  const size_t ring_size_;
+  std::unordered_map<const BufferPoolManagerInstance *, Ring> rings_;
+};
+
+}  // namespace bustub
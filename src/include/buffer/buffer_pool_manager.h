@@ -15,7 +15,9 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -84,6 +86,34 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page on behalf of a bulk operation. If the page is not cached, it is read into the strategy's ring.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring of the operation, nullptr to fetch the page like FetchPage does
+   * @return the requested page, or nullptr if no frame was free
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPgImp(page_id, strategy);
+  }
+
+  /**
+   * Create a new page on behalf of a bulk operation, in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the ring of the operation, nullptr to create the page like NewPage does
+   * @return the new page, or nullptr if no frame was free
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) { return NewPgImp(page_id, strategy); }
+
+  /**
+   * Start reading pages into the buffer pool ahead of their use. This is only a hint: the pages are not pinned, the
+   * reads are not waited for, and pages that are already cached or for which no frame is free are skipped.
+   * @param page_ids the pages to read ahead
+   * @param strategy the ring of the bulk operation the pages are read for, if any
+   */
+  void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) {
+    PrefetchImp(page_ids, strategy);
+  }
+
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
@@ -108,6 +138,14 @@ class BufferPoolManager {
    */
   virtual Page *FetchPgImp(page_id_t page_id) = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool, reading it into the strategy's ring if it is not cached.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring to use, nullptr for none
+   * @return the requested page
+   */
+  virtual Page *FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) = 0;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +168,14 @@ class BufferPoolManager {
    */
   virtual Page *NewPgImp(page_id_t *page_id) = 0;
 
+  /**
+   * Creates a new page in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the ring to use, nullptr for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) = 0;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -141,5 +187,12 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Start reading pages into the buffer pool.
+   * @param page_ids the pages to read ahead
+   * @param strategy the ring to read the pages into, nullptr for none
+   */
+  virtual void PrefetchImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) = 0;
 };
 }  // namespace bustub
@@ -12,12 +12,21 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_replacer.h"
+#include "buffer/page_cleaner.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -26,6 +35,25 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Fetching or unpinning a page that is already in the pool takes no lock: the page table is a lock-free PageTable,
+ * and pages are pinned by atomically incrementing their pin count. A frame being evicted has its pin count set to
+ * EVICTING_PIN_COUNT, which makes concurrent optimistic pins fail and fall back to the latched path. Only misses, new
+ * pages, deletions and evictions take the latch, and a miss lets go of it while it reads its page.
+ *
+ * To keep the replacer's latch off the hit path, a frame stays in the replacer while it is pinned and accessed again,
+ * and hits are reported through Replacer::RecordAccess, which does not block. The replacement policy is chosen when
+ * the instance is created.
+ *
+ * Misses on behalf of a bulk operation recycle the frames of the operation's BufferAccessStrategy rather than evict
+ * pages of the rest of the pool.
+ *
+ * Prefetched pages are read asynchronously. While its read is in flight, a page is in the page table but its frame
+ * keeps EVICTING_PIN_COUNT; a fetch of the page waits for the read, and an eviction that finds nothing else to evict
+ * waits for the outstanding reads to complete.
+ *
+ * Dirty pages are normally written out ahead of their eviction by a PageCleaner, see CleanFrames. A standalone
+ * instance starts its own cleaner; the instances of a parallel buffer pool share the one their owner starts.
  */
 class BufferPoolManagerInstance : public BufferPoolManager {
  public:
@@ -34,18 +62,22 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
   /**
-   * Creates a new BufferPoolManagerInstance.
+   * Creates a new BufferPoolManagerInstance without a page cleaner.
    * @param pool_size the size of the buffer pool
    * @param num_instances total number of BPIs in parallel BPM
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -58,6 +90,18 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /**
+   * Write out the dirty pages among the frames that are next in line for eviction, so that the next target_frames
+   * evictions find clean victims. The pages are written as one batch in page id order, and a page is skipped until
+   * the log is persistent up to its LSN. Only the page cleaner calls this, never concurrently.
+   * @param target_frames the number of clean eviction candidates to aim for
+   * @return the number of pages written
+   */
+  size_t CleanFrames(size_t target_frames);
+
+  /** @param page_cleaner the cleaner to wake up when an eviction has to write a dirty page itself */
+  void SetPageCleaner(PageCleaner *page_cleaner) { page_cleaner_ = page_cleaner; }
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -66,6 +110,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page from the buffer pool, reading it into the strategy's ring if it is not cached.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring to use, nullptr for none
+   * @return the requested page
+   */
+  Page *FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -88,6 +140,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the ring to use, nullptr for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -100,6 +160,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Start reading pages into the buffer pool.
+   * @param page_ids the pages to read ahead
+   * @param strategy the ring to read the pages into, nullptr for none
+   */
+  void PrefetchImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
   /**
    * Allocate a page on disk.∂
    * @return the id of the allocated page
@@ -121,6 +188,116 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
+  /**
+   * Try to pin the page in a frame without taking the latch.
+   * @param frame_id the frame the page table pointed to
+   * @param page_id the page expected to be in the frame
+   * @param reference false if the pin should not count as an access to the page
+   * @return true if the frame was pinned and holds page_id
+   */
+  bool TryPin(frame_id_t frame_id, page_id_t page_id, bool reference = true);
+
+  /**
+   * Unpin a frame, making it evictable if this was the last pin.
+   * @param frame_id the frame to unpin
+   * @return false if the frame was not pinned
+   */
+  bool UnpinFrame(frame_id_t frame_id);
+
+  /**
+   * Find a frame for a new page, from the free list first and the replacer second. A frame taken from the replacer is
+   * written back if dirty and removed from the page table; dirty pages whose log records are not on disk yet are
+   * passed over. The caller must hold latch_, which is released while waiting, so anything the caller looked up before
+   * may have changed when this returns.
+   * @param latch the caller's hold on latch_
+   * @param[out] frame_id the frame that can be reused; its pin count is left at EVICTING_PIN_COUNT
+   * @param wait false to give up rather than wait for frames that are being read or written in the background
+   * @return false if every frame is pinned or waits for the log
+   */
+  bool FindVictimFrame(std::unique_lock<std::mutex> *latch, frame_id_t *frame_id, bool wait = true);
+
+  /**
+   * Find a frame for a page that a bulk operation misses: the next frame of the strategy's ring if it can be reused,
+   * a victim frame otherwise. The caller must hold latch_ and hand the frame back with AddToRing once it is loaded.
+   * @param latch the caller's hold on latch_, released while waiting as for FindVictimFrame
+   * @param[out] frame_id the frame that can be reused; its pin count is left at EVICTING_PIN_COUNT
+   * @param strategy the ring of the operation, nullptr to take a victim frame
+   * @param wait as for FindVictimFrame
+   * @return false if every frame is pinned
+   */
+  bool FindFrame(std::unique_lock<std::mutex> *latch, frame_id_t *frame_id, BufferAccessStrategy *strategy,
+                 bool wait = true);
+
+  /**
+   * Put a frame that FindFrame returned into the strategy's ring, in place of the entry it recycled if any. The
+   * caller must hold latch_.
+   * @param strategy the ring of the operation, nullptr for none
+   * @param frame_id the frame
+   * @param page_id the page loaded into the frame
+   */
+  void AddToRing(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Claim a frame of a ring if it still holds the page the ring put there and nobody has it pinned. The caller must
+   * hold latch_.
+   * @param frame_id the frame
+   * @param page_id the page the ring loaded into the frame
+   * @return true if the frame was claimed and its page evicted
+   */
+  bool ReclaimRingFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Put a claimed frame that holds no page on the free list. The caller must hold latch_.
+   * @param frame_id the frame, with its pin count at EVICTING_PIN_COUNT
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * @param page a page in a frame that is pinned or claimed
+   * @return true if the page is clean or the log records that changed it are on disk, i.e. it may be written back
+   */
+  bool IsLogged(Page *page) const;
+
+  /**
+   * Hand frames that a victim search passed over back to the replacer. The caller must hold latch_.
+   * @param frame_ids the frames, unpinned
+   */
+  void ReturnToReplacer(const std::vector<frame_id_t> &frame_ids);
+
+  /**
+   * Write back the page in a claimed frame if it is dirty, and remove it from the page table. The caller must hold
+   * latch_. Callers only claim frames whose page IsLogged.
+   * @param frame_id the frame, with its pin count at EVICTING_PIN_COUNT
+   */
+  void EvictFrame(frame_id_t frame_id);
+
+  /**
+   * @param strategy a bulk operation's strategy
+   * @return the number of frames of the strategy's ring that are in this instance
+   */
+  size_t RingCapacity(const BufferAccessStrategy *strategy) const {
+    return std::max<size_t>(1, (strategy->GetRingSize() + num_instances_ - 1) / num_instances_);
+  }
+
+  /** Make the frames of the prefetched pages whose reads have completed evictable. The caller must hold latch_. */
+  void ReapPendingReads();
+
+  /** A read that is in flight, of a prefetch or of a fetch that missed. */
+  struct PendingRead {
+    /**
+     * The batch of requests a prefetch read was submitted with, which must stay alive until all of them complete.
+     * nullptr for the read of a fetch, which publishes the frame itself.
+     */
+    std::shared_ptr<std::vector<DiskRequest>> batch_;
+    /** Becomes ready when the read completes, with false if it failed. */
+    std::shared_future<bool> done_;
+  };
+
+  /** Pin count of a frame that is being evicted or has not been handed out yet. */
+  static constexpr int EVICTING_PIN_COUNT = -1;
+  /** Longest a search for a frame sleeps before looking at the pool again. */
+  static constexpr std::chrono::milliseconds FRAME_WAIT_TIMEOUT{1};
+
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
@@ -136,13 +313,28 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
-  /** Replacer to find unpinned pages for replacement. */
-  Replacer *replacer_;
+  /** Page table for keeping track of buffer pool pages. Read without the latch, written with it. */
+  PageTable page_table_;
+  /**
+   * Replacer to find unpinned pages for replacement. Frames are added when their pin count drops to zero but are not
+   * removed when pinned again, so a victim must still be checked (and claimed) through its pin count.
+   */
+  std::unique_ptr<Replacer> replacer_;
+  /** Per frame: true while the frame is known to the replacer. */
+  std::unique_ptr<std::atomic<bool>[]> in_replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** Frame id -> read in flight for the frame. Protected by latch_. */
+  std::unordered_map<frame_id_t, PendingRead> pending_reads_;
+  /** Number of frames pinned by CleanFrames; evictions wait for them rather than fail. */
+  std::atomic<size_t> cleaning_frames_{0};
+  /** The page cleaner writing out this instance's pages, if any. */
+  PageCleaner *page_cleaner_{nullptr};
+  /** The page cleaner of a standalone instance. */
+  std::unique_ptr<PageCleaner> own_page_cleaner_;
+  /** This latch serializes changes to the page table, the free list, and frames being evicted or reused. */
   std::mutex latch_;
+  /** Signalled when a frame is freed or the page cleaner unpins the frames it wrote, waited on with latch_. */
+  std::condition_variable frame_available_;
 };
 }  // namespace bustub
@@ -12,7 +12,8 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +24,9 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The frames sit on a circle that a clock hand sweeps over. A frame's reference bit is set when it is unpinned or
+ * accessed; the hand clears the bits it passes and stops at the first frame whose bit was already clear.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +47,27 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
  private:
-  // TODO(student): implement me!
+  /** Number of frames on the circle. */
+  const size_t num_pages_;
+  /** Per frame: true if the frame is in the replacer. */
+  std::vector<bool> in_clock_;
+  /** Per frame: the reference bit, set without the latch. */
+  std::unique_ptr<std::atomic<bool>[]> referenced_;
+  /** The frame the clock hand points at. */
+  size_t hand_{0};
+  /** Number of frames in the replacer. */
+  size_t size_{0};
+  /** Protects in_clock_, hand_ and size_. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy (O'Neil et al., SIGMOD '93), which resists sequential scans.
+ *
+ * The victim is the frame whose K-th most recent reference lies furthest in the past. Frames with fewer than K
+ * references count as infinitely far and are evicted first, least recently accessed first. A page read once by a scan
+ * is therefore evicted before any page that has been referenced K times, however long ago.
+ *
+ * Time is a coarse clock counted in accesses: the first access to a page moves it, and so does every clock tick-th
+ * access after that, so that most hits only read it. Accesses to a frame that follow its previous access within the
+ * correlated reference period belong to the same reference: a scan touches a page many times in a row, and that must
+ * not look like reuse.
+ *
+ * Accesses are recorded with atomics and no latch, so that buffer pool hits stay lock-free. Concurrent accesses to the
+ * same frame may blur its history slightly, which only makes the policy less exact. The frames in the replacer are
+ * kept ordered by the eviction key they had when last looked at. An access only moves a key later, so a stale key is
+ * refreshed when it comes first, and a victim is found in logarithmic time.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references to track per frame
+   * @param correlated_period accesses that many clock ticks or fewer apart count as the same reference
+   * @param clock_tick the number of accesses to a frame per tick of the clock, 1 for an exact clock
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        uint64_t correlated_period = LRUK_CORRELATED_PERIOD, uint64_t clock_tick = LRUK_CLOCK_TICK);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+ private:
+  /**
+   * @param frame_id a frame in the replacer
+   * @return the frame's place in the eviction order, the smallest key is evicted first
+   */
+  std::pair<bool, uint64_t> EvictionKey(frame_id_t frame_id) const;
+
+  /** @param frame_id the frame whose access history to forget */
+  void ClearHistory(frame_id_t frame_id);
+
+  /**
+   * Bring the first frame of the eviction order up to date. The caller must hold latch_.
+   * @return true if the first frame's key was current, false if it was refreshed and the order may have changed
+   */
+  bool RefreshFirst();
+
+  /** @param frame_id a frame in the replacer, to take out of it. The caller must hold latch_. */
+  void EraseFrame(frame_id_t frame_id);
+
+  const size_t num_pages_;
+  const size_t k_;
+  const uint64_t correlated_period_;
+  const uint64_t clock_tick_;
+  /** The time of the latest tick of the clock. */
+  std::atomic<uint64_t> current_timestamp_{0};
+  /** Per frame: the number of accesses since the frame's history was cleared, which decides when it moves the clock. */
+  std::unique_ptr<std::atomic<uint64_t>[]> num_accesses_;
+  /** Per frame: the time of the last access, 0 if the frame has not been accessed. */
+  std::unique_ptr<std::atomic<uint64_t>[]> last_access_;
+  /** Per frame: the number of references, i.e. of uncorrelated accesses. */
+  std::unique_ptr<std::atomic<size_t>[]> num_references_;
+  /** Per frame, k_ entries: the times of the last k_ references, in a ring indexed by the reference count. */
+  std::unique_ptr<std::atomic<uint64_t>[]> history_;
+  /** Per frame: true if the frame is in the replacer. */
+  std::vector<bool> evictable_;
+  /** Per frame in the replacer: its key in eviction_order_. */
+  std::vector<std::pair<bool, uint64_t>> eviction_keys_;
+  /** The frames in the replacer, by the eviction key they had when last looked at. */
+  std::set<std::pair<std::pair<bool, uint64_t>, frame_id_t>> eviction_order_;
+  /** Protects evictable_, eviction_keys_ and eviction_order_. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +26,10 @@ namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Frames are ordered by when they were last unpinned. An access to a frame that is already in the list only sets its
+ * reference bit rather than moving it, so that accesses never wait for the latch; a victim whose bit is set gets a
+ * second chance at the back of the list instead.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -43,10 +50,23 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
  private:
-  // TODO(student): implement me!
+  /** Unpinned frames, least recently unpinned first. */
+  std::list<frame_id_t> lru_list_;
+  /** Frame id -> position in lru_list_. */
+  std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> lru_map_;
+  /** Per frame: set on every access, cleared when the frame enters the list or is given a second chance. */
+  std::unique_ptr<std::atomic<bool>[]> referenced_;
+  /** Protects lru_list_ and lru_map_. */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
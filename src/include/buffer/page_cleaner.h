@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_cleaner.h
+//
+// Identification: src/include/buffer/page_cleaner.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class BufferPoolManagerInstance;
+
+/**
+ * PageCleaner is a background thread that writes dirty pages out before the buffer pool needs their frames, so that
+ * evictions find clean victims and do not have to wait for a write.
+ *
+ * Every round, it asks each of its buffer pool instances to clean the frames that are next in line for eviction (see
+ * BufferPoolManagerInstance::CleanFrames). A round runs every page_cleaner_interval, or as soon as an eviction had to
+ * write a dirty page itself. A standalone instance owns a cleaner; the instances of a ParallelBufferPoolManager share
+ * one.
+ */
+class PageCleaner {
+ public:
+  /**
+   * Start the page cleaner thread.
+   * @param instances the buffer pool instances to clean
+   * @param target_percent the share of each pool, in percent, to keep clean at the head of the eviction order
+   */
+  explicit PageCleaner(std::vector<BufferPoolManagerInstance *> instances,
+                       size_t target_percent = PAGE_CLEANER_TARGET_PERCENT);
+
+  /** Stop the page cleaner thread. */
+  ~PageCleaner();
+
+  /** Start a cleaning round now, rather than at the end of the current interval. */
+  void Wake();
+
+ private:
+  /** Body of the cleaner thread. */
+  void Run();
+
+  std::vector<BufferPoolManagerInstance *> instances_;
+  const size_t target_percent_;
+  bool woken_{false};
+  bool shutdown_{false};
+  /** Protects woken_ and shutdown_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::thread thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages held by a buffer pool to the frames they live in.
+ *
+ * It is an open-addressing hash table with linear probing whose slots pack a (page id, frame id) pair into a single
+ * 64-bit atomic word. Lookups are lock-free and may run concurrently with each other and with one writer; Insert and
+ * Remove must be serialized by the caller (the buffer pool manager only calls them while holding its latch).
+ *
+ * Removed entries leave a tombstone behind so that concurrent probes never stop early. The table is sized to a
+ * multiple of the number of frames and tombstones are reused by later inserts, so probe sequences stay short.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new PageTable.
+   * @param num_frames the maximum number of entries that will be stored at the same time
+   */
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable() = default;
+
+  /**
+   * Look up the frame holding a page. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page is in the table
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Add a page that is not yet in the table. Callers must serialize Insert and Remove.
+   * @param page_id the page to add
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page from the table. Callers must serialize Insert and Remove.
+   * @param page_id the page to remove
+   * @return true if the page was in the table
+   */
+  bool Remove(page_id_t page_id);
+
+ private:
+  /** Slot key of a slot that has never been used. */
+  static constexpr page_id_t EMPTY_KEY = INVALID_PAGE_ID;
+  /** Slot key of a slot whose entry was removed. */
+  static constexpr page_id_t TOMBSTONE_KEY = INVALID_PAGE_ID - 1;
+
+  static uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t KeyOf(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t FrameOf(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the first slot probed for page_id */
+  size_t HomeSlot(page_id_t page_id) const;
+
+  /** Number of slots, always a power of two. */
+  size_t capacity_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
+
+}  // namespace bustub
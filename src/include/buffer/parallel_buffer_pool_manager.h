@@ -12,13 +12,24 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_cleaner.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * ParallelBufferPoolManager spreads pages over several BufferPoolManagerInstances, page page_id going to instance
+ * page_id % num_instances, so that accesses to different pages rarely contend on the same latch. The instances share
+ * a single page cleaner.
+ */
 class ParallelBufferPoolManager : public BufferPoolManager {
  public:
   /**
@@ -27,9 +38,10 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -53,6 +65,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
+  /**
+   * Fetch the requested page from the buffer pool, reading it into the strategy's ring if it is not cached.
+   * @param page_id id of page to be fetched
+   * @param strategy the ring to use, nullptr for none
+   * @return the requested page
+   */
+  Page *FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -75,6 +95,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   Page *NewPgImp(page_id_t *page_id) override;
 
+  /**
+   * Creates a new page in a frame of the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the ring to use, nullptr for none
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPgImp(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -86,5 +114,19 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   void FlushAllPgsImp() override;
+
+  /**
+   * Start reading pages into the buffer pool.
+   * @param page_ids the pages to read ahead
+   * @param strategy the ring to read the pages into, nullptr for none
+   */
+  void PrefetchImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
+ private:
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The instance NewPgImp tries first, advanced on every call. */
+  std::atomic<size_t> next_instance_{0};
+  /** Declared after the instances, so that it stops before they are destroyed. */
+  std::unique_ptr<PageCleaner> page_cleaner_;
 };
 }  // namespace bustub
@@ -12,10 +12,16 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be created with. */
+enum class ReplacerType { LRU, CLOCK, LRU_K };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -25,7 +31,16 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
+   * Create a replacer.
+   * @param type the replacement policy
+   * @param num_pages the maximum number of pages the replacer will be required to store
+   * @return the new replacer
+   */
+  static std::unique_ptr<Replacer> Create(ReplacerType type, size_t num_pages);
+
+  /**
+   * Remove the victim frame as defined by the replacement policy. The access history of the frame is forgotten, since
+   * it is about to hold another page.
    * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
    * @return true if a victim frame was found, false otherwise
    */
@@ -43,8 +58,28 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Record an access to the page in a frame, whether or not the frame is in the replacer. The buffer pool calls this
+   * on every pin, including the ones that take no latch, so it must be thread-safe and must not block.
+   * @param frame_id the id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+  /**
+   * Forget a frame and its access history, because its page was deleted.
+   * @param frame_id the id of the frame to forget
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Look at the frames that would be victimized next, without removing them.
+   * @param max_frames the maximum number of frames to return
+   * @param[out] frame_ids the frames, next victim first
+   */
+  virtual void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) = 0;
 };
 
 }  // namespace bustub
@@ -18,11 +18,15 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -34,6 +38,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The kinds of index that the catalog can build. */
+enum class IndexType { EXTENDIBLE_HASH, B_PLUS_TREE };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -96,6 +103,10 @@ struct IndexInfo {
  * The Catalog is a non-persistent catalog that is designed for
  * use by executors within the DBMS execution engine. It handles
  * table creation, table lookup, index creation, and index lookup.
+ *
+ * The only thing it persists is a header page that records the root of the
+ * free space map of each table under the table name, from which OpenTable
+ * opens the table again without walking its pages.
  */
 class Catalog {
  public:
@@ -112,36 +123,81 @@ class Catalog {
    * @param log_manager The log manager in use by the system
    */
   Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager)
-      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
+      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {
+    auto *header_page = static_cast<HeaderPage *>(bpm_->NewPage(&header_page_id_));
+    if (header_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the header page of the catalog");
+    }
+    header_page->Init();
+    bpm_->UnpinPage(header_page_id_, true);
+  }
+
+  /**
+   * Construct a Catalog over the tables of an earlier one, which OpenTable opens.
+   * @param bpm The buffer pool manager backing the tables
+   * @param lock_manager The lock manager in use by the system
+   * @param log_manager The log manager in use by the system
+   * @param header_page_id The header page of the earlier catalog, see GetHeaderPageId
+   */
+  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager, page_id_t header_page_id)
+      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager}, header_page_id_{header_page_id} {}
+
+  /** @return the header page that records the tables of this catalog */
+  page_id_t GetHeaderPageId() const { return header_page_id_; }
 
   /**
    * Create a new table and return its metadata.
    * @param txn The transaction in which the table is being created
-   * @param table_name The name of the new table
+   * @param table_name The name of the new table, shorter than MAX_TABLE_NAME_SIZE
    * @param schema The schema of the new table
    * @return A (non-owning) pointer to the metadata for the table
    */
   TableInfo *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
-    if (table_names_.count(table_name) != 0) {
+    if (table_name.size() >= MAX_TABLE_NAME_SIZE || table_names_.count(table_name) != 0) {
       return NULL_TABLE_INFO;
     }
 
     // Construct the table heap
     auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
 
-    // Fetch the table OID for the new table
-    const auto table_oid = next_table_oid_.fetch_add(1);
+    // Record where its free space map lives
+    auto *header_page = FetchHeaderPage();
+    header_page->WLatch();
+    bool recorded = header_page->InsertRecord(table_name, table->GetFreeSpaceMap()->GetRootPageId());
+    header_page->WUnlatch();
+    bpm_->UnpinPage(header_page_id_, recorded);
+    if (!recorded) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "no room for the table in the header page of the catalog");
+    }
 
-    // Construct the table information
-    auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
-    auto *tmp = meta.get();
+    return AddTable(table_name, schema, std::move(table));
+  }
 
-    // Update the internal tracking mechanisms
-    tables_.emplace(table_oid, std::move(meta));
-    table_names_.emplace(table_name, table_oid);
-    index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{});
+  /**
+   * Open a table that a catalog with the same header page created, reading its free space map from disk.
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @return A (non-owning) pointer to the metadata for the table, or NULL_TABLE_INFO if the header page does not
+   * record the table or it is open already
+   */
+  TableInfo *OpenTable(const std::string &table_name, const Schema &schema) {
+    if (table_name.size() >= MAX_TABLE_NAME_SIZE || table_names_.count(table_name) != 0) {
+      return NULL_TABLE_INFO;
+    }
 
-    return tmp;
+    auto *header_page = FetchHeaderPage();
+    header_page->RLatch();
+    page_id_t fsm_page_id;
+    bool found = header_page->GetRootId(table_name, &fsm_page_id);
+    header_page->RUnlatch();
+    bpm_->UnpinPage(header_page_id_, false);
+    if (!found) {
+      return NULL_TABLE_INFO;
+    }
+
+    // The free space map knows the pages of the table, the first one included.
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, INVALID_PAGE_ID, fsm_page_id);
+    return AddTable(table_name, schema, std::move(table));
   }
 
   /**
@@ -185,13 +241,15 @@ class Catalog {
    * @param key_schema The schema of the key
    * @param key_attrs Key attributes
    * @param keysize Size of the key
-   * @param hash_function The hash function for the index
+   * @param hash_function The hash function for the index, unused by B+ tree indexes
+   * @param index_type The kind of index to build; B+ tree indexes take generic keys and comparators
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         std::size_t keysize, HashFunction<KeyType> hash_function) {
+                         std::size_t keysize, HashFunction<KeyType> hash_function,
+                         IndexType index_type = IndexType::EXTENDIBLE_HASH) {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -211,17 +269,58 @@ class Catalog {
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-    auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
-                                                                                               hash_function);
+    std::unique_ptr<Index> index;
+    BPlusTreeIndex<KeyType, ValueType, KeyComparator> *tree_index = nullptr;
+    page_id_t header_page_id = INVALID_PAGE_ID;
+    if (index_type == IndexType::B_PLUS_TREE) {
+      // Each tree records its root page id in a header page of its own, so that index and table names never clash.
+      auto *header_page = static_cast<HeaderPage *>(bpm_->NewPage(&header_page_id));
+      if (header_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the header page of the index");
+      }
+      header_page->Init();
+      bpm_->UnpinPage(header_page_id, true);
+      // Tables may hold the same key many times.
+      auto tree = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_, false,
+                                                                                       header_page_id);
+      tree_index = tree.get();
+      index = std::move(tree);
+    } else {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                            hash_function);
+    }
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    BufferAccessStrategy strategy;
+    auto tuple = heap->Begin(txn, heap->ScanNeedsBufferRing() ? &strategy : nullptr);
+    if (tree_index != nullptr) {
+      // A tree is built bottom-up from the sorted entries, instead of taking them one insert at a time. A load that
+      // fails deletes the pages of the tree, and the header page goes with them.
+      bool loaded;
+      try {
+        loaded = tree_index->BulkLoad([&](Tuple *key, RID *rid) {
+          if (tuple == heap->End()) {
+            return false;
+          }
+          *key = tuple->KeyFromTuple(schema, key_schema, key_attrs);
+          *rid = tuple->GetRid();
+          ++tuple;
+          return true;
+        });
+      } catch (...) {
+        bpm_->DeletePage(header_page_id);
+        throw;
+      }
+      if (!loaded) {
+        bpm_->DeletePage(header_page_id);
+        throw Exception(ExceptionType::INVALID, "cannot bulk load the index");
+      }
+    } else {
+      for (; tuple != heap->End(); ++tuple) {
+        index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      }
     }
 
     // Get the next OID for the new index
@@ -323,9 +422,39 @@ class Catalog {
   }
 
  private:
+  /** Table names are stored in header page records of 32 bytes, the terminating '\0' included. */
+  static constexpr size_t MAX_TABLE_NAME_SIZE = 32;
+
+  HeaderPage *FetchHeaderPage() {
+    auto *header_page = static_cast<HeaderPage *>(bpm_->FetchPage(header_page_id_));
+    if (header_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the header page of the catalog");
+    }
+    return header_page;
+  }
+
+  /** Track a new table heap under a new table OID. */
+  TableInfo *AddTable(const std::string &table_name, const Schema &schema, std::unique_ptr<TableHeap> &&table) {
+    // Fetch the table OID for the new table
+    const auto table_oid = next_table_oid_.fetch_add(1);
+
+    // Construct the table information
+    auto meta = std::make_unique<TableInfo>(schema, table_name, std::move(table), table_oid);
+    auto *tmp = meta.get();
+
+    // Update the internal tracking mechanisms
+    tables_.emplace(table_oid, std::move(meta));
+    table_names_.emplace(table_name, table_oid);
+    index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{});
+
+    return tmp;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
+  /** The page that records the root of the free space map of each table */
+  page_id_t header_page_id_{INVALID_PAGE_ID};
 
   /**
    * Map table identifier -> table metadata.
@@ -27,6 +27,9 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The page cleaner runs every PAGE_CLEANER_INTERVAL milliseconds, or sooner when an eviction had to write a page. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +38,22 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int DISK_IO_ALIGNMENT = 512;                                 // buffer alignment needed by O_DIRECT
+static constexpr int DISK_IO_QUEUE_DEPTH = 64;                                // io_uring submission queue depth
+static constexpr int DISK_IO_THREADS = 4;                                     // workers of the pread/pwrite backend
+static constexpr int PAGE_CLEANER_TARGET_PERCENT = 10;                        // share of eviction candidates kept clean
+static constexpr int READ_AHEAD_PAGES = 16;                                   // pages a table scan reads ahead
+static constexpr int BUFFER_RING_SIZE = 32;                                   // frames recycled by a bulk operation
+static constexpr int LRUK_REPLACER_K = 2;                                     // references tracked by LRU-K
+static constexpr int LRUK_CORRELATED_PERIOD = 4;                              // clock ticks that count as one reference
+static constexpr int LRUK_CLOCK_TICK = 8;                                     // accesses to a frame per LRU-K tick
+static constexpr int SCAN_MORSEL_PAGES = 16;                                  // pages a parallel scan worker claims
+static constexpr int EXCHANGE_QUEUE_SIZE = 8;                                 // batches queued between threads
+static constexpr int AGGREGATION_LOCAL_GROUPS = 1024;                         // groups a worker holds before it spills
+static constexpr int AGGREGATION_PARTITIONS = 64;                             // partitions of a parallel aggregation
+static constexpr int HASH_JOIN_MEMORY_BUDGET = 64 << 20;                      // bytes of build rows a hash join holds
+static constexpr int HASH_JOIN_PARTITION_BITS = 4;                            // hash bits a hash join partitions by
+static constexpr int HASH_JOIN_RADIX_CHUNK_BYTES = 64 << 10;                  // bytes of build rows in a radix chunk
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
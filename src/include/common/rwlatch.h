@@ -68,6 +68,19 @@ class ReaderWriterLatch {
     reader_count_++;
   }
 
+  /**
+   * Try to acquire a read latch without waiting.
+   * @return true if the read latch was acquired
+   */
+  bool TryRLock() {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ == MAX_READERS) {
+      return false;
+    }
+    reader_count_++;
+    return true;
+  }
+
   /**
    * Release a read latch.
    */
@@ -93,4 +106,32 @@ class ReaderWriterLatch {
   bool writer_entered_{false};
 };
 
+/**
+ * Holds a read latch for as long as it lives, so that the latch is released when an exception leaves the scope.
+ */
+class ReadLatchGuard {
+ public:
+  explicit ReadLatchGuard(ReaderWriterLatch *latch) : latch_(latch) { latch_->RLock(); }
+  ~ReadLatchGuard() { latch_->RUnlock(); }
+
+  DISALLOW_COPY_AND_MOVE(ReadLatchGuard);
+
+ private:
+  ReaderWriterLatch *latch_;
+};
+
+/**
+ * Holds a write latch for as long as it lives, so that the latch is released when an exception leaves the scope.
+ */
+class WriteLatchGuard {
+ public:
+  explicit WriteLatchGuard(ReaderWriterLatch *latch) : latch_(latch) { latch_->WLock(); }
+  ~WriteLatchGuard() { latch_->WUnlock(); }
+
+  DISALLOW_COPY_AND_MOVE(WriteLatchGuard);
+
+ private:
+  ReaderWriterLatch *latch_;
+};
+
 }  // namespace bustub
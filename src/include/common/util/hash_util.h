@@ -13,10 +13,18 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#define BUSTUB_HASH_CRC32
+#endif
+
 #include "common/macros.h"
 #include "type/value.h"
 
@@ -24,37 +32,159 @@ namespace bustub {
 
 using hash_t = std::size_t;
 
+/**
+ * HashUtil holds the hash functions of the system: HashWord for values of up to 8 bytes, such as integers, and
+ * HashBytes for anything wider, such as strings and generic keys. HashValue picks one of them by the type of the
+ * value, and HashFunction (see container/hash/hash_function.h) by the size of the key type, both at compile time.
+ *
+ * HashWord is CRC32C: the CRC32C instruction on CPUs with SSE4.2, and a table-driven CRC32C on the others. Hash
+ * indexes persist where their keys went, so every CPU must compute the same hash of a key. The instruction is compiled
+ * for its own target and picked at runtime.
+ * HashBytes follows wyhash: it reads 16 bytes per round and mixes them with one 64 x 64 -> 128 bit multiply.
+ */
 class HashUtil {
  private:
   static const hash_t PRIME_FACTOR = 10000019;
 
+  // The secret of wyhash
+  static constexpr uint64_t WY_P0 = 0xa0761d6478bd642fULL;
+  static constexpr uint64_t WY_P1 = 0xe7037ed1a0b428dbULL;
+  static constexpr uint64_t WY_P2 = 0x8ebc6af09c88c6e3ULL;
+  static constexpr uint64_t WY_P3 = 0x589965cc75374cc3ULL;
+
+  /** @return the xor of the high and low halves of the 128-bit product */
+  static inline uint64_t Mum(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  }
+
+  static inline uint64_t Read64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline uint64_t Read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  /** @return the CRC32C of the 8 bytes of a little-endian word, without the inversions, like _mm_crc32_u64 */
+  static inline uint64_t Crc32cWord(uint64_t crc, uint64_t word) {
+    static const std::array<uint32_t, 256> table = [] {
+      std::array<uint32_t, 256> entries{};
+      for (uint32_t byte = 0; byte < 256; byte++) {
+        uint32_t entry = byte;
+        for (int bit = 0; bit < 8; bit++) {
+          entry = (entry >> 1) ^ ((entry & 1) * 0x82f63b78U);
+        }
+        entries[byte] = entry;
+      }
+      return entries;
+    }();
+    auto value = static_cast<uint32_t>(crc);
+    for (int i = 0; i < 8; i++) {
+      value = table[(value ^ (word >> (8 * i))) & 0xff] ^ (value >> 8);
+    }
+    return value;
+  }
+
  public:
-  static inline hash_t HashBytes(const char *bytes, size_t length) {
-    // https://github.com/greenplum-db/gpos/blob/b53c1acd6285de94044ff91fbee91589543feba1/libgpos/src/utils.cpp#L126
-    hash_t hash = length;
-    for (size_t i = 0; i < length; ++i) {
-      hash = ((hash << 5) ^ (hash >> 27)) ^ bytes[i];
+  /** @return the hash of a value of up to 8 bytes, zero extended to a word */
+  static inline hash_t HashWord(uint64_t word) {
+#if defined(BUSTUB_HASH_CRC32)
+    if (HasCrc32()) {
+      return HashWordCrc32(word);
     }
-    return hash;
+#endif
+    return HashWordTable(word);
   }
 
-  static inline hash_t CombineHashes(hash_t l, hash_t r) {
-    hash_t both[2] = {};
-    both[0] = l;
-    both[1] = r;
-    return HashBytes(reinterpret_cast<char *>(both), sizeof(hash_t) * 2);
+  /** @return HashWord without the CRC32C instruction */
+  static inline hash_t HashWordTable(uint64_t word) {
+    // CRC32C is 32 bits wide, the high half of the hash is the CRC of the word with its halves swapped.
+    uint64_t low = Crc32cWord(0, word);
+    uint64_t high = Crc32cWord(0xffffffffULL, (word >> 32) | (word << 32));
+    return (high << 32) | low;
   }
 
+#if defined(BUSTUB_HASH_CRC32)
+  /** @return whether the CPU runs HashWordCrc32 */
+  static inline bool HasCrc32() {
+    static const bool has_crc32 = __builtin_cpu_supports("sse4.2");
+    return has_crc32;
+  }
+
+  /** @return HashWord with the CRC32C instruction, only call it when HasCrc32() is true */
+  __attribute__((target("sse4.2"))) static inline hash_t HashWordCrc32(uint64_t word) {
+    uint64_t low = _mm_crc32_u64(0, word);
+    uint64_t high = _mm_crc32_u64(0xffffffffULL, (word >> 32) | (word << 32));
+    return (high << 32) | low;
+  }
+#endif
+
+  static inline hash_t HashBytes(const char *bytes, size_t length) {
+    // https://github.com/wangyi-fudan/wyhash
+    const auto *p = reinterpret_cast<const uint8_t *>(bytes);
+    uint64_t seed = Mum(WY_P0, WY_P1);
+    uint64_t a;
+    uint64_t b;
+    if (length <= 16) {
+      if (length >= 4) {
+        size_t mid = (length >> 3) << 2;
+        a = (Read32(p) << 32) | Read32(p + mid);
+        b = (Read32(p + length - 4) << 32) | Read32(p + length - 4 - mid);
+      } else if (length > 0) {
+        a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+        b = 0;
+      } else {
+        a = b = 0;
+      }
+    } else {
+      size_t i = length;
+      if (i > 48) {
+        uint64_t seed1 = seed;
+        uint64_t seed2 = seed;
+        do {
+          seed = Mum(Read64(p) ^ WY_P1, Read64(p + 8) ^ seed);
+          seed1 = Mum(Read64(p + 16) ^ WY_P2, Read64(p + 24) ^ seed1);
+          seed2 = Mum(Read64(p + 32) ^ WY_P3, Read64(p + 40) ^ seed2);
+          p += 48;
+          i -= 48;
+        } while (i > 48);
+        seed ^= seed1 ^ seed2;
+      }
+      while (i > 16) {
+        seed = Mum(Read64(p) ^ WY_P1, Read64(p + 8) ^ seed);
+        p += 16;
+        i -= 16;
+      }
+      a = Read64(p + i - 16);
+      b = Read64(p + i - 8);
+    }
+    __uint128_t product = static_cast<__uint128_t>(a ^ WY_P1) * (b ^ seed);
+    return Mum(static_cast<uint64_t>(product) ^ WY_P0 ^ length, static_cast<uint64_t>(product >> 64) ^ WY_P1);
+  }
+
+  static inline hash_t CombineHashes(hash_t l, hash_t r) { return Mum(l ^ WY_P0, r ^ WY_P1); }
+
   static inline hash_t SumHashes(hash_t l, hash_t r) { return (l % PRIME_FACTOR + r % PRIME_FACTOR) % PRIME_FACTOR; }
 
   template <typename T>
   static inline hash_t Hash(const T *ptr) {
-    return HashBytes(reinterpret_cast<const char *>(ptr), sizeof(T));
+    if constexpr (sizeof(T) <= sizeof(uint64_t)) {
+      uint64_t word = 0;
+      memcpy(&word, ptr, sizeof(T));
+      return HashWord(word);
+    } else {
+      return HashBytes(reinterpret_cast<const char *>(ptr), sizeof(T));
+    }
   }
 
   template <typename T>
   static inline hash_t HashPtr(const T *ptr) {
-    return HashBytes(reinterpret_cast<const char *>(&ptr), sizeof(void *));
+    return HashWord(reinterpret_cast<uintptr_t>(ptr));
   }
 
   /** @return the hash of the value */
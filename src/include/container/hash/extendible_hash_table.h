@@ -21,6 +21,7 @@
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_directory_root_page.h"
 
 namespace bustub {
 
@@ -30,6 +31,16 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * Lookups, inserts and removes hold the table latch in shared mode and latch
+ * only the bucket page of the key, so that they run in parallel on different
+ * buckets. Splits and merges change the directory, and hold the table latch
+ * exclusively.
+ *
+ * The directory spans a root page and up to DIRECTORY_ROOT_ARRAY_SIZE
+ * directory pages (see HashTableDirectoryRootPage). The table caches the global
+ * depth and the directory page ids of the root, so that a lookup fetches one
+ * directory page and one bucket page however large the directory is.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
@@ -75,18 +86,18 @@ class ExtendibleHashTable {
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result);
 
   /**
-   * Returns the global depth.  Do not touch.
+   * Returns the global depth.
    */
   uint32_t GetGlobalDepth();
 
   /**
-   * Helper function to verify the integrity of the extendible hash table's directory.  Do not touch.
+   * Helper function to verify the integrity of the extendible hash table's directory, across its directory pages.
    */
   void VerifyIntegrity();
 
  private:
   /**
-   * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
+   * Hash - simple helper to downcast the 64-bit hash of the key to 32-bit
    * for extendible hashing.
    *
    * @param key the key to hash
@@ -107,26 +118,66 @@ class ExtendibleHashTable {
    * representation.
    *
    * @param key the key to use for lookup
-   * @param dir_page to use for lookup of global depth
    * @return the directory index
    */
-  inline uint32_t KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page);
+  inline uint32_t KeyToDirectoryIndex(KeyType key);
 
   /**
-   * Get the bucket page_id corresponding to a key.
+   * Get the bucket page_id corresponding to a key, from the directory page that
+   * holds the directory index of the key.
    *
    * @param key the key for lookup
-   * @param dir_page a pointer to the hash table's directory page
    * @return the bucket page_id corresponding to the input key
    */
-  inline uint32_t KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page);
+  inline uint32_t KeyToPageId(KeyType key);
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Fetches a page of the hash table from the buffer pool manager.
    *
+   * @param page_id the page_id to fetch
+   * @return the pinned page
+   */
+  Page *FetchPage(page_id_t page_id);
+
+  /**
+   * Fetches the directory page that holds a directory index from the buffer
+   * pool manager. Unpin it with DirectoryPageId(directory_idx).
+   *
+   * @param directory_idx the directory index
    * @return a pointer to the directory page
    */
-  HashTableDirectoryPage *FetchDirectoryPage();
+  HashTableDirectoryPage *FetchDirectoryPage(uint32_t directory_idx);
+
+  /**
+   * @param directory_idx the directory index
+   * @return the page_id of the directory page that holds the directory index
+   */
+  page_id_t DirectoryPageId(uint32_t directory_idx) const {
+    return directory_page_ids_[directory_idx / DIRECTORY_ARRAY_SIZE];
+  }
+
+  /**
+   * Calls f(dir_page, slot, directory_idx) for each directory index whose low local_depth bits are those of
+   * directory_idx, that is for each index that points to the bucket of directory_idx if it has that local depth.
+   * The directory pages are fetched once each, and unpinned dirty.
+   */
+  template <typename F>
+  void ForEachDirectoryIndex(uint32_t directory_idx, uint32_t local_depth, F &&f);
+
+  /**
+   * Doubles the directory, which takes twice as many directory pages once it no longer fits in one.
+   * @return false if the buffer pool cannot allocate the new directory pages
+   */
+  bool IncrGlobalDepth();
+
+  /** Halves the directory, deleting the directory pages it no longer needs. */
+  void DecrGlobalDepth();
+
+  /** @return true if all local depths are less than the global depth */
+  bool CanShrink();
+
+  /** Writes the cached global depth and directory page ids to the root page. */
+  void UpdateRootPage();
 
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
@@ -162,11 +213,14 @@ class ExtendibleHashTable {
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
   // member variables
-  page_id_t directory_page_id_;
+  page_id_t root_page_id_;
+  // The global depth and the directory page ids of the root page, guarded by the table latch
+  uint32_t global_depth_{0};
+  std::vector<page_id_t> directory_page_ids_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Readers includes lookups, inserts and removes, which latch their bucket page; writers are splits and merges
   ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
@@ -14,10 +14,20 @@
 
 #include <cstdint>
 
-#include "murmur3/MurmurHash3.h"
+#include "common/util/hash_util.h"
 
 namespace bustub {
 
+/**
+ * KeyHash hashes the bytes of a key, with the hash of HashUtil that fits its size: keys of up to 8 bytes, such as
+ * integers and the generic keys of one integer column, are hashed as one word, and wider keys with HashBytes.
+ * Specialize it to hash a key type differently.
+ */
+template <typename KeyType>
+struct KeyHash {
+  static uint64_t Hash(const KeyType &key) { return HashUtil::Hash<KeyType>(&key); }
+};
+
 template <typename KeyType>
 class HashFunction {
  public:
@@ -25,12 +35,7 @@ class HashFunction {
    * @param key the key to be hashed
    * @return the hashed value
    */
-  virtual uint64_t GetHash(KeyType key) {
-    uint64_t hash[2];
-    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
-                                 reinterpret_cast<void *>(&hash));
-    return hash[0];
-  }
+  virtual uint64_t GetHash(KeyType key) { return KeyHash<KeyType>::Hash(key); }
 };
 
 }  // namespace bustub
@@ -32,6 +32,16 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The high 32 bits of the hash of a key pick its block page, and the block
+ * probes its slots from the group that the low bits pick, a group of slots
+ * at a time (see HashTableBlockPage). A key never leaves its block, so that
+ * lookups, inserts and removes hold the table latch in shared mode and latch
+ * a single block page.
+ *
+ * A full block is rehashed in place when at least half of its occupied slots
+ * are tombstones. Otherwise the table doubles its blocks, holding the table
+ * latch exclusively.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -87,12 +97,69 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  /** @return the 64-bit hash of the key */
+  uint64_t Hash(const KeyType &key) { return hash_fn_.GetHash(key); }
+
+  /** @return the page_id of the block that holds the keys with the hash */
+  page_id_t HashToPageId(uint64_t hash) const { return block_page_ids_[(hash >> 32) % block_page_ids_.size()]; }
+
+  /**
+   * Fetches a page of the hash table from the buffer pool manager.
+   *
+   * @param page_id the page_id to fetch
+   * @return the pinned page
+   */
+  Page *FetchPage(page_id_t page_id);
+
+  /**
+   * Inserts a key and value into a block, making room first if it is full. Rehashes the block in place if enough of
+   * its slots are tombstones.
+   *
+   * @param[out] full whether the block is full of readable pairs, and the table has to grow first
+   * @param[out] dirty whether the block changed, by the insert or by the rehash
+   * @return true if inserted, false if duplicate KV pair or the block is full
+   */
+  bool InsertIntoBlock(HASH_TABLE_BLOCK_TYPE *block, const KeyType &key, const ValueType &value, bool *full,
+                       bool *dirty);
+
+  /**
+   * Performs insertion while growing the table, holding the table latch exclusively.
+   *
+   * @return whether or not the insertion was successful
+   */
+  bool GrowInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
+
+  /**
+   * Moves the pairs of the table into num_blocks new blocks, or twice as many if one of them would be full, and
+   * deletes the old blocks. The table latch must be held exclusively.
+   *
+   * @return false if the table already has as many blocks as it can hold
+   */
+  bool Grow(size_t num_blocks);
+
+  /**
+   * Moves the readable pairs of the current blocks into the blocks of new_block_page_ids.
+   * @return false if one of the new blocks would be full
+   */
+  bool MoveBlocks(const std::vector<page_id_t> &new_block_page_ids);
+
+  /** Allocates num_blocks empty block pages, throwing OUT_OF_MEMORY if the buffer pool has no room. */
+  std::vector<page_id_t> NewBlocks(size_t num_blocks);
+
+  /** Deletes block pages. */
+  void DeleteBlocks(const std::vector<page_id_t> &block_page_ids);
+
+  /** Writes the size and the block page ids to the header page. */
+  void UpdateHeaderPage();
+
   // member variable
   page_id_t header_page_id_;
+  // The block page ids of the header page, guarded by the table latch
+  std::vector<page_id_t> block_page_ids_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes lookups, inserts and removes, which latch their block page; writer is only resize
   ReaderWriterLatch table_latch_;
 
   // Hash function
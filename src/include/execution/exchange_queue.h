@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_queue.h
+//
+// Identification: src/include/execution/exchange_queue.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "common/config.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * An ExchangeQueue passes batches from the producer threads of a parallel pipeline to the threads that consume its
+ * output. The queue is bounded, so producers that run ahead of the consumers wait instead of buffering the whole
+ * output.
+ *
+ * The batches go through a ring of slots that producers and consumers claim with a compare-and-swap on their end of
+ * the ring, as in Vyukov's bounded MPMC queue, so a push or a pop takes no lock. A thread only takes the latch to
+ * sleep, when the ring is full or empty, and the other side only takes it to wake a thread that sleeps.
+ *
+ * Consumers see the end of the output once every producer is done. A producer that fails hands its exception to the
+ * consumers, which rethrow it. Closing the queue turns the producers away, and ends the output for the consumers.
+ */
+class ExchangeQueue {
+ public:
+  /**
+   * @param num_producers the number of producers that will call ProducerDone
+   * @param capacity the number of batches the queue holds
+   */
+  explicit ExchangeQueue(uint32_t num_producers, size_t capacity = EXCHANGE_QUEUE_SIZE)
+      : capacity_(capacity), slots_(new Slot[capacity]), num_producers_(num_producers) {
+    for (size_t i = 0; i < capacity_; i++) {
+      slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Adds a batch, waiting while the queue is full.
+   * @return false if the queue was closed, in which case the producer should stop
+   */
+  bool Push(TupleBatch &&batch) {
+    while (!closed_.load()) {
+      if (TryPush(&batch)) {
+        Notify(&num_waiting_consumers_, &not_empty_);
+        return true;
+      }
+      Wait(&num_waiting_producers_, &not_full_, [&] { return closed_.load() || CanPush(); });
+    }
+    return false;
+  }
+
+  /**
+   * Records that a producer has no more batches.
+   * @param error the exception that stopped the producer, nullptr if it finished
+   */
+  void ProducerDone(std::exception_ptr error = nullptr) {
+    std::scoped_lock lock(latch_);
+    if (error != nullptr && error_ == nullptr) {
+      error_ = error;
+      failed_.store(true);
+    }
+    num_producers_.fetch_sub(1);
+    not_empty_.notify_all();
+  }
+
+  /**
+   * Takes the next batch, waiting while the queue is empty and producers are still running.
+   * @param[out] batch the next batch
+   * @return false once every producer is done and the queue is empty, or once the queue is closed
+   */
+  bool Pop(TupleBatch *batch) {
+    while (true) {
+      if (failed_.load()) {
+        std::scoped_lock lock(latch_);
+        std::rethrow_exception(error_);
+      }
+      if (closed_.load()) {
+        return false;
+      }
+      if (TryPop(batch)) {
+        Notify(&num_waiting_producers_, &not_full_);
+        return true;
+      }
+      if (num_producers_.load() == 0) {
+        // A producer may have pushed its last batch just before it was done.
+        return TryPop(batch);
+      }
+      Wait(&num_waiting_consumers_, &not_empty_,
+           [&] { return CanPop() || num_producers_.load() == 0 || failed_.load() || closed_.load(); });
+    }
+  }
+
+  /** Turns the producers away and ends the output, once the consumers need no more batches. */
+  void Close() {
+    std::scoped_lock lock(latch_);
+    closed_.store(true);
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+ private:
+  /** A slot of the ring. Its sequence number tells the producers and consumers whose turn it is to use it. */
+  struct Slot {
+    std::atomic<size_t> sequence_;
+    TupleBatch batch_;
+  };
+
+  /** Moves the batch into the tail of the ring, unless the ring is full. */
+  bool TryPush(TupleBatch *batch) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[pos % capacity_];
+      auto diff = static_cast<int64_t>(slot.sequence_.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          slot.batch_ = std::move(*batch);
+          slot.sequence_.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /** Moves the batch at the head of the ring out, unless the ring is empty. */
+  bool TryPop(TupleBatch *batch) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[pos % capacity_];
+      auto diff = static_cast<int64_t>(slot.sequence_.load(std::memory_order_acquire) - (pos + 1));
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          *batch = std::move(slot.batch_);
+          slot.sequence_.store(pos + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool CanPush() const {
+    size_t pos = tail_.load();
+    return slots_[pos % capacity_].sequence_.load() == pos;
+  }
+
+  bool CanPop() const {
+    size_t pos = head_.load();
+    return slots_[pos % capacity_].sequence_.load() == pos + 1;
+  }
+
+  /*
+   * A sleeper counts itself among the waiting threads before it checks whether it can go on, and a waker checks for
+   * sleepers after it changed the ring, with a full fence on both sides. So either the sleeper sees the change, or the
+   * waker sees the sleeper and wakes it under the latch.
+   */
+  template <typename Predicate>
+  void Wait(std::atomic<uint32_t> *num_waiting, std::condition_variable *cv, Predicate &&ready) {
+    std::unique_lock lock(latch_);
+    num_waiting->fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv->wait(lock, ready);
+    num_waiting->fetch_sub(1);
+  }
+
+  void Notify(std::atomic<uint32_t> *num_waiting, std::condition_variable *cv) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_waiting->load() > 0) {
+      std::scoped_lock lock(latch_);
+      cv->notify_all();
+    }
+  }
+
+  /** The number of batches the queue holds */
+  const size_t capacity_;
+  /** The ring of batches */
+  std::unique_ptr<Slot[]> slots_;
+  /** The position of the next push, on its own cache line */
+  alignas(64) std::atomic<size_t> tail_{0};
+  /** The position of the next pop, on its own cache line */
+  alignas(64) std::atomic<size_t> head_{0};
+  /** The number of producers that are not done */
+  std::atomic<uint32_t> num_producers_;
+  /** Whether the queue was closed */
+  std::atomic<bool> closed_{false};
+  /** Whether a producer failed, with error_ */
+  std::atomic<bool> failed_{false};
+  /** The first exception of a producer, guarded by latch_ */
+  std::exception_ptr error_;
+  /** The number of producers that sleep until the ring is not full */
+  std::atomic<uint32_t> num_waiting_producers_{0};
+  /** The number of consumers that sleep until the ring is not empty */
+  std::atomic<uint32_t> num_waiting_consumers_{0};
+  std::mutex latch_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+};
+
+}  // namespace bustub
@@ -18,6 +18,7 @@
 
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
+#include "execution/worker_pool.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
@@ -60,6 +61,9 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the workers that run the parallel pipelines of the query */
+  WorkerPool *GetWorkerPool() { return &worker_pool_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +75,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The workers of the parallel pipelines of the query */
+  WorkerPool worker_pool_;
 };
 
 }  // namespace bustub
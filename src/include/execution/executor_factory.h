@@ -13,8 +13,10 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "execution/executors/abstract_executor.h"
+#include "execution/parallel_state.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
@@ -30,5 +32,22 @@ class ExecutorFactory {
    * @return An executor for the given plan in the provided context
    */
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
+
+  /**
+   * Creates copies of the executors of a plan, which run in parallel and share the work of the plan. The copies of a
+   * sequential scan claim the pages of the table from one MorselDispenser, and the copies of an Exchange consume the
+   * partitions of one set of ExchangeProducers. Below a Gather or an Exchange, the copies of its child plan are
+   * created in turn, each with their own shared state. Copies of plans that cannot share the work this way, such as
+   * limits and plans that modify a table, or that lack an Exchange below to partition their input, are refused.
+   * @param exec_ctx The executor context for the created executors
+   * @param plan The plan node that needs to be executed
+   * @param num_copies The number of copies
+   * @param[out] shared_state The state that the copies share, which the operator that runs them resets and cancels
+   * @return The copies of the executor for the given plan
+   * @throws NotImplementedException if several copies of the plan would not produce its output
+   */
+  static std::vector<std::unique_ptr<AbstractExecutor>> CreateExecutors(
+      ExecutorContext *exec_ctx, const AbstractPlanNode *plan, uint32_t num_copies,
+      std::vector<std::shared_ptr<ParallelState>> *shared_state);
 };
 }  // namespace bustub
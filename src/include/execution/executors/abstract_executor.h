@@ -13,6 +13,7 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -20,6 +21,12 @@ namespace bustub {
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
  * engine inherit, and defines the minimal interface that all executors support.
+ *
+ * Executors also produce their tuples a batch at a time with NextBatch. An
+ * executor that does not implement NextBatch fills the batch from Next, and an
+ * executor that does implements Next with NextFromBatch, so that either kind of
+ * executor composes with the other. A parent calls one of Next and NextBatch
+ * on a child, never both.
  */
 class AbstractExecutor {
  public:
@@ -46,6 +53,21 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Yield the next batch of tuples from this executor.
+   * @param[out] batch The next tuples produced by this executor, at most TupleBatch::BATCH_SIZE of them
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  virtual bool NextBatch(TupleBatch *batch) {
+    batch->Reset(GetOutputSchema());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->Append(tuple, rid);
+    }
+    return !batch->IsEmpty();
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
@@ -53,7 +75,33 @@ class AbstractExecutor {
   ExecutorContext *GetExecutorContext() { return exec_ctx_; }
 
  protected:
+  /** Yields the tuples of NextBatch one at a time, for the executors that implement NextBatch. */
+  bool NextFromBatch(Tuple *tuple, RID *rid) {
+    while (next_row_ == pending_.Size()) {
+      next_row_ = 0;
+      if (!NextBatch(&pending_)) {
+        return false;
+      }
+    }
+    *tuple = pending_.GetTuple(next_row_);
+    *rid = pending_.GetRid(next_row_);
+    next_row_++;
+    return true;
+  }
+
+  /** Drops the tuples that NextFromBatch has not yielded yet, when the executor is initialized again. */
+  void ClearPending() {
+    pending_.Clear();
+    next_row_ = 0;
+  }
+
   /** The executor context in which the executor runs */
   ExecutorContext *exec_ctx_;
+
+ private:
+  /** The batch whose tuples NextFromBatch yields */
+  TupleBatch pending_;
+  /** The next row of pending_ */
+  uint32_t next_row_{0};
 };
 }  // namespace bustub
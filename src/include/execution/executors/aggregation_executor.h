@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <utility>
@@ -22,7 +23,9 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/parallel_state.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/spill_file.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
@@ -96,21 +99,99 @@ class SimpleAggregationHashTable {
     }
   }
 
+  /**
+   * Merges a partial aggregate of the same group, computed over other input, into the aggregation result.
+   * @param[out] result The output aggregate value
+   * @param partial The partial aggregate value
+   */
+  void MergeAggregateValues(AggregateValue *result, const AggregateValue &partial) {
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      switch (agg_types_[i]) {
+        case AggregationType::CountAggregate:
+        case AggregationType::SumAggregate:
+          // Counts and sums add up.
+          result->aggregates_[i] = result->aggregates_[i].Add(partial.aggregates_[i]);
+          break;
+        case AggregationType::MinAggregate:
+          result->aggregates_[i] = result->aggregates_[i].Min(partial.aggregates_[i]);
+          break;
+        case AggregationType::MaxAggregate:
+          result->aggregates_[i] = result->aggregates_[i].Max(partial.aggregates_[i]);
+          break;
+      }
+    }
+  }
+
   /**
    * Inserts a value into the hash table and then combines it with the current aggregation.
    * @param agg_key the key to be inserted
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      iter = ht_.emplace(agg_key, GenerateInitialAggregateValue()).first;
+    }
+    CombineAggregateValues(&iter->second, agg_val);
+  }
+
+  /**
+   * Combines a value with the current aggregation of its key, but only inserts a new key while the hash table holds
+   * fewer than max_size keys.
+   * @param agg_key the key to be inserted
+   * @param agg_val the value to be inserted
+   * @param max_size the number of keys the hash table may hold
+   * @return `false` if the key is new and the hash table is full, in which case the value was not combined
+   */
+  bool InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val, size_t max_size) {
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      if (ht_.size() >= max_size) {
+        return false;
+      }
+      iter = ht_.emplace(agg_key, GenerateInitialAggregateValue()).first;
     }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
+    CombineAggregateValues(&iter->second, agg_val);
+    return true;
   }
 
+  /**
+   * Inserts a partial aggregate into the hash table, or merges it into the aggregation of its key.
+   * @param agg_key the key of the partial aggregate
+   * @param partial the partial aggregate value
+   */
+  void InsertMerge(AggregateKey &&agg_key, AggregateValue &&partial) {
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      ht_.emplace(std::move(agg_key), std::move(partial));
+      return;
+    }
+    MergeAggregateValues(&iter->second, partial);
+  }
+
+  /**
+   * Moves every key out of the hash table along with its aggregate, which leaves the table empty but keeps its buckets.
+   * @param consume called with each key and its aggregate
+   */
+  template <typename Consumer>
+  void Drain(Consumer &&consume) {
+    while (!ht_.empty()) {
+      auto node = ht_.extract(ht_.begin());
+      consume(std::move(node.key()), std::move(node.mapped()));
+    }
+  }
+
+  /** Removes all the keys from the hash table. */
+  void Clear() { ht_.clear(); }
+
+  /** @return The number of keys in the hash table */
+  size_t Size() const { return ht_.size(); }
+
   /** An iterator over the aggregation hash table */
   class Iterator {
    public:
+    Iterator() = default;
+
     /** Creates an iterator for the aggregate map. */
     explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
 
@@ -155,6 +236,14 @@ class SimpleAggregationHashTable {
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * The child is read a batch at a time, and the group-by and aggregate expressions
+ * are evaluated on each batch a column at a time.
+ *
+ * An aggregation with several workers aggregates the output of a copy of the child plan
+ * on each worker, in two phases. The groups go into AGGREGATION_PARTITIONS partitions
+ * by the hash of their key, which the workers write to disk, and the aggregation then
+ * merges and emits one partition at a time.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -167,6 +256,17 @@ class AggregationExecutor : public AbstractExecutor {
   AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                       std::unique_ptr<AbstractExecutor> &&child);
 
+  /**
+   * Construct a new AggregationExecutor instance that aggregates on several workers.
+   * @param exec_ctx The executor context
+   * @param plan The aggregation plan to be executed
+   * @param children The copies of the child plan, one for each worker (see ExecutorFactory::CreateExecutors)
+   * @param shared_state The state that the copies share, which the aggregation resets before every run
+   */
+  AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                      std::vector<std::unique_ptr<AbstractExecutor>> &&children,
+                      std::vector<std::shared_ptr<ParallelState>> &&shared_state);
+
   /** Initialize the aggregation */
   void Init() override;
 
@@ -178,6 +278,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation.
+   * @param[out] batch The next tuples produced by the aggregation
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the aggregation */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
@@ -189,7 +296,7 @@ class AggregationExecutor : public AbstractExecutor {
   AggregateKey MakeAggregateKey(const Tuple *tuple) {
     std::vector<Value> keys;
     for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+      keys.emplace_back(expr->Evaluate(tuple, children_.front()->GetOutputSchema()));
     }
     return {keys};
   }
@@ -198,19 +305,55 @@ class AggregationExecutor : public AbstractExecutor {
   AggregateValue MakeAggregateValue(const Tuple *tuple) {
     std::vector<Value> vals;
     for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+      vals.emplace_back(expr->Evaluate(tuple, children_.front()->GetOutputSchema()));
     }
     return {vals};
   }
 
  private:
+  /**
+   * Evaluates the group-by and aggregate expressions on the output of a child, and hands them over row by row.
+   * @param child the child to read in full, which is already initialized
+   * @param consume called with the key and the value of each row
+   */
+  template <typename Consumer>
+  void ForEachRow(AbstractExecutor *child, Consumer &&consume);
+
+  /** Aggregates the output of the copies of the child on the workers, in two phases. */
+  void AggregateInParallel();
+
+  /** Runs a task for every worker on the worker pool, waits for them all, and rethrows the first error. */
+  void RunOnWorkers(const std::function<void(uint32_t)> &task);
+
+  /** Pre-aggregates the output of the copy of a worker, spilling the groups into the runs of the worker. */
+  void PreAggregate(uint32_t worker);
+
+  /** Merges the runs of every worker for a partition into the hash table, and deletes them. */
+  void MergePartition(size_t partition);
+
+  /** @return The schema of the partial aggregates in the runs: the group-bys, then the aggregates */
+  std::unique_ptr<Schema> MakeRunSchema() const;
+
+  /** @return The partition of the groups of the key */
+  static size_t PartitionOf(const AggregateKey &key) {
+    return std::hash<AggregateKey>{}(key) % AGGREGATION_PARTITIONS;
+  }
+
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
-  /** The child executor that produces tuples over which the aggregation is computed */
-  std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  // TODO(Student): Uncomment SimpleAggregationHashTable aht_;
+  /** The child executor that produces tuples over which the aggregation is computed, one copy for each worker */
+  std::vector<std::unique_ptr<AbstractExecutor>> children_;
+  /** The state that the copies share */
+  std::vector<std::shared_ptr<ParallelState>> shared_state_;
+  /** Simple aggregation hash table, which holds the groups of a single partition with several workers */
+  SimpleAggregationHashTable aht_;
   /** Simple aggregation hash table iterator */
-  // TODO(Student): Uncomment SimpleAggregationHashTable::Iterator aht_iterator_;
+  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The schema of the partial aggregates in the runs, with several workers */
+  std::unique_ptr<Schema> run_schema_;
+  /** The runs of each worker on disk, one for each partition, until the partition is merged */
+  std::vector<std::vector<std::unique_ptr<SpillFile>>> runs_;
+  /** The next partition to merge into the hash table, once the groups of the hash table are emitted */
+  size_t next_partition_{0};
 };
 }  // namespace bustub
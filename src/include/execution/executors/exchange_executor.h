@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.h
+//
+// Identification: src/include/execution/executors/exchange_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "execution/exchange_queue.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/parallel_state.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/worker_pool.h"
+
+namespace bustub {
+
+/**
+ * ExchangeProducers runs the copies of the child plan of an Exchange on the worker pool of the query, and deals the
+ * batches they produce out to one ExchangeQueue per partition. The copies of the Exchange share it, and each of them
+ * consumes one partition.
+ *
+ * The producers start when a consumer first asks for a batch, which is after the operator above has reset the
+ * Exchange and initialized all of its consumers.
+ */
+class ExchangeProducers : public ParallelState {
+ public:
+  /**
+   * @param plan The exchange plan to be executed
+   * @param worker_pool The workers to run the producers on
+   * @param producers The copies of the child plan (see ExecutorFactory::CreateExecutors)
+   * @param shared_state The state that the producers share, which is reset before every run
+   * @param num_partitions The number of consumers
+   */
+  ExchangeProducers(const ExchangePlanNode *plan, WorkerPool *worker_pool,
+                    std::vector<std::unique_ptr<AbstractExecutor>> &&producers,
+                    std::vector<std::shared_ptr<ParallelState>> &&shared_state, uint32_t num_partitions);
+
+  /** Stops the producers. */
+  ~ExchangeProducers() override { Cancel(); }
+
+  /** Stops the producers, which start over when a consumer next asks for a batch. */
+  void Reset() override;
+
+  /** Stops the producers, and ends the output of every partition. */
+  void Cancel() override;
+
+  /**
+   * Takes the next batch of a partition, starting the producers if they have not started yet.
+   * @param partition The partition of the consumer
+   * @param[out] batch The next tuples of the partition
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(uint32_t partition, TupleBatch *batch);
+
+  /** @return The number of consumers */
+  uint32_t GetNumPartitions() const { return num_partitions_; }
+
+ private:
+  enum class State { Idle, Running, Cancelled };
+
+  /** Initializes a producer and deals its batches out to the partitions, on a worker. */
+  void Produce(AbstractExecutor *producer);
+
+  /** Turns the producers away and waits for them. Caller holds latch_. */
+  void Stop();
+
+  /** The exchange plan node to be executed */
+  const ExchangePlanNode *plan_;
+  /** The workers that run the producers */
+  WorkerPool *worker_pool_;
+  /** The copies of the child plan */
+  std::vector<std::unique_ptr<AbstractExecutor>> producers_;
+  /** The state that the producers share */
+  std::vector<std::shared_ptr<ParallelState>> shared_state_;
+  /** The number of consumers */
+  const uint32_t num_partitions_;
+  /** Whether the producers are running */
+  State state_{State::Idle};
+  /** The batches of each partition */
+  std::vector<std::unique_ptr<ExchangeQueue>> queues_;
+  /** The runs of the producers on the workers */
+  std::vector<std::future<void>> runs_;
+  /** Serializes starting and stopping the producers */
+  std::mutex latch_;
+};
+
+/**
+ * ExchangeExecutor is one copy of an Exchange, and yields the tuples of one partition of the output of its
+ * ExchangeProducers.
+ */
+class ExchangeExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new ExchangeExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The exchange plan to be executed
+   * @param producers The producers shared by the copies of the Exchange
+   * @param partition The partition that this copy consumes
+   */
+  ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan,
+                   std::shared_ptr<ExchangeProducers> producers, uint32_t partition);
+
+  /** Initialize the exchange */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the exchange.
+   * @param[out] tuple The next tuple produced by the exchange
+   * @param[out] rid The next tuple RID produced by the exchange
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  /**
+   * Yield the next batch of tuples from the exchange.
+   * @param[out] batch The next tuples of the partition
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return The output schema for the exchange */
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+ private:
+  /** The exchange plan node to be executed */
+  const ExchangePlanNode *plan_;
+  /** The producers shared by the copies of the Exchange */
+  std::shared_ptr<ExchangeProducers> producers_;
+  /** The partition that this copy consumes */
+  uint32_t partition_;
+};
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_executor.h
+//
+// Identification: src/include/execution/executors/gather_executor.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "execution/exchange_queue.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/parallel_state.h"
+#include "execution/plans/gather_plan.h"
+
+namespace bustub {
+
+/**
+ * GatherExecutor runs the copies of its child plan on the worker pool of the query, and merges the batches they
+ * produce through an ExchangeQueue. Each copy is initialized on its own worker, so that blocking operators such as
+ * aggregations also build in parallel.
+ */
+class GatherExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new GatherExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The gather plan to be executed
+   * @param children The copies of the child plan (see ExecutorFactory::CreateExecutors)
+   * @param shared_state The state that the copies share, which the gather resets before every run
+   */
+  GatherExecutor(ExecutorContext *exec_ctx, const GatherPlanNode *plan,
+                 std::vector<std::unique_ptr<AbstractExecutor>> &&children,
+                 std::vector<std::shared_ptr<ParallelState>> &&shared_state);
+
+  /** Stops the copies. */
+  ~GatherExecutor() override;
+
+  /** Initialize the gather, which starts the copies */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the gather.
+   * @param[out] tuple The next tuple produced by the gather
+   * @param[out] rid The next tuple RID produced by the gather
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  /**
+   * Yield the next batch of tuples from the gather.
+   * @param[out] batch The next tuples produced by one of the copies
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return The output schema for the gather */
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
+
+ private:
+  /** Initializes a copy and pushes its batches into the queue, on a worker. */
+  void Produce(AbstractExecutor *child);
+
+  /** Turns the copies away and waits for them. */
+  void Stop();
+
+  /** The gather plan node to be executed */
+  const GatherPlanNode *plan_;
+  /** The copies of the child plan */
+  std::vector<std::unique_ptr<AbstractExecutor>> children_;
+  /** The state that the copies share */
+  std::vector<std::shared_ptr<ParallelState>> shared_state_;
+  /** The batches of the copies */
+  std::unique_ptr<ExchangeQueue> queue_;
+  /** The runs of the copies on the workers */
+  std::vector<std::future<void>> producers_;
+};
+}  // namespace bustub
@@ -12,18 +12,72 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "common/util/hash_util.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/abstract_expression.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/spill_file.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
+/** HashJoinKey represents the join key of a tuple in a hash join */
+struct HashJoinKey {
+  /** The value of the join key expression */
+  Value key_;
+
+  /**
+   * Compares two join keys for equality.
+   * @param other the other join key to be compared with
+   * @return `true` if both join keys are equal
+   */
+  bool operator==(const HashJoinKey &other) const { return key_.CompareEquals(other.key_) == CmpBool::CmpTrue; }
+};
+
+}  // namespace bustub
+
+namespace std {
+
+/** Implements std::hash on HashJoinKey */
+template <>
+struct hash<bustub::HashJoinKey> {
+  std::size_t operator()(const bustub::HashJoinKey &join_key) const {
+    return bustub::HashUtil::HashValue(&join_key.key_);
+  }
+};
+
+}  // namespace std
+
+namespace bustub {
+
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hash JOIN on two tables.
+ *
+ * The left child is the build side: its tuples are kept by column in one batch, and a hash table maps their join
+ * keys to their rows. The right child is probed a batch at a time, and the output columns are evaluated on the
+ * matching rows of both sides at once.
+ *
+ * The join is a hybrid hash join. Both sides are split into partitions by HASH_JOIN_PARTITION_BITS bits of the hash
+ * of their join key, each partition with its own batch and hash table. While the build side holds more than the
+ * memory budget of the plan, its largest partition in memory spills to a SpillFile, and so do the probe rows of a
+ * partition that spilled. The partitions that stay in memory join as the probe side goes by, as in an in-memory
+ * join. A pair of spilled partitions is joined afterwards, with the same algorithm on the next bits of the hash, so a
+ * partition that still does not fit splits up again. Every row is thus written and read once for every level of
+ * partitioning it goes through.
+ *
+ * In radix-partitioned mode, the rows of each partition in memory are split further into chunks of about
+ * HASH_JOIN_RADIX_CHUNK_BYTES by the next bits of the hash, and ordered by chunk. Each chunk has a compact hash table
+ * of its own, with open addressing in one array of slots that hold the high half of the hash and the row of a key,
+ * so a probe reads a slot or two of a cache line and only compares the keys that match its hash. The probe side is
+ * read RADIX_PROBE_BATCHES batches at a time, which are ordered by chunk in the same way, so that the probes of a
+ * chunk follow each other while the chunk is in the cache.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -48,12 +102,143 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the join.
+   * @param[out] batch The next tuples produced by the join
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the join */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** A partition of the build side and of the probe side that spilled, which only join with each other */
+  struct SpilledPartition {
+    std::unique_ptr<SpillFile> build_;
+    std::unique_ptr<SpillFile> probe_;
+    /** The level of partitioning that split the partition off */
+    uint32_t level_;
+  };
+
+  /** A slot of the hash table of a chunk: the high half of the hash of a join key, and the row of the key */
+  struct RadixSlot {
+    uint32_t hash_;
+    uint32_t row_;
+  };
+
+  /** The hash tables of the chunks of a partition in memory, in radix-partitioned mode */
+  struct RadixPartition {
+    /** The number of hash bits that split the partition into chunks */
+    uint32_t bits_{0};
+    /** The join key of each row of the partition, whose rows are in order of chunk */
+    std::vector<Value> keys_;
+    /** The hash tables of the chunks one after the other, each of a power of two slots */
+    std::vector<RadixSlot> slots_;
+    /** The first slot of each chunk, followed by the number of slots */
+    std::vector<uint32_t> chunk_slots_;
+  };
+
+  /** The number of partitions of each level of partitioning */
+  static constexpr uint32_t NUM_PARTITIONS = 1U << HASH_JOIN_PARTITION_BITS;
+  /** The level of partitioning beyond which a partition joins in memory, as when its rows all have the same key */
+  static constexpr uint32_t MAX_SPILL_LEVEL = 4;
+  /** The most hash bits that split a partition into chunks, which leaves the high half of the hash to the slots */
+  static constexpr uint32_t MAX_RADIX_BITS = 32 - (MAX_SPILL_LEVEL + 1) * HASH_JOIN_PARTITION_BITS;
+  /** The number of batches of the probe side that are ordered by chunk at a time, in radix-partitioned mode */
+  static constexpr uint32_t RADIX_PROBE_BATCHES = 16;
+  /** The row of an empty slot */
+  static constexpr uint32_t EMPTY_ROW = UINT32_MAX;
+
+  /**
+   * Partitions the build side of a pass, spilling partitions beyond the memory budget, and builds the hash tables of
+   * the partitions that stay in memory.
+   * @param next_batch reads the next batch of the build side into its argument, and returns false at the end
+   */
+  template <typename Source>
+  void Build(Source &&next_batch);
+
+  /** Moves the rows of a partition of the build side that is in memory to a new SpillFile. */
+  void SpillPartition(uint32_t partition);
+
+  /** Orders the rows of a partition of the build side by chunk, and builds the hash tables of the chunks. */
+  void BuildRadixPartition(uint32_t partition);
+
+  /**
+   * Reads the next rows of the probe side of the pass into probe_batch_, spills those of the partitions that spilled,
+   * and lists the others in probe_order_. Once a pass is over, its spilled partitions are joined in new passes, one
+   * pair at a time.
+   * @return false once every pass is over
+   */
+  bool NextProbeRows();
+
+  /** Starts the pass of the next pair of spilled partitions, after the spilled partitions of the pass are queued. */
+  bool StartNextPass();
+
+  /** Lists the build rows that match a row of probe_batch_ in build_matches_. */
+  void FindMatches(uint32_t row);
+
+  /** Lists the matches of a row of probe_batch_ in the chunk of its partition in memory in build_matches_. */
+  void ProbeChunk(uint32_t partition, uint32_t row);
+
+  /** @return the partition of the hash of a join key in the current level of partitioning */
+  uint32_t PartitionOf(hash_t hash) const {
+    return (hash >> (level_ * HASH_JOIN_PARTITION_BITS)) & (NUM_PARTITIONS - 1);
+  }
+
+  /** @return the chunk of the hash of a join key in its partition, which the next bits of the hash pick */
+  uint32_t ChunkOf(hash_t hash, uint32_t bits) const {
+    return (hash >> ((level_ + 1) * HASH_JOIN_PARTITION_BITS)) & ((1U << bits) - 1);
+  }
+
+  /** @return the number of bytes of memory that a row of a batch takes */
+  static size_t RowBytes(const TupleBatch &batch, uint32_t row);
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  /** The build side of the join */
+  std::unique_ptr<AbstractExecutor> left_child_;
+  /** The probe side of the join */
+  std::unique_ptr<AbstractExecutor> right_child_;
+  /** The level of partitioning of the current pass, which is 0 for the children and grows with each split */
+  uint32_t level_{0};
+  /** The tuples of the build side in memory, by partition */
+  std::vector<TupleBatch> build_rows_;
+  /** The number of bytes of each partition of build_rows_ */
+  std::vector<size_t> build_bytes_;
+  /** The rows of build_rows_ by join key, by partition */
+  std::vector<std::unordered_multimap<HashJoinKey, uint32_t>> hash_tables_;
+  /** The chunks of each partition in memory, in radix-partitioned mode */
+  std::vector<RadixPartition> radix_partitions_;
+  /** The number of chunks of the partitions before each partition, followed by the number of chunks */
+  std::vector<uint32_t> chunk_bases_;
+  /** The build and probe rows of the partitions of the pass that spilled, nullptr for those in memory */
+  std::vector<std::unique_ptr<SpillFile>> build_spills_;
+  std::vector<std::unique_ptr<SpillFile>> probe_spills_;
+  /** The spilled partitions of finished passes that are still to join */
+  std::vector<SpilledPartition> pending_;
+  /** The probe side of the current pass, nullptr while it is the right child */
+  std::unique_ptr<SpillFile> probe_file_;
+  /** The rows of the probe side being probed */
+  TupleBatch probe_batch_;
+  /** The join key of each row of probe_batch_ */
+  std::vector<Value> probe_keys_;
+  /** The hash of the join key of each row of probe_batch_ */
+  std::vector<hash_t> probe_hashes_;
+  /** The rows of probe_batch_ to probe, in order of chunk in radix-partitioned mode */
+  std::vector<uint32_t> probe_order_;
+  /** The position in probe_order_ of the next row to probe */
+  uint32_t probe_pos_{0};
+  /** The row of probe_batch_ being joined, and its partition */
+  uint32_t match_row_{0};
+  uint32_t match_partition_{0};
+  /** The rows of the partition of the build side that match match_row_ */
+  std::vector<uint32_t> build_matches_;
+  /** The position in build_matches_ of the next match to output */
+  uint32_t match_pos_{0};
+  /** The matching build and probe rows of the next output batch */
+  TupleBatch left_matches_;
+  TupleBatch right_matches_;
 };
 
 }  // namespace bustub
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <functional>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -23,7 +25,10 @@
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table, with a B+ tree index.
+ *
+ * The scan takes the RIDs of the index one leaf at a time, and reads the tuples of a batch sorted by page, so that it
+ * fetches each table page once per batch instead of once per tuple. The tuples still come out in key order.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +47,25 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  /** Start the scan of a B+ tree index with keys of the given size. */
+  template <size_t KeySize>
+  void StartScan(Index *index);
+
+  /**
+   * Read the tuples of the next batch of RIDs of the index.
+   * @return false at the end of the index
+   */
+  bool FetchNextTuples();
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The table of the index */
+  TableInfo *table_info_{nullptr};
+  /** Hands out the RIDs of the range, a leaf at a time. */
+  std::function<bool(std::vector<RID> *)> next_batch_;
+  /** The tuples of the current batch. */
+  std::vector<Tuple> tuples_;
+  /** The next tuple of the current batch. */
+  size_t tuple_index_{0};
 };
 }  // namespace bustub
@@ -12,17 +12,31 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/morsel_dispenser.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The SeqScanExecutor executor executes a sequential table scan.
+ * The SeqScanExecutor executor executes a sequential table scan. The table iterator reads the pages ahead of the scan
+ * into the buffer pool, so a cold scan does not wait for one page read at a time. A scan of a large table reads its
+ * pages into a small buffer ring, so that it does not flush the rest of the buffer pool.
+ *
+ * The scan reads a batch of tuples at a time, evaluates the predicate on the whole batch, and evaluates each output
+ * column on the rows that pass it. A batch only decodes the columns of the table that the predicate and the output
+ * columns read. Next reads a tuple at a time instead, and evaluates the expressions on the tuple of the table itself.
+ *
+ * The copies of a scan that run in parallel below a Gather or an Exchange are morsel-driven: each copy claims a morsel
+ * of pages at a time from the MorselDispenser they share, and reads each page of it with one fetch.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -30,8 +44,10 @@ class SeqScanExecutor : public AbstractExecutor {
    * Construct a new SeqScanExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The sequential scan plan to be executed
+   * @param dispenser The morsels shared by the copies of a parallel scan, nullptr for a serial scan
    */
-  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan,
+                  std::shared_ptr<MorselDispenser> dispenser = nullptr);
 
   /** Initialize the sequential scan */
   void Init() override;
@@ -44,11 +60,57 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan.
+   * @param[out] batch The next tuples produced by the scan
+   * @return `true` if any tuple was produced, `false` if there are no more tuples
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return The output schema for the sequential scan */
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
+  /** Fills table_batch_ with the tuples of the morsels that the scan claims. */
+  void ReadMorsels();
+
+  /**
+   * Moves page_tuples_ on to the next page of the morsels that the scan claims, skipping the pages without tuples.
+   * @return false once there are no more morsels
+   */
+  bool ReadMorselPage();
+
+  /** @return true if the predicate holds for a tuple of the table */
+  bool Matches(const Tuple &table_tuple) const;
+
+  /** Builds the output tuple of a tuple of the table. */
+  void MakeOutputTuple(const Tuple &table_tuple, Tuple *tuple) const;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  TableInfo *table_info_;
+  /** The buffer ring of the scan */
+  BufferAccessStrategy strategy_;
+  /** The next tuple of the scan */
+  TableIterator table_iter_;
+  /** The columns of the table that the predicate and the output columns read, in increasing order */
+  std::vector<uint32_t> scan_columns_;
+  /** Whether the output columns are the columns of the table, in order, so that a tuple of the table is output as is */
+  bool outputs_table_tuples_;
+  /** The tuples of the table read by the last call to NextBatch, with the columns of scan_columns_ only */
+  TupleBatch table_batch_;
+  /** The predicate value of each row of table_batch_ */
+  std::vector<Value> selection_;
+  /** The morsels shared by the copies of a parallel scan */
+  std::shared_ptr<MorselDispenser> dispenser_;
+  /** The pages of the morsel being scanned */
+  std::vector<page_id_t> morsel_;
+  /** The index in morsel_ of the next page to read */
+  size_t morsel_pos_{0};
+  /** The tuples of the page being scanned */
+  std::vector<Tuple> page_tuples_;
+  /** The index in page_tuples_ of the next tuple */
+  size_t tuple_pos_{0};
 };
 }  // namespace bustub
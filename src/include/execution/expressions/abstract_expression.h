@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -58,6 +59,36 @@ class AbstractExpression {
    */
   virtual Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const = 0;
 
+  /**
+   * Evaluates the expression on every row of a batch. Unless the expression overrides it, each row is made into a
+   * tuple for Evaluate.
+   * @param batch The rows
+   * @param[out] result The value of each row
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+    result->clear();
+    for (uint32_t row = 0; row < batch.Size(); row++) {
+      Tuple tuple = batch.GetTuple(row);
+      result->push_back(Evaluate(&tuple, batch.GetSchema()));
+    }
+  }
+
+  /**
+   * Evaluates a JOIN on every pair of rows of the same index in two batches of the same size. Unless the expression
+   * overrides it, each row is made into a tuple for EvaluateJoin.
+   * @param left The left rows
+   * @param right The right rows
+   * @param[out] result The value of each pair of rows
+   */
+  virtual void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const {
+    result->clear();
+    for (uint32_t row = 0; row < left.Size(); row++) {
+      Tuple left_tuple = left.GetTuple(row);
+      Tuple right_tuple = right.GetTuple(row);
+      result->push_back(EvaluateJoin(&left_tuple, left.GetSchema(), &right_tuple, right.GetSchema()));
+    }
+  }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpression *GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
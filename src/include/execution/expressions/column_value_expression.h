@@ -45,6 +45,14 @@ class ColumnValueExpression : public AbstractExpression {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    *result = batch.GetColumn(col_idx_);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const override {
+    *result = tuple_idx_ == 0 ? left.GetColumn(col_idx_) : right.GetColumn(col_idx_);
+  }
+
   uint32_t GetTupleIdx() const { return tuple_idx_; }
   uint32_t GetColIdx() const { return col_idx_; }
 
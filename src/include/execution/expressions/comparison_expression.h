@@ -53,7 +53,32 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    PerformComparisons(lhs, rhs, result);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateJoinBatch(left, right, &lhs);
+    GetChildAt(1)->EvaluateJoinBatch(left, right, &rhs);
+    PerformComparisons(lhs, rhs, result);
+  }
+
  private:
+  void PerformComparisons(const std::vector<Value> &lhs, const std::vector<Value> &rhs,
+                          std::vector<Value> *result) const {
+    result->clear();
+    result->reserve(lhs.size());
+    for (size_t i = 0; i < lhs.size(); i++) {
+      result->push_back(ValueFactory::GetBooleanValue(PerformComparison(lhs[i], rhs[i])));
+    }
+  }
+
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
     switch (comp_type_) {
       case ComparisonType::Equal:
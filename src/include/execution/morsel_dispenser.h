@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_dispenser.h
+//
+// Identification: src/include/execution/morsel_dispenser.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "common/config.h"
+#include "execution/parallel_state.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * A MorselDispenser hands out the pages of a table to the workers of a parallel scan, a morsel of a few consecutive
+ * pages at a time. Workers claim the next morsel whenever they are done with one, so a worker that is held up by cold
+ * pages or by more qualifying tuples claims fewer morsels, and the work balances itself without partitioning the
+ * table up front.
+ *
+ * The dispenser takes the pages of the table from its free space map in order of the page chain when it is reset, so
+ * the scan never walks the chain to split up the work.
+ */
+class MorselDispenser : public ParallelState {
+ public:
+  /**
+   * @param table the table whose pages to hand out
+   * @param morsel_size the number of pages in a morsel
+   */
+  explicit MorselDispenser(TableHeap *table, size_t morsel_size = SCAN_MORSEL_PAGES)
+      : table_(table), morsel_size_(morsel_size) {}
+
+  /** Takes the pages of the table, to hand them out from the first one. */
+  void Reset() override {
+    page_ids_.clear();
+    table_->GetPageIds(&page_ids_);
+    next_.store(0);
+    cancelled_.store(false);
+  }
+
+  /** Hands out no more morsels. */
+  void Cancel() override { cancelled_.store(true); }
+
+  /**
+   * Claims the next morsel. Safe to call from any number of threads.
+   * @param[out] morsel the pages of the morsel
+   * @return false once every page has been handed out
+   */
+  bool Next(std::vector<page_id_t> *morsel) {
+    if (cancelled_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    size_t begin = next_.fetch_add(morsel_size_, std::memory_order_relaxed);
+    if (begin >= page_ids_.size()) {
+      return false;
+    }
+    size_t end = std::min(begin + morsel_size_, page_ids_.size());
+    morsel->assign(page_ids_.begin() + begin, page_ids_.begin() + end);
+    return true;
+  }
+
+  /** @return the number of pages to hand out */
+  size_t GetNumPages() const { return page_ids_.size(); }
+
+ private:
+  /** The table whose pages to hand out */
+  TableHeap *table_;
+  /** The number of pages in a morsel */
+  const size_t morsel_size_;
+  /** The pages to hand out, in the order of the page chain */
+  std::vector<page_id_t> page_ids_;
+  /** The index in page_ids_ of the first page of the next morsel */
+  std::atomic<size_t> next_{0};
+  /** Whether the dispenser was cancelled */
+  std::atomic<bool> cancelled_{false};
+};
+
+}  // namespace bustub
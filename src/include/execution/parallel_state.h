@@ -0,0 +1,33 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_state.h
+//
+// Identification: src/include/execution/parallel_state.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+namespace bustub {
+
+/**
+ * ParallelState is state that the copies of a plan share when they run in parallel, such as the pages that the copies
+ * of a sequential scan have yet to claim (see ExecutorFactory::CreateExecutors). The operator that runs the copies
+ * resets the state before it initializes them, and cancels it to stop them early.
+ */
+class ParallelState {
+ public:
+  virtual ~ParallelState() = default;
+
+  /** Starts over, for a new run of the copies. Never called while the copies run. */
+  virtual void Reset() = 0;
+
+  /** Ends the input of the copies, so that the copies that are running finish soon. */
+  virtual void Cancel() = 0;
+};
+
+}  // namespace bustub
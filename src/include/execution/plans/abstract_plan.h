@@ -31,7 +31,9 @@ enum class PlanType {
   Distinct,
   NestedLoopJoin,
   NestedIndexJoin,
-  HashJoin
+  HashJoin,
+  Gather,
+  Exchange
 };
 
 /**
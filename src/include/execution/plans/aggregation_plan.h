@@ -29,6 +29,10 @@ enum class AggregationType { CountAggregate, SumAggregate, MinAggregate, MaxAggr
  * For example, COUNT(), SUM(), MIN() and MAX().
  *
  * NOTE: To simplify this project, AggregationPlanNode must always have exactly one child.
+ *
+ * An aggregation with more than one worker runs that many copies of its child plan in parallel, which split the
+ * tables that they scan sequentially between them as under a Gather, and aggregates their output in two phases (see
+ * AggregationExecutor).
  */
 class AggregationPlanNode : public AbstractPlanNode {
  public:
@@ -40,15 +44,18 @@ class AggregationPlanNode : public AbstractPlanNode {
    * @param group_bys The group by clause of the aggregation
    * @param aggregates The expressions that we are aggregating
    * @param agg_types The types that we are aggregating
+   * @param num_workers The number of threads that aggregate the output of the child plan
    */
   AggregationPlanNode(const Schema *output_schema, const AbstractPlanNode *child, const AbstractExpression *having,
                       std::vector<const AbstractExpression *> &&group_bys,
-                      std::vector<const AbstractExpression *> &&aggregates, std::vector<AggregationType> &&agg_types)
+                      std::vector<const AbstractExpression *> &&aggregates, std::vector<AggregationType> &&agg_types,
+                      uint32_t num_workers = 1)
       : AbstractPlanNode(output_schema, {child}),
         having_(having),
         group_bys_(std::move(group_bys)),
         aggregates_(std::move(aggregates)),
-        agg_types_(std::move(agg_types)) {}
+        agg_types_(std::move(agg_types)),
+        num_workers_(num_workers) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::Aggregation; }
@@ -77,6 +84,9 @@ class AggregationPlanNode : public AbstractPlanNode {
   /** @return The aggregate types */
   const std::vector<AggregationType> &GetAggregateTypes() const { return agg_types_; }
 
+  /** @return The number of threads that aggregate the output of the child plan */
+  uint32_t GetNumWorkers() const { return num_workers_; }
+
  private:
   /** A HAVING clause expression (may be `nullptr`) */
   const AbstractExpression *having_;
@@ -86,6 +96,8 @@ class AggregationPlanNode : public AbstractPlanNode {
   std::vector<const AbstractExpression *> aggregates_;
   /** The aggregation types */
   std::vector<AggregationType> agg_types_;
+  /** The number of threads that aggregate the output of the child plan */
+  uint32_t num_workers_;
 };
 
 /** AggregateKey represents a key in an aggregation operation */
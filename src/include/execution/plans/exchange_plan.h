@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_plan.h
+//
+// Identification: src/include/execution/plans/exchange_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** ExchangeType is how an Exchange deals the tuples of its input out to its consumers. */
+enum class ExchangeType {
+  /** Each tuple goes to one consumer, by the hash of its partition keys */
+  Hash,
+  /** Each tuple goes to every consumer */
+  Broadcast
+};
+
+/**
+ * Exchange runs several copies of its child plan in parallel, and deals their output out to the copies of the plan
+ * above it, that a Gather runs in parallel. Each copy above consumes one partition of the output. Tuples with equal
+ * partition keys end up in the same partition, so that each copy of a join or an aggregation above a hash Exchange
+ * gets all the tuples of the keys it deals with. A broadcast Exchange hands every copy above all of the output, e.g.
+ * for the build side of a join with a small table.
+ *
+ * An Exchange that is not below a Gather has one consumer, and merges the output of its copies like a Gather does.
+ */
+class ExchangePlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new ExchangePlanNode instance.
+   * @param output_schema The output schema, which is that of the child plan
+   * @param child The child plan, of which the copies run in parallel
+   * @param num_workers The number of copies of the child plan, each of which runs on its own thread
+   * @param exchange_type How the tuples are dealt out to the consumers
+   * @param partition_keys The expressions on the tuples of the child whose values are hashed for a hash Exchange
+   */
+  ExchangePlanNode(const Schema *output_schema, const AbstractPlanNode *child, uint32_t num_workers,
+                   ExchangeType exchange_type, std::vector<const AbstractExpression *> &&partition_keys = {})
+      : AbstractPlanNode(output_schema, {child}),
+        num_workers_{num_workers},
+        exchange_type_{exchange_type},
+        partition_keys_{std::move(partition_keys)} {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Exchange; }
+
+  /** @return The number of copies of the child plan */
+  uint32_t GetNumWorkers() const { return num_workers_; }
+
+  /** @return How the tuples are dealt out to the consumers */
+  ExchangeType GetExchangeType() const { return exchange_type_; }
+
+  /** @return The expressions whose values are hashed for a hash Exchange */
+  const std::vector<const AbstractExpression *> &GetPartitionKeys() const { return partition_keys_; }
+
+  /** @return The child plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Exchange should have at most one child plan.");
+    return GetChildAt(0);
+  }
+
+ private:
+  /** The number of copies of the child plan */
+  uint32_t num_workers_;
+  /** How the tuples are dealt out to the consumers */
+  ExchangeType exchange_type_;
+  /** The expressions whose values are hashed for a hash Exchange */
+  std::vector<const AbstractExpression *> partition_keys_;
+};
+
+}  // namespace bustub
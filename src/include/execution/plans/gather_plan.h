@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_plan.h
+//
+// Identification: src/include/execution/plans/gather_plan.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * Gather runs several copies of its child plan in parallel, and merges their output into one stream, in no particular
+ * order.
+ *
+ * The copies of the child plan split the tables that they scan sequentially between them, so each tuple of such a
+ * table comes out of one copy. Other leaves, such as index scans, are read in full by every copy. A part of the plan
+ * that must see all of its input, such as a join, a distinct or an aggregation, goes above an Exchange that partitions
+ * its input the same way for every copy. The copies share their scans, so they cannot rescan them, as the inner side
+ * of a nested loop join would. ExecutorFactory throws NotImplementedException for the plans whose copies would be
+ * wrong, which include those that modify a table and limits.
+ */
+class GatherPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new GatherPlanNode instance.
+   * @param output_schema The output schema, which is that of the child plan
+   * @param child The child plan, of which the copies run in parallel
+   * @param num_workers The number of copies of the child plan, each of which runs on its own thread
+   */
+  GatherPlanNode(const Schema *output_schema, const AbstractPlanNode *child, uint32_t num_workers)
+      : AbstractPlanNode(output_schema, {child}), num_workers_{num_workers} {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Gather; }
+
+  /** @return The number of copies of the child plan */
+  uint32_t GetNumWorkers() const { return num_workers_; }
+
+  /** @return The child plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Gather should have at most one child plan.");
+    return GetChildAt(0);
+  }
+
+ private:
+  /** The number of copies of the child plan */
+  uint32_t num_workers_;
+};
+
+}  // namespace bustub
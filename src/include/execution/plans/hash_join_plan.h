@@ -15,12 +15,17 @@
 #include <utility>
 #include <vector>
 
+#include "common/config.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
 
 /**
  * Hash join performs a JOIN operation with a hash table.
+ *
+ * The hash table of the left side is held in memory up to a budget. Beyond it, the join spills partitions of both
+ * sides to the buffer pool, and joins them one at a time later (see HashJoinExecutor). A radix-partitioned join
+ * also splits the partitions in memory into cache-sized chunks, and probes them a chunk at a time.
  */
 class HashJoinPlanNode : public AbstractPlanNode {
  public:
@@ -30,12 +35,17 @@ class HashJoinPlanNode : public AbstractPlanNode {
    * @param children The child plans from which tuples are obtained
    * @param left_key_expression The expression for the left JOIN key
    * @param right_key_expression The expression for the right JOIN key
+   * @param memory_budget The number of bytes of left tuples that the join holds in memory
+   * @param radix_partitioned Whether the join probes cache-sized chunks of the left tuples one at a time
    */
   HashJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
-                   const AbstractExpression *left_key_expression, const AbstractExpression *right_key_expression)
+                   const AbstractExpression *left_key_expression, const AbstractExpression *right_key_expression,
+                   size_t memory_budget = HASH_JOIN_MEMORY_BUDGET, bool radix_partitioned = false)
       : AbstractPlanNode(output_schema, std::move(children)),
         left_key_expression_{left_key_expression},
-        right_key_expression_{right_key_expression} {}
+        right_key_expression_{right_key_expression},
+        memory_budget_{memory_budget},
+        radix_partitioned_{radix_partitioned} {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::HashJoin; }
@@ -46,6 +56,12 @@ class HashJoinPlanNode : public AbstractPlanNode {
   /** @return The expression to compute the right join key */
   const AbstractExpression *RightJoinKeyExpression() const { return right_key_expression_; }
 
+  /** @return The number of bytes of left tuples that the join holds in memory */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
+  /** @return Whether the join probes cache-sized chunks of the left tuples one at a time */
+  bool IsRadixPartitioned() const { return radix_partitioned_; }
+
   /** @return The left plan node of the hash join */
   const AbstractPlanNode *GetLeftPlan() const {
     BUSTUB_ASSERT(GetChildren().size() == 2, "Hash joins should have exactly two children plans.");
@@ -63,6 +79,10 @@ class HashJoinPlanNode : public AbstractPlanNode {
   const AbstractExpression *left_key_expression_;
   /** The expression to compute the right JOIN key */
   const AbstractExpression *right_key_expression_;
+  /** The number of bytes of left tuples that the join holds in memory */
+  size_t memory_budget_;
+  /** Whether the join probes cache-sized chunks of the left tuples one at a time */
+  bool radix_partitioned_;
 };
 
 }  // namespace bustub
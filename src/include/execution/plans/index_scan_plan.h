@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <optional>
+#include <utility>
+
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
@@ -32,6 +35,28 @@ class IndexScanPlanNode : public AbstractPlanNode {
   IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
       : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
 
+  /**
+   * Creates a new index scan plan node over a range of keys.
+   * @param output the output format of this scan plan node
+   * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
+   * nullptr
+   * @param index_oid the identifier of the index to be scanned
+   * @param low_key the low key of the range, in the key schema of the index, or std::nullopt for none
+   * @param low_inclusive whether the low key is in the range
+   * @param high_key the high key of the range, in the key schema of the index, or std::nullopt for none
+   * @param high_inclusive whether the high key is in the range
+   */
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    std::optional<Tuple> low_key, bool low_inclusive, std::optional<Tuple> high_key,
+                    bool high_inclusive)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        low_key_(std::move(low_key)),
+        low_inclusive_(low_inclusive),
+        high_key_(std::move(high_key)),
+        high_inclusive_(high_inclusive) {}
+
   PlanType GetType() const override { return PlanType::IndexScan; }
 
   /** @return the predicate to test tuples against; tuples should only be returned if they evaluate to true */
@@ -40,11 +65,28 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return the low key of the range, nullptr if the range starts at the first key */
+  const Tuple *GetLowKey() const { return low_key_.has_value() ? &*low_key_ : nullptr; }
+
+  /** @return whether the low key is in the range */
+  bool IsLowInclusive() const { return low_inclusive_; }
+
+  /** @return the high key of the range, nullptr if the range goes on to the last key */
+  const Tuple *GetHighKey() const { return high_key_.has_value() ? &*high_key_ : nullptr; }
+
+  /** @return whether the high key is in the range */
+  bool IsHighInclusive() const { return high_inclusive_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** The bounds of the range of keys to scan. */
+  std::optional<Tuple> low_key_;
+  bool low_inclusive_{true};
+  std::optional<Tuple> high_key_;
+  bool high_inclusive_{true};
 };
 
 }  // namespace bustub
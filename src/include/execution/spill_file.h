@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_file.h
+//
+// Identification: src/include/execution/spill_file.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "execution/tuple_batch.h"
+#include "storage/page/tmp_tuple_page.h"
+
+namespace bustub {
+
+/**
+ * A SpillFile holds the rows that an operator moves out of its memory, such as a partition of a hash join that does
+ * not fit in its memory budget. The rows go into TmpTuplePages of the buffer pool, which writes them to disk only when
+ * it needs their frames.
+ *
+ * The file fills a page of its own, outside of the buffer pool, and copies it into a new page of the buffer pool once
+ * it is full, so a file pins no frame while it is written. A file is read once, a batch at a time, and deletes each
+ * page once it has read all of its rows.
+ */
+class SpillFile {
+ public:
+  /**
+   * @param bpm the buffer pool that holds the pages of the file
+   * @param schema the schema of the rows
+   */
+  SpillFile(BufferPoolManager *bpm, const Schema *schema);
+
+  /** Deletes the pages that were not read. */
+  ~SpillFile();
+
+  DISALLOW_COPY_AND_MOVE(SpillFile);
+
+  /** Appends a row of a batch with the schema of the file. */
+  void Append(const TupleBatch &batch, uint32_t row);
+
+  /** Appends a tuple with the schema of the file. */
+  void Append(const Tuple &tuple);
+
+  /**
+   * Reads the next rows, in no particular order. Rows are not appended once reading has started.
+   * @param[out] batch the next rows, up to TupleBatch::BATCH_SIZE
+   * @return false once every row has been read
+   */
+  bool NextBatch(TupleBatch *batch);
+
+  /** @return the number of rows appended */
+  size_t GetNumRows() const { return num_rows_; }
+
+  /** @return the number of pages written to the buffer pool */
+  size_t GetNumPages() const { return page_ids_.size(); }
+
+ private:
+  /** Copies the page being filled into a new page of the buffer pool, and starts over with an empty one. */
+  void Flush();
+
+  /**
+   * Appends the rows of a page from the read cursor on to a batch, until the batch is full.
+   * @return true if every row of the page was read, in which case the cursor moves on to the next page
+   */
+  bool ReadPage(TmpTuplePage *page, TupleBatch *batch);
+
+  BufferPoolManager *bpm_;
+  /** The schema of the rows */
+  const Schema *schema_;
+  /** The page being filled */
+  std::unique_ptr<TmpTuplePage> page_;
+  /** The pages written to the buffer pool, in order */
+  std::vector<page_id_t> page_ids_;
+  /** The number of pages of page_ids_ that were read */
+  size_t num_read_pages_{0};
+  /** The offset of the next row to read in the page being read, 0 before its first row */
+  uint32_t read_offset_{0};
+  /** The number of rows appended */
+  size_t num_rows_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "common/macros.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * A TupleBatch holds the rows that an executor produces in one call to NextBatch, up to BATCH_SIZE of them. The rows
+ * are stored by column, as one vector of values for each column of the schema, so that expressions are evaluated on
+ * a whole column at a time (see AbstractExpression::EvaluateBatch) and no tuple is built for a row until the query
+ * returns it. A batch also holds the RID of each row, which is only valid for the rows of a table.
+ *
+ * A batch of table rows may decode only the columns that a query reads, in which case the other columns stay empty.
+ */
+class TupleBatch {
+ public:
+  /** The number of rows an executor produces in one call to NextBatch */
+  static constexpr uint32_t BATCH_SIZE = 1024;
+
+  TupleBatch() = default;
+
+  /** Creates an empty batch of rows with the schema. */
+  explicit TupleBatch(const Schema *schema) { Reset(schema); }
+
+  /** Removes all the rows, and gives the batch a new schema, which may be `nullptr` for rows without columns. */
+  void Reset(const Schema *schema) {
+    schema_ = schema;
+    columns_.resize(schema == nullptr ? 0 : schema->GetColumnCount());
+    Clear();
+  }
+
+  /** Removes all the rows, keeping the memory of the columns. */
+  void Clear() {
+    for (auto &column : columns_) {
+      column.clear();
+    }
+    rids_.clear();
+  }
+
+  /** @return the schema of the rows */
+  const Schema *GetSchema() const { return schema_; }
+
+  /** @return the number of rows */
+  uint32_t Size() const { return static_cast<uint32_t>(rids_.size()); }
+
+  bool IsEmpty() const { return rids_.empty(); }
+
+  bool IsFull() const { return rids_.size() >= BATCH_SIZE; }
+
+  /** @return the value of a column of a row, which must have been decoded */
+  const Value &GetValue(uint32_t row, uint32_t col_idx) const {
+    BUSTUB_ASSERT(row < columns_[col_idx].size(), "The column of the batch was not decoded.");
+    return columns_[col_idx][row];
+  }
+
+  /** @return the values of a column, one for each row, which must have been decoded */
+  const std::vector<Value> &GetColumn(uint32_t col_idx) const {
+    BUSTUB_ASSERT(columns_[col_idx].size() == rids_.size(), "The column of the batch was not decoded.");
+    return columns_[col_idx];
+  }
+
+  /** @return the values of a column, to be filled with one value for each row along with the RIDs */
+  std::vector<Value> *MutableColumn(uint32_t col_idx) { return &columns_[col_idx]; }
+
+  /** @return the RID of a row */
+  RID GetRid(uint32_t row) const { return rids_[row]; }
+
+  /** @return the RIDs of the rows */
+  const std::vector<RID> &GetRids() const { return rids_; }
+
+  /** @return the RIDs of the rows, which set the number of rows when the columns are filled directly */
+  std::vector<RID> *MutableRids() { return &rids_; }
+
+  /** Appends a row from a tuple with the schema of the batch. */
+  void Append(const Tuple &tuple, RID rid) {
+    for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+      columns_[col_idx].push_back(tuple.GetValue(schema_, col_idx));
+    }
+    rids_.push_back(rid);
+  }
+
+  /**
+   * Appends a row from a tuple with the schema of the batch, decoding only some of its columns.
+   * @param col_idxs the columns to decode, in increasing order; the other columns stay empty and must not be read
+   */
+  void Append(const Tuple &tuple, RID rid, const std::vector<uint32_t> &col_idxs) {
+    for (uint32_t col_idx : col_idxs) {
+      columns_[col_idx].push_back(tuple.GetValue(schema_, col_idx));
+    }
+    rids_.push_back(rid);
+  }
+
+  /** Appends a row of values, one for each column. */
+  void Append(std::vector<Value> &&values, RID rid) {
+    for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+      columns_[col_idx].push_back(std::move(values[col_idx]));
+    }
+    rids_.push_back(rid);
+  }
+
+  /** Appends a row of another batch with the same schema. */
+  void AppendRow(const TupleBatch &other, uint32_t row) {
+    for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+      columns_[col_idx].push_back(other.columns_[col_idx][row]);
+    }
+    rids_.push_back(other.rids_[row]);
+  }
+
+  /** Appends all the rows of another batch with the same schema. */
+  void AppendBatch(const TupleBatch &other) {
+    for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+      columns_[col_idx].insert(columns_[col_idx].end(), other.columns_[col_idx].begin(),
+                               other.columns_[col_idx].end());
+    }
+    rids_.insert(rids_.end(), other.rids_.begin(), other.rids_.end());
+  }
+
+  /** Keeps the rows whose selection value is true, in order. */
+  void Select(const std::vector<Value> &selection) {
+    uint32_t size = 0;
+    for (uint32_t row = 0; row < rids_.size(); row++) {
+      if (!selection[row].IsNull() && selection[row].GetAs<bool>()) {
+        if (size != row) {
+          for (auto &column : columns_) {
+            if (!column.empty()) {
+              column[size] = column[row];
+            }
+          }
+          rids_[size] = rids_[row];
+        }
+        size++;
+      }
+    }
+    Truncate(size);
+  }
+
+  /** Keeps the first size rows. */
+  void Truncate(uint32_t size) {
+    if (size >= rids_.size()) {
+      return;
+    }
+    for (auto &column : columns_) {
+      if (!column.empty()) {
+        column.resize(size);
+      }
+    }
+    rids_.resize(size);
+  }
+
+  /** @return a tuple of the values of a row, with NULL in the columns that were not decoded */
+  Tuple GetTuple(uint32_t row) const {
+    std::vector<Value> values;
+    values.reserve(columns_.size());
+    for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+      const auto &column = columns_[col_idx];
+      if (column.empty()) {
+        values.push_back(ValueFactory::GetNullValueByType(schema_->GetColumn(col_idx).GetType()));
+      } else {
+        values.push_back(column[row]);
+      }
+    }
+    return Tuple(values, schema_);
+  }
+
+ private:
+  /** The schema of the rows */
+  const Schema *schema_{nullptr};
+  /** The values of each column */
+  std::vector<std::vector<Value>> columns_;
+  /** The RID of each row */
+  std::vector<RID> rids_;
+};
+
+}  // namespace bustub
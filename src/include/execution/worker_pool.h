@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.h
+//
+// Identification: src/include/execution/worker_pool.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * WorkerPool runs the pipelines of the parallel operators of a query (see GatherExecutor and ExchangeExecutor) on
+ * threads that the query keeps for its whole run, so that rescanning a parallel operator does not start new threads.
+ *
+ * The pipelines of a query wait on each other through exchange queues, so a task that waited for a free worker could
+ * wait forever for a task that cannot finish without it. Every task therefore starts right away, on an idle worker if
+ * there is one and on a new worker otherwise; the pool is as large as the most tasks that ran at once.
+ */
+class WorkerPool {
+ public:
+  WorkerPool() = default;
+
+  /** Waits for the running tasks, and stops the workers. */
+  ~WorkerPool();
+
+  DISALLOW_COPY_AND_MOVE(WorkerPool);
+
+  /**
+   * Runs a task on a worker.
+   * @param task the task
+   * @return a future that is ready once the task has run
+   */
+  std::future<void> Submit(std::function<void()> task);
+
+  /** @return the number of workers the pool started */
+  size_t GetNumWorkers();
+
+ private:
+  /** Runs the tasks that are handed to a worker, until the pool stops. */
+  void Work();
+
+  /** The tasks that no worker has taken yet */
+  std::deque<std::packaged_task<void()>> tasks_;
+  /** The number of workers that wait for a task */
+  size_t num_idle_{0};
+  /** Whether the pool is stopping */
+  bool stopped_{false};
+  std::vector<std::thread> workers_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
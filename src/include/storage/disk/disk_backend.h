@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_backend.h
+//
+// Identification: src/include/storage/disk/disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The ways in which the DiskManager can perform asynchronous page I/O. */
+enum class DiskBackendType { IO_URING, POSIX };
+
+/**
+ * DiskRequest is a single page read or write handed to the DiskManager. The request and its buffer must stay alive
+ * until callback_ is set, which happens once the I/O is done: to true if it succeeded and to false otherwise.
+ */
+struct DiskRequest {
+  DiskRequest() : DiskRequest(false, nullptr, INVALID_PAGE_ID) {}
+
+  DiskRequest(bool is_write, char *data, page_id_t page_id)
+      : is_write_(is_write), data_(data), page_id_(page_id), done_(callback_.get_future().share()) {}
+
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** PAGE_SIZE bytes to write from, or to read into. */
+  char *data_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** Signalled when the request completes. */
+  std::promise<bool> callback_;
+  /** The future of callback_, retrieved once when the request is created. */
+  std::shared_future<bool> done_;
+};
+
+/**
+ * DiskBackend performs batches of page reads and writes on an open database file without blocking the caller.
+ *
+ * Requests may complete in any order. Submit can be called from several threads at once, and every request that was
+ * submitted completes before ShutDown returns.
+ */
+class DiskBackend {
+ public:
+  virtual ~DiskBackend() = default;
+
+  /**
+   * Start a batch of page reads and writes.
+   * @param requests the requests to submit
+   * @param num_requests the number of requests
+   */
+  virtual void Submit(DiskRequest *requests, size_t num_requests) = 0;
+
+  /** Wait for the outstanding requests to complete and release the backend's resources. */
+  virtual void ShutDown() = 0;
+
+  /** @return the type of this backend */
+  virtual DiskBackendType GetType() const = 0;
+
+  /**
+   * Create a backend, falling back to the POSIX backend if io_uring is not available on this system.
+   * @param type the preferred backend type
+   * @param fd the database file
+   * @return the new backend
+   */
+  static std::unique_ptr<DiskBackend> Create(DiskBackendType type, int fd);
+
+  /**
+   * Read a page with pread, zeroing whatever lies past the end of the file.
+   * @return false on an I/O error
+   */
+  static bool ReadPageAt(int fd, page_id_t page_id, char *page_data);
+
+  /**
+   * Write a page with pwrite.
+   * @return false on an I/O error
+   */
+  static bool WritePageAt(int fd, page_id_t page_id, const char *page_data);
+};
+
+}  // namespace bustub
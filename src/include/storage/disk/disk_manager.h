@@ -15,26 +15,39 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <shared_mutex>  // NOLINT
 #include <string>
 
 #include "common/config.h"
+#include "storage/disk/disk_backend.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are accessed with positional I/O on a plain file descriptor, so concurrent readers and writers (e.g. the
+ * instances of a parallel buffer pool) do not serialize on a shared file cursor. ReadPage and WritePage block the
+ * calling thread; SubmitRequests starts a batch of reads and writes on the asynchronous backend and returns at once.
+ *
+ * With direct I/O the database file is opened with O_DIRECT, bypassing the OS page cache. Every buffer handed to the
+ * disk manager must then be aligned to DISK_IO_ALIGNMENT, as buffer pool frames are.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param backend_type the backend for asynchronous I/O; IO_URING is opt-in and falls back to POSIX if io_uring is
+   * not available
+   * @param direct_io true to bypass the OS page cache, ignored if the file system does not support it
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskBackendType backend_type = DiskBackendType::POSIX,
+                       bool direct_io = false);
 
-  ~DiskManager() = default;
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -55,6 +68,28 @@ class DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Start a batch of page reads and writes without waiting for them. The callback_ of each request is set once it
+   * completes; the requests and their buffers must stay alive until then.
+   * @param requests the requests to submit
+   * @param num_requests the number of requests
+   */
+  void SubmitRequests(DiskRequest *requests, size_t num_requests);
+
+  /**
+   * Wait for a batch of submitted requests to complete.
+   * @param requests the requests to wait for
+   * @param num_requests the number of requests
+   * @return true if all of the requests succeeded
+   */
+  static bool WaitForRequests(DiskRequest *requests, size_t num_requests);
+
+  /** @return the backend used for asynchronous I/O */
+  DiskBackendType GetBackendType() const { return backend_->GetType(); }
+
+  /** @return true if the database file was opened with O_DIRECT */
+  bool IsDirectIo() const { return direct_io_; }
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -77,6 +112,9 @@ class DiskManager {
   /** @return true iff the in-memory content has not been flushed yet */
   bool GetFlushState() const;
 
+  /** @return the number of page reads */
+  int GetNumReads() const;
+
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
@@ -94,15 +132,18 @@ class DiskManager {
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, accessed with pread/pwrite only
+  int db_fd_{-1};
+  // page I/O shares this latch and never blocks on it, ShutDown takes it exclusively to close the file
+  std::shared_mutex db_fd_latch_;
   std::string file_name_;
+  bool direct_io_{false};
+  std::unique_ptr<DiskBackend> backend_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_reads_;
+  std::atomic<int> num_writes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_backend.h
+//
+// Identification: src/include/storage/disk/io_uring_disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
+#include "storage/disk/disk_backend.h"
+
+#if __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAS_IO_URING
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * IoUringDiskBackend hands page I/O to the kernel through an io_uring. A batch of requests is queued in the
+ * submission ring and submitted with one system call, and a completion thread reaps the completion ring.
+ *
+ * The rings are set up with raw system calls, so the backend needs nothing beyond the kernel headers. If the kernel
+ * does not support io_uring (or the reads and writes it needs), IsValid() returns false and the backend must not be
+ * used; DiskBackend::Create falls back to the POSIX backend in that case.
+ */
+class IoUringDiskBackend : public DiskBackend {
+ public:
+  /**
+   * Set up the rings and start the completion thread.
+   * @param fd the database file
+   * @param queue_depth the number of submission queue entries
+   */
+  explicit IoUringDiskBackend(int fd, uint32_t queue_depth = DISK_IO_QUEUE_DEPTH);
+
+  ~IoUringDiskBackend() override;
+
+  /** @return true if the rings were set up successfully */
+  bool IsValid() const { return ring_fd_ >= 0; }
+
+  void Submit(DiskRequest *requests, size_t num_requests) override;
+
+  void ShutDown() override;
+
+  DiskBackendType GetType() const override { return DiskBackendType::IO_URING; }
+
+ private:
+  /** Create and map the rings. Leaves ring_fd_ negative on failure. */
+  void SetUp(uint32_t queue_depth);
+
+  /** Unmap and close the rings. */
+  void TearDown();
+
+  /** Queue one entry in the submission ring. Caller holds submit_latch_ and made sure there is room. */
+  void PushEntry(uint8_t opcode, DiskRequest *request);
+
+  /** Submit the queued entries to the kernel. Caller holds submit_latch_. */
+  void Enter(uint32_t to_submit);
+
+  /** Body of the completion thread: reap completions until the shutdown entry comes back. */
+  void CompletionLoop();
+
+  /** Finish a request whose I/O returned result. */
+  void Complete(DiskRequest *request, int result);
+
+  int fd_;
+  int ring_fd_{-1};
+
+  /* The mapped rings, shared with the kernel. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  /* Pointers into the rings. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  uint32_t sq_entries_{0};
+  uint32_t cq_entries_{0};
+
+  /** Entries in the submission ring that have not been submitted yet. */
+  uint32_t pending_{0};
+  /** Submitted requests that have not completed yet. Kept below cq_entries_ so the completion ring never overflows. */
+  size_t in_flight_{0};
+  bool shutdown_{false};
+  /** Protects the submission ring, pending_, in_flight_ and shutdown_. */
+  std::mutex submit_latch_;
+  std::condition_variable in_flight_cv_;
+  std::thread completion_thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_backend.h
+//
+// Identification: src/include/storage/disk/posix_disk_backend.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_backend.h"
+
+namespace bustub {
+
+/**
+ * PosixDiskBackend runs page I/O on a small pool of worker threads that use pread and pwrite. Positional I/O does not
+ * share a file cursor, so the workers never serialize on the file.
+ */
+class PosixDiskBackend : public DiskBackend {
+ public:
+  /**
+   * Create the backend. The worker threads are started by the first Submit.
+   * @param fd the database file
+   * @param num_threads the number of worker threads
+   */
+  explicit PosixDiskBackend(int fd, size_t num_threads = DISK_IO_THREADS);
+
+  ~PosixDiskBackend() override;
+
+  void Submit(DiskRequest *requests, size_t num_requests) override;
+
+  void ShutDown() override;
+
+  DiskBackendType GetType() const override { return DiskBackendType::POSIX; }
+
+ private:
+  /** Body of a worker thread: run queued requests until shut down. */
+  void WorkerLoop();
+
+  int fd_;
+  size_t num_threads_;
+  std::vector<std::thread> workers_;
+  /** Requests that no worker has picked up yet. */
+  std::deque<DiskRequest *> queue_;
+  bool shutdown_{false};
+  /** Protects workers_, queue_ and shutdown_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
@@ -10,14 +10,21 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
@@ -28,10 +35,20 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique unless the tree is created with unique_keys = false, in which case the RIDs of a key with
+ *     more than one RID are kept in a posting list (see BPlusTreePostingPage)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is safe to use from many threads. Readers do not latch internal pages: they remember the version of each
+ * page on the way down and check that it did not change once they have read the child pointer (see
+ * Page::GetVersion), and start over from the root if it did. Only the leaf is read-latched.
+ *
+ * Writers first descend the same way and write-latch only the leaf. Most inserts and removes do not split or merge the
+ * leaf and are done at that point. The others start over and crab down from the root with write latches, keeping the
+ * latches of the pages that may split or merge, and of the first page above them that will not, in the page set of
+ * the transaction. The root page id itself is guarded by root_latch_, which is held as long as the root may change.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -39,8 +56,11 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // An internal page holds one entry more than its max size before it splits, hence the default internal max size.
+  // The root page id is recorded under the name of the tree in the header page header_page_id.
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE - 1,
+                     bool unique_keys = true, page_id_t header_page_id = HEADER_PAGE_ID);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -48,16 +68,25 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its value from this B+ tree, or all of its values if keys are not unique.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a key-value pair from this B+ tree.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // Build an empty B+ tree bottom-up from key-value pairs pulled from next() in strictly increasing key order, or
+  // strictly increasing key and value order if keys are not unique.
+  bool BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor = 1.0);
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE End();
+  // iterator over the keys between low and high, nullptr for an open bound
+  INDEXITERATOR_TYPE ScanRange(const KeyType *low, bool low_inclusive, const KeyType *high, bool high_inclusive);
 
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
@@ -70,26 +99,68 @@ class BPlusTree {
 
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
-  // expose for test purpose
+  // expose for test purpose; the leaf is returned pinned and read-latched, nullptr if the tree is empty
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  /** What a descent to a leaf is for: it decides how the leaf is latched and which pages are safe. */
+  enum class Operation { FIND, INSERT, REMOVE };
+
+  // descend without latching internal pages, and latch only the leaf
+  Page *FindLeafPageOptimistic(const KeyType &key, bool left_most, Operation op);
+
+  // descend with write latches, keeping the latches of the pages that may change in the page set
+  Page *FindLeafPagePessimistic(const KeyType &key, Operation op, std::deque<Page *> *page_set);
+
+  // wait until no writer holds the page and return its version
+  uint64_t ReadVersion(Page *page) const;
+
+  // true if the operation cannot split or merge the page
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
+  // unlatch and unpin the pages of the page set, and release root_latch_ if it is in there
+  void ReleaseLatches(std::deque<Page *> *page_set, bool is_dirty);
+
+  // fetch a page of the tree, throwing an "out of memory" exception if the buffer pool has no frame for it
+  Page *FetchPage(page_id_t page_id);
+
+  // delete the pages emptied by a remove once nobody is latching them, keeping pinned ones for a later remove
+  void DeletePages(std::unordered_set<page_id_t> *deleted_page_set);
+
+  // the number of entries of the next page of a bulk loaded level
+  static int BulkLoadPageSize(int remaining, int fill, int max_size, int min_size);
+
+  // build the internal levels above the given (first key, page id) entries and return the root page id
+  page_id_t BulkLoadInternalLevels(std::vector<std::pair<KeyType, page_id_t>> *level, double fill_factor);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(LeafPage *leaf, const KeyType &key, const ValueType &value, std::deque<Page *> *page_set);
+
+  // add a value to a key of the leaf that already has the given value, turning it into a posting list if need be
+  bool InsertIntoPostingList(LeafPage *leaf, const KeyType &key, const ValueType &existing, const ValueType &value);
+
+  // remove the key with the given value, or with any value if value is nullptr
+  void RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  // remove the value from the posting list of the key, if it has one, and return whether the key itself must go
+  bool RemoveValue(LeafPage *leaf, const KeyType &key, const ValueType *value, bool *changed);
+
+  // remove the key from the leaf, along with its posting list, and return whether it was there
+  bool RemoveKey(LeafPage *leaf, const KeyType &key);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+                        std::deque<Page *> *page_set);
 
   template <typename N>
-  N *Split(N *node);
+  N *Split(N *node, std::deque<Page *> *page_set);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, std::deque<Page *> *page_set, std::unordered_set<page_id_t> *deleted_page_set);
 
   template <typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+                int index, std::deque<Page *> *page_set, std::unordered_set<page_id_t> *deleted_page_set);
 
   template <typename N>
   void Redistribute(N *neighbor_node, N *node, int index);
@@ -105,11 +176,19 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  /** Read without latching by optimistic descents, written only while holding root_latch_. */
+  std::atomic<page_id_t> root_page_id_;
+  /** Held by writers for as long as the root page id may change. */
+  std::mutex root_latch_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_keys_;
+  page_id_t header_page_id_;
+  /** Pages emptied by removes while a reader had them pinned, deleted by a later remove. */
+  std::vector<page_id_t> pinned_deletes_;
+  std::mutex pinned_deletes_latch_;
 };
 
 }  // namespace bustub
@@ -11,9 +11,12 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "storage/index/b_plus_tree.h"
@@ -26,7 +29,12 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * @param unique_keys false to allow many RIDs per key, in which case DeleteEntry only removes the given RID
+   * @param header_page_id the header page that records the root page id of the tree
+   */
+  BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                 bool unique_keys = true, page_id_t header_page_id = HEADER_PAGE_ID);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -34,17 +42,114 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Fill the empty index with the entries of a table at once: sort them by key and RID, and bulk load the tree.
+   *
+   * The sort is external, so that the entries are never all in memory: runs of BULK_LOAD_RUN_PAGES pages of entries
+   * are sorted in memory and written to pages of the buffer pool, and the runs are merged, BULK_LOAD_FAN_IN at a
+   * time, until a last merge feeds the tree. Entries that fit in a single run never leave memory.
+   * @param next sets the next key & RID pair, in any order, and returns false once there is none
+   * @return false if the index is not empty, or if its keys are unique and some key appears twice
+   */
+  bool BulkLoad(const std::function<bool(Tuple *, RID *)> &next);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  /**
+   * Scan the keys between two bounds. The iterator copies the entries of a leaf at a time, see
+   * IndexIterator::NextBatch.
+   * @param low the low key, nullptr to start at the first key
+   * @param low_inclusive whether the low key is in the range
+   * @param high the high key, nullptr to go on to the last key
+   * @param high_inclusive whether the high key is in the range
+   */
+  INDEXITERATOR_TYPE ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive);
+
+  /** The number of pages of entries that BulkLoad sorts in memory at a time */
+  static constexpr size_t BULK_LOAD_RUN_PAGES = 16;
+  /** The number of runs that BulkLoad merges at a time */
+  static constexpr size_t BULK_LOAD_FAN_IN = 8;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
   // container
   BPlusTree<KeyType, ValueType, KeyComparator> container_;
+  // buffer pool that holds the sorted runs of BulkLoad
+  BufferPoolManager *buffer_pool_manager_;
+
+ private:
+  /**
+   * A run of entries sorted by key and RID, that BulkLoad writes to pages of the buffer pool. The run fills a page of
+   * its own and copies it into a new page of the buffer pool once it is full, so a run pins no frame while it is
+   * written. A run is read once, from its first entry on, and deletes each page once it has copied it.
+   *
+   * Each page holds the number of its entries, followed by the entries.
+   */
+  class SortedRun {
+   public:
+    static constexpr size_t ENTRIES_PER_PAGE = (PAGE_SIZE - sizeof(uint32_t)) / sizeof(MappingType);
+
+    explicit SortedRun(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+    /** Deletes the pages that were not read. */
+    ~SortedRun();
+
+    DISALLOW_COPY_AND_MOVE(SortedRun);
+
+    /** Appends an entry, which is not less than the entries before it. */
+    void Append(const MappingType &entry);
+
+    /** Writes the entries that are not on a page yet. Entries are not appended once the run is finished. */
+    void Finish();
+
+    /** @return the next entry, valid until the next call, or nullptr once every entry has been read */
+    const MappingType *Next();
+
+   private:
+    /** Copies the entries of entries_ into a new page of the buffer pool, and clears them. */
+    void Flush();
+
+    BufferPoolManager *buffer_pool_manager_;
+    /** The entries of the page being filled, or of the page being read */
+    std::vector<MappingType> entries_;
+    /** The pages written to the buffer pool, in order */
+    std::vector<page_id_t> page_ids_;
+    /** The number of pages of page_ids_ that were read */
+    size_t num_read_pages_{0};
+    /** The position of the next entry to read in entries_ */
+    size_t read_pos_{0};
+  };
+
+  /** Merges sorted runs into a single sequence sorted by key and RID, with a heap of the next entry of each run. */
+  class RunMerger {
+   public:
+    RunMerger(const BPlusTreeIndex *index, std::vector<std::unique_ptr<SortedRun>> &&runs);
+
+    /**
+     * @param[out] entry the next entry
+     * @return false once every entry of the runs has been read
+     */
+    bool Next(MappingType *entry);
+
+   private:
+    /** The next entry of a run, and the index of the run */
+    using RunHead = std::pair<const MappingType *, size_t>;
+
+    std::vector<std::unique_ptr<SortedRun>> runs_;
+    std::function<bool(const RunHead &, const RunHead &)> greater_;
+    std::priority_queue<RunHead, std::vector<RunHead>, decltype(greater_)> heads_;
+  };
+
+  /** @return true if lhs orders before rhs, by key and then by RID */
+  bool EntryLess(const MappingType &lhs, const MappingType &rhs) const;
+
+  /** Sorts entries and writes them to a new run, leaving entries empty. */
+  std::unique_ptr<SortedRun> WriteRun(std::vector<MappingType> *entries);
 };
 
 }  // namespace bustub
@@ -13,9 +13,14 @@
 #pragma once
 
 #include <cstring>
+#include <string>
+#include <type_traits>
 
+#include "common/exception.h"
+#include "common/macros.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -25,42 +30,68 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * The columns of the key are stored one after the other in a binary encoding
+ * that preserves their order, so that two keys compare with a single memcmp
+ * (see GenericComparator):
+ * - integers are stored big-endian, with the sign bit flipped
+ * - timestamps are stored big-endian
+ * - decimals are stored big-endian, with the sign bit flipped if positive and
+ *   all bits flipped if negative
+ * - varchars are stored with each zero byte escaped as 0x00 0xFF and end with
+ *   0x00 0x01, so that a shorter string sorts before the strings it prefixes
+ * NULLs are stored as the NULL value of their type, and a NULL varchar as
+ * 0x00 0x00, which sorts before any string. The rest of the key is zero.
+ *
+ * Setting a key whose encoding does not fit in KeySize bytes throws an
+ * OUT_OF_RANGE exception.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      EncodeValue(tuple.GetValue(key_schema, i), &offset);
+    }
   }
 
   // NOTE: for test purpose only
+  // encode the key as a single BIGINT column, or as an INTEGER one if it does not fit
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    size_t offset = 0;
+    if constexpr (KeySize >= sizeof(int64_t)) {
+      EncodeSigned(key, &offset);
+    } else {
+      EncodeSigned(static_cast<int32_t>(key), &offset);
+    }
   }
 
   inline Value ToValue(Schema *schema, uint32_t column_idx) const {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+    // The columns before are skipped, since varchars do not have a fixed size.
+    size_t offset = 0;
+    for (uint32_t i = 0; i < column_idx; i++) {
+      DecodeValue(schema->GetColumn(i).GetType(), &offset);
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return DecodeValue(schema->GetColumn(column_idx).GetType(), &offset);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the key set by SetFromInteger
+  inline int64_t ToString() const {
+    size_t offset = 0;
+    if constexpr (KeySize >= sizeof(int64_t)) {
+      return DecodeSigned<int64_t>(&offset);
+    } else {
+      return DecodeSigned<int32_t>(&offset);
+    }
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // decode the key set by SetFromInteger
   friend std::ostream &operator<<(std::ostream &os, const GenericKey &key) {
     os << key.ToString();
     return os;
@@ -68,39 +99,165 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  inline void EncodeValue(const Value &value, size_t *offset) {
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        EncodeSigned(value.GetAs<int8_t>(), offset);
+        break;
+      case TypeId::SMALLINT:
+        EncodeSigned(value.GetAs<int16_t>(), offset);
+        break;
+      case TypeId::INTEGER:
+        EncodeSigned(value.GetAs<int32_t>(), offset);
+        break;
+      case TypeId::BIGINT:
+        EncodeSigned(value.GetAs<int64_t>(), offset);
+        break;
+      case TypeId::TIMESTAMP:
+        EncodeUnsigned(value.GetAs<uint64_t>(), offset);
+        break;
+      case TypeId::DECIMAL: {
+        // -0.0 and 0.0 are equal, and must be encoded alike.
+        double decimal = value.GetAs<double>() == 0 ? 0.0 : value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        EncodeUnsigned((bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63), offset);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        if (value.IsNull()) {
+          EncodeByte('\0', offset);
+          EncodeByte(VARCHAR_NULL, offset);
+          break;
+        }
+        const char *str = value.GetData();
+        // The length includes the terminating '\0'.
+        for (uint32_t i = 0; i + 1 < value.GetLength(); i++) {
+          EncodeByte(str[i], offset);
+          if (str[i] == '\0') {
+            EncodeByte(VARCHAR_ZERO, offset);
+          }
+        }
+        EncodeByte('\0', offset);
+        EncodeByte(VARCHAR_END, offset);
+        break;
+      }
+      default:
+        UNREACHABLE("cannot index a column of this type");
+    }
+  }
+
+  inline Value DecodeValue(TypeId type_id, size_t *offset) const {
+    switch (type_id) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return Value(type_id, DecodeSigned<int8_t>(offset));
+      case TypeId::SMALLINT:
+        return Value(type_id, DecodeSigned<int16_t>(offset));
+      case TypeId::INTEGER:
+        return Value(type_id, DecodeSigned<int32_t>(offset));
+      case TypeId::BIGINT:
+        return Value(type_id, DecodeSigned<int64_t>(offset));
+      case TypeId::TIMESTAMP:
+        return Value(type_id, DecodeUnsigned<uint64_t>(offset));
+      case TypeId::DECIMAL: {
+        uint64_t bits = DecodeUnsigned<uint64_t>(offset);
+        bits = (bits >> 63) != 0 ? bits & ~(uint64_t{1} << 63) : ~bits;
+        double decimal;
+        memcpy(&decimal, &bits, sizeof(decimal));
+        return Value(type_id, decimal);
+      }
+      case TypeId::VARCHAR: {
+        std::string str;
+        while (true) {
+          char c = DecodeByte(offset);
+          if (c != '\0') {
+            str.push_back(c);
+            continue;
+          }
+          char escape = DecodeByte(offset);
+          if (escape == VARCHAR_NULL && str.empty()) {
+            return ValueFactory::GetNullValueByType(type_id);
+          }
+          if (escape == VARCHAR_END) {
+            return Value(type_id, str);
+          }
+          str.push_back('\0');
+        }
+      }
+      default:
+        UNREACHABLE("cannot index a column of this type");
+    }
+  }
+
+  template <typename T>
+  inline void EncodeSigned(T value, size_t *offset) {
+    using U = std::make_unsigned_t<T>;
+    EncodeUnsigned(static_cast<U>(static_cast<U>(value) ^ (U{1} << (sizeof(U) * 8 - 1))), offset);
+  }
+
+  template <typename T>
+  inline T DecodeSigned(size_t *offset) const {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<T>(DecodeUnsigned<U>(offset) ^ (U{1} << (sizeof(U) * 8 - 1)));
+  }
+
+  template <typename U>
+  inline void EncodeUnsigned(U value, size_t *offset) {
+    for (size_t i = 0; i < sizeof(U); i++) {
+      EncodeByte(static_cast<char>(value >> ((sizeof(U) - 1 - i) * 8)), offset);
+    }
+  }
+
+  template <typename U>
+  inline U DecodeUnsigned(size_t *offset) const {
+    U value = 0;
+    for (size_t i = 0; i < sizeof(U); i++) {
+      value = static_cast<U>(value << 8) | static_cast<uint8_t>(DecodeByte(offset));
+    }
+    return value;
+  }
+
+  inline void EncodeByte(char byte, size_t *offset) {
+    if (*offset >= KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "the key does not fit in the generic key");
+    }
+    data_[(*offset)++] = byte;
+  }
+
+  inline char DecodeByte(size_t *offset) const {
+    if (*offset >= KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "the generic key ends in the middle of a value");
+    }
+    return data_[(*offset)++];
+  }
+
+  // the byte after a zero byte of a varchar: a NULL varchar, the end of the string, or a zero byte of the string
+  static constexpr char VARCHAR_NULL = '\x00';
+  static constexpr char VARCHAR_END = '\x01';
+  static constexpr char VARCHAR_ZERO = '\xFF';
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Generic keys are normalized when they are set, so they compare bytewise and
+ * the comparison neither deserializes values nor calls into the type system.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
-    }
-    // equals
-    return 0;
+    return memcmp(lhs.data_, rhs.data_, KeySize);
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  // the key schema is only needed to build the keys, see GenericKey::SetFromKey
+  GenericComparator() = default;
 
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
-
- private:
-  Schema *key_schema_;
+  GenericComparator(const GenericComparator &other) = default;
 };
 
 }  // namespace bustub
@@ -13,31 +13,131 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * IndexIterator walks the leaves of a B+ tree from left to right, up to an optional high key.
+ *
+ * It reads a leaf at a time: it copies the entries of the leaf that it returns into a batch under one read latch, and
+ * lets go of the latch right away, so that the caller may take its time with the batch. It keeps the leaf pinned, and
+ * remembers its version (see Page::GetVersion). Once the batch is used up, it latches the leaf again and goes on to
+ * the next leaf if no writer changed the leaf in the meantime, or looks up the last key it returned in the tree and
+ * goes on from there otherwise. Either way, it skips the keys it has already returned.
+ *
+ * In a tree with non-unique keys, the batch holds an entry per value of a key, and the key comes up once per value.
+ *
+ * Writers latch a leaf's left sibling while holding the leaf, so the iterator never waits for the next leaf while it
+ * holds the current one. If it cannot latch the next leaf right away, it lets go of the current leaf first, and
+ * resumes from the current leaf if a writer changed it in the meantime.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates the end iterator. */
   IndexIterator();
+
+  /**
+   * Creates an iterator positioned at an entry of a leaf.
+   * @param buffer_pool_manager the buffer pool of the tree
+   * @param tree the tree, to look up where to go on when a leaf changed; it must outlive the iterator
+   * @param page the leaf, pinned and read-latched; the iterator takes both over
+   * @param index the entry of the leaf, may be the size of the leaf to start at the next one
+   * @param comparator the comparator of the tree, which must outlive the iterator
+   * @param high_key the key to stop at, nullptr to go on to the last leaf
+   * @param high_inclusive whether the entry of the high key is returned
+   */
+  IndexIterator(BufferPoolManager *buffer_pool_manager, BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *page,
+                int index, const KeyComparator *comparator, const KeyType *high_key = nullptr,
+                bool high_inclusive = true);
   ~IndexIterator();  // NOLINT
 
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+  DISALLOW_COPY(IndexIterator);
+
   bool IsEnd();
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  /**
+   * Hand out the rest of the current batch at once and move on to the next one.
+   * @param[out] values the values of the entries not returned yet of the current leaf
+   * @return false if the iterator was at the end
+   */
+  bool NextBatch(std::vector<ValueType> *values);
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const {
+    if (page_ == nullptr || itr.page_ == nullptr) {
+      return page_ == itr.page_;
+    }
+    return page_ == itr.page_ && index_ == itr.index_;
+  }
+
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /**
+   * Copy the entries of the current leaf from the given one on into the batch, up to the high key, and unlatch the
+   * leaf. Move on to the following leaves while the batch comes out empty.
+   * @param index the first entry to copy
+   */
+  void LoadBatch(int index);
+
+  /** Load the batch of the leaf that follows the current batch, or become the end iterator. */
+  void MoveToNextBatch();
+
+  /**
+   * Move to the first entry of the following leaves whose key is greater than the given key, or to the end.
+   * The current leaf is read-latched, and so is the leaf moved to.
+   * @param last_key the last key returned
+   * @return the index of the entry moved to, or -1 at the end
+   */
+  int MoveToNextLeaf(const KeyType &last_key);
+
+  /**
+   * Look up the leaf of the given key in the tree, after the current leaf changed, and read-latch it.
+   * @return the index of the first entry of the leaf whose key is greater than the given key, or -1 at the end
+   */
+  int Seek(const KeyType &key);
+
+  /** @return the index of the first entry of the current leaf whose key is greater than the given key */
+  int UpperBound(const KeyType &key) const;
+
+  /** Unpin the current leaf, which is not latched, and become the end iterator. */
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  /** The current leaf, pinned; nullptr at the end. */
+  Page *page_{nullptr};
+  LeafPage *leaf_{nullptr};
+  /** The version of the current leaf when its batch was copied. */
+  uint64_t version_{0};
+  /** The entries of the current leaf that the iterator returns. */
+  std::vector<MappingType> batch_;
+  /** The position in the batch. */
+  size_t index_{0};
+  /** The last key of the current leaf that the batch covers. */
+  KeyType last_key_{};
+  /** Whether the batch stops at the high key, and it is the last one. */
+  bool last_batch_{false};
+  const KeyComparator *comparator_{nullptr};
+  bool has_high_key_{false};
+  KeyType high_key_{};
+  bool high_inclusive_{true};
 };
 
 }  // namespace bustub
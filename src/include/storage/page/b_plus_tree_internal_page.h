@@ -11,14 +11,18 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_SLOT_SIZE (sizeof(page_id_t) + 2 * sizeof(uint16_t))
+#define INTERNAL_PAGE_SIZE                                                                      \
+  (sizeof(KeyType) > 8 ? (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / INTERNAL_PAGE_SLOT_SIZE \
+                       : (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -27,13 +31,28 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
+ * Keys of up to 8 bytes are stored as they are (keys are stored in increasing order):
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Wider keys are stored truncated. Such keys must compare bytewise like GenericKey. The
+ * prefix that all the keys of the page share is stored once, and every key only stores
+ * the bytes after the prefix, without its trailing zero bytes. Each slot holds a child
+ * and the offset and length of its key's suffix; the first key is not stored at all:
+ *  ----------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | ... | SLOT(n) | PREFIX | SUFFIX(2) | SUFFIX(3) | ... | SUFFIX(n) |
+ *  ----------------------------------------------------------------------------------
+ * Together with the shortest separators that the tree pushes up (ShortestSeparator),
+ * a page holds many more keys than fixed size pairs would allow, so the number of
+ * entries is bounded by the bytes they take as well as by the max size.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
+  /** Whether the keys are stored truncated. */
+  static constexpr bool TRUNCATE_KEYS = sizeof(KeyType) > 8;
+  static constexpr size_t CAPACITY = PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE;
+
  public:
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
@@ -57,11 +76,45 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
- private:
+  // Bulk load utility method
   void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+
+  // Space utility methods, the page only runs out of bytes when its keys are truncated
+  bool CanInsert(const KeyType &key) const;
+  bool CanSetKeyAt(int index, const KeyType &key) const;
+  bool CanMoveAllTo(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const;
+  bool HasRoomForAnyKey() const;
+  bool IsHalfFull() const;
+  static bool Fits(const MappingType *items, int size);
+
+  static KeyType ShortestSeparator(const KeyType &left, const KeyType &right);
+
+ private:
+  /** The slot of a truncated key. */
+  struct Slot {
+    ValueType value_;
+    uint16_t offset_;
+    uint16_t length_;
+  };
+
+  std::vector<MappingType> Entries() const;
+  void SetEntries(const std::vector<MappingType> &entries);
+  static size_t EncodedSize(const MappingType *items, int size);
+  static size_t PrefixLength(const MappingType *items, int size);
+  static size_t TrimmedLength(const KeyType &key);
+  int SlotCount() const;
+  size_t StoredPrefixLength(int size) const;
+  int CompareSuffix(const char *key, size_t key_length, size_t prefix_length, const Slot &slot) const;
+  void Adopt(page_id_t child_page_id, BufferPoolManager *buffer_pool_manager);
+
+  MappingType *Array() { return reinterpret_cast<MappingType *>(data_); }
+  const MappingType *Array() const { return reinterpret_cast<const MappingType *>(data_); }
+  Slot *Slots() { return reinterpret_cast<Slot *>(data_); }
+  const Slot *Slots() const { return reinterpret_cast<const Slot *>(data_); }
+
+  // The length of the common prefix of the truncated keys.
+  uint32_t prefix_length_;
   // Flexible array member for page data.
-  MappingType array_[1];
+  alignas(MappingType) char data_[1];
 };
 }  // namespace bustub
@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search.h
+//
+// Identification: src/include/storage/page/b_plus_tree_key_search.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define BUSTUB_KEY_SEARCH_AVX2
+#endif
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * KeySearch searches the sorted key & value pairs of a B+ tree page. The pages
+ * call it for every lookup, so that the search can be specialized for the key
+ * type at compile time.
+ *
+ * This is the search for any key type: a binary search with the comparator.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class KeySearch {
+  using Pair = std::pair<KeyType, ValueType>;
+
+ public:
+  /** @return the first index in [low, high) whose key is not less than key, or high */
+  static int LowerBound(const Pair *array, int low, int high, const KeyType &key, const KeyComparator &comparator) {
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      if (comparator(array[mid].first, key) < 0) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  /** @return the first index in [low, high) whose key is greater than key, or high */
+  static int UpperBound(const Pair *array, int low, int high, const KeyType &key, const KeyComparator &comparator) {
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      if (comparator(array[mid].first, key) <= 0) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+};
+
+/**
+ * The search for generic keys of 4 and 8 bytes, such as the keys of a single
+ * integer column. Since generic keys compare with memcmp (see GenericKey), the
+ * whole key compares like a big-endian unsigned integer, so it is compared as
+ * one machine word after a byte swap.
+ *
+ * The search halves the range without branches until a few keys are left, and
+ * then counts the keys below the search key. On CPUs with AVX2, the keys of
+ * the last range are gathered into vector lanes and compared at once. The AVX2
+ * code is compiled for its own target and picked at runtime, so that the build
+ * needs no -mavx2 and still runs on older CPUs.
+ */
+template <size_t KeySize, typename ValueType>
+class IntegerKeySearch {
+  static_assert(KeySize == 4 || KeySize == 8, "only keys of 4 and 8 bytes are machine words");
+  using Word = std::conditional_t<KeySize == 8, uint64_t, uint32_t>;
+  using Pair = std::pair<GenericKey<KeySize>, ValueType>;
+  /** The number of keys left to the final scan. */
+  static constexpr int SCAN_SIZE = 8;
+
+ public:
+  static int LowerBound(const Pair *array, int low, int high, const GenericKey<KeySize> &key) {
+    return Search<false>(array, low, high, ToWord(key));
+  }
+
+  static int UpperBound(const Pair *array, int low, int high, const GenericKey<KeySize> &key) {
+    return Search<true>(array, low, high, ToWord(key));
+  }
+
+  static Word ToWord(const GenericKey<KeySize> &key) {
+    Word word;
+    memcpy(&word, key.data_, sizeof(Word));
+    if constexpr (KeySize == 8) {
+      return __builtin_bswap64(word);
+    } else {
+      return __builtin_bswap32(word);
+    }
+  }
+
+#if defined(BUSTUB_KEY_SEARCH_AVX2)
+  /** @return whether the CPU runs CountBelowAvx2 */
+  static bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+  }
+
+  /**
+   * Compare the keys of the next 32 / sizeof(Word) pairs to target. Only call it
+   * when HasAvx2() is true.
+   */
+  template <bool upper>
+  __attribute__((target("avx2"))) static int CountBelowAvx2(const Pair *array, Word target) {
+    constexpr int lanes = 32 / sizeof(Word);
+    const auto *base = reinterpret_cast<const char *>(array);
+    constexpr int stride = sizeof(Pair);
+    __m256i words;
+    __m256i targets;
+    __m256i swap;
+    // The words are unsigned, and AVX2 only compares signed integers.
+    __m256i sign;
+    if constexpr (KeySize == 8) {
+      words = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(base),  // NOLINT
+                                     _mm256_setr_epi64x(0, stride, 2 * stride, 3 * stride), 1);
+      swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13,
+                              12, 11, 10, 9, 8);
+      sign = _mm256_set1_epi64x(INT64_MIN);
+      targets = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(target)), sign);
+    } else {
+      words = _mm256_i32gather_epi32(reinterpret_cast<const int *>(base),
+                                     _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride,
+                                                       6 * stride, 7 * stride),
+                                     1);
+      swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9,
+                              8, 15, 14, 13, 12);
+      sign = _mm256_set1_epi32(INT32_MIN);
+      targets = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(target)), sign);
+    }
+    words = _mm256_xor_si256(_mm256_shuffle_epi8(words, swap), sign);
+    __m256i greater;
+    if constexpr (KeySize == 8) {
+      greater = upper ? _mm256_cmpgt_epi64(words, targets) : _mm256_cmpgt_epi64(targets, words);
+    } else {
+      greater = upper ? _mm256_cmpgt_epi32(words, targets) : _mm256_cmpgt_epi32(targets, words);
+    }
+    // Each lane of the mask is all ones or all zeros, count the bytes.
+    constexpr int word_size = sizeof(Word);
+    int matches = __builtin_popcount(_mm256_movemask_epi8(greater)) / word_size;
+    return upper ? lanes - matches : matches;
+  }
+#endif
+
+ private:
+  /** With upper, the first index whose key is greater than target, otherwise the first not less than target. */
+  template <bool upper>
+  static int Search(const Pair *array, int low, int high, Word target) {
+    // The index searched for is in [low, low + size].
+    int size = high - low;
+    while (size > SCAN_SIZE) {
+      int half = size / 2;
+      Word word = ToWord(array[low + half - 1].first);
+      low = (upper ? word <= target : word < target) ? low + half : low;
+      size -= half;
+    }
+    return low + CountBelow<upper>(array + low, size, target);
+  }
+
+  /** @return the number of keys less than target, or not greater than target with upper */
+  template <bool upper>
+  static int CountBelow(const Pair *array, int size, Word target) {
+    int count = 0;
+    int i = 0;
+#if defined(BUSTUB_KEY_SEARCH_AVX2)
+    constexpr int lanes = 32 / sizeof(Word);
+    if (size >= lanes && HasAvx2()) {
+      for (; i + lanes <= size; i += lanes) {
+        count += CountBelowAvx2<upper>(array + i, target);
+      }
+    }
+#endif
+    for (; i < size; i++) {
+      Word word = ToWord(array[i].first);
+      count += upper ? word <= target : word < target;
+    }
+    return count;
+  }
+};
+
+template <typename ValueType>
+class KeySearch<GenericKey<4>, ValueType, GenericComparator<4>> {
+  using Pair = std::pair<GenericKey<4>, ValueType>;
+
+ public:
+  static int LowerBound(const Pair *array, int low, int high, const GenericKey<4> &key,
+                        const GenericComparator<4> &comparator) {
+    return IntegerKeySearch<4, ValueType>::LowerBound(array, low, high, key);
+  }
+
+  static int UpperBound(const Pair *array, int low, int high, const GenericKey<4> &key,
+                        const GenericComparator<4> &comparator) {
+    return IntegerKeySearch<4, ValueType>::UpperBound(array, low, high, key);
+  }
+};
+
+template <typename ValueType>
+class KeySearch<GenericKey<8>, ValueType, GenericComparator<8>> {
+  using Pair = std::pair<GenericKey<8>, ValueType>;
+
+ public:
+  static int LowerBound(const Pair *array, int low, int high, const GenericKey<8> &key,
+                        const GenericComparator<8> &comparator) {
+    return IntegerKeySearch<8, ValueType>::LowerBound(array, low, high, key);
+  }
+
+  static int UpperBound(const Pair *array, int low, int high, const GenericKey<8> &key,
+                        const GenericComparator<8> &comparator) {
+    return IntegerKeySearch<8, ValueType>::UpperBound(array, low, high, key);
+  }
+};
+
+}  // namespace bustub
@@ -24,7 +24,9 @@ namespace bustub {
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within a page: in a tree with non-unique keys, the RID
+ * of a key with many RIDs points to their posting list instead (see
+ * BPlusTreePostingPage).
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
@@ -55,6 +57,7 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
+  bool SetValue(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
 
   // Split and Merge utility methods
@@ -63,8 +66,10 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
- private:
+  // Bulk load utility method
   void CopyNFrom(MappingType *items, int size);
+
+ private:
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define POSTING_PAGE_HEADER_SIZE 28
+
+/**
+ * A posting page holds the RIDs of a key of a B+ tree with non-unique keys. Once a key has more than one RID, the
+ * leaf entry of the key holds a list RID (see ListRid) that points to the first posting page of the key, instead of
+ * the RID itself. The RIDs of a key are sorted, and spread over a list of posting pages when they do not fit in one.
+ *
+ * The RIDs of a page are compressed: each one is stored as the difference of its page id to the page id of the RID
+ * before it, and its slot number, or the difference of its slot number to the one before it if the page ids are the
+ * same. Both are stored as variable length integers, so that the RIDs of a key that are close together in the table
+ * take 2 or 3 bytes each.
+ *
+ * A key with a few RIDs does not get a page of its own: as long as their compressed form fits in 7 bytes, they are
+ * kept in the leaf entry itself, as an inline list RID (see MakeList). Its slot number starts with 0xF and the number
+ * of RIDs, which no tuple's slot number does, and the other bytes hold the compressed RIDs.
+ *
+ * The posting pages of a key are read and written under the latch of the leaf that holds the key, so they are not
+ * latched themselves.
+ *
+ * Posting page format:
+ *  ---------------------------------------------------------------------------------------
+ * | NextPageId (4) | TailPageId (4) | Size (4) | TotalSize (4) | Used (4) | LastRid (8) |
+ *  ---------------------------------------------------------------------------------------
+ *  -------------------------------
+ * | RID(1) | RID(2) | ... | RID(n) |
+ *  -------------------------------
+ * The tail page id and the total size are only kept up to date in the first page of a list.
+ */
+class BPlusTreePostingPage {
+ public:
+  /** The slot number of a list RID, which no tuple has. */
+  static constexpr uint32_t LIST_SLOT = std::numeric_limits<uint32_t>::max();
+  /**
+   * The number of RIDs that an inline list RID holds at most: a compressed RID takes 2 bytes at least, one for the page
+   * id difference and one for the slot number, so no more than 3 fit in the 7 bytes of an inline list.
+   */
+  static constexpr int INLINE_MAX_SIZE = 3;
+
+  void Init(page_id_t page_id);
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  int GetSize() const { return size_; }
+
+  /**
+   * Append a RID after the last RID of this page.
+   * @return false if it does not fit
+   */
+  bool Append(const RID &rid);
+
+  /**
+   * Replace the RIDs of this page with as many of the given sorted RIDs as fit.
+   * @return the number of RIDs stored
+   */
+  int Encode(const RID *rids, int size);
+
+  /** Append the RIDs of this page to rids. */
+  void Decode(std::vector<RID> *rids) const;
+
+  // List utility methods
+  static RID ListRid(page_id_t page_id) { return RID(page_id, LIST_SLOT); }
+  static bool IsListRid(const RID &rid) { return rid.GetSlotNum() == LIST_SLOT; }
+  static bool IsInlineListRid(const RID &rid) { return (rid.GetSlotNum() >> 28) == 0xF && !IsListRid(rid); }
+
+  /**
+   * Make the leaf value of a key: the RID itself if there is one, an inline list RID if they fit, or the list RID of
+   * a new posting list.
+   * @param rids sorted, distinct RIDs
+   * @param size the number of RIDs, at least one
+   */
+  static RID MakeList(BufferPoolManager *buffer_pool_manager, const RID *rids, int size);
+
+  /**
+   * Make an inline list RID.
+   * @param rids sorted, distinct RIDs
+   * @param size the number of RIDs, at least two
+   * @param[out] list the inline list RID
+   * @return false if the RIDs do not fit
+   */
+  static bool MakeInlineList(const RID *rids, int size, RID *list);
+
+  /** Append the RIDs that a leaf value stands for to rids: the RID itself, or those of its list. */
+  static void ReadValues(BufferPoolManager *buffer_pool_manager, const RID &value, std::vector<RID> *rids);
+
+  /**
+   * Create the posting list of sorted, distinct RIDs, filling up its pages one after the other.
+   * @param size the number of RIDs, at least two
+   * @return the page id of the first page of the list
+   */
+  static page_id_t NewList(BufferPoolManager *buffer_pool_manager, const RID *rids, int size);
+
+  /**
+   * Insert a RID into a posting list.
+   * @return false if the list already holds the RID
+   */
+  static bool InsertIntoList(BufferPoolManager *buffer_pool_manager, page_id_t page_id, const RID &rid);
+
+  /**
+   * Remove a RID from a posting list.
+   * @param[out] remaining the number of RIDs left in the list
+   * @return false if the list does not hold the RID
+   */
+  static bool RemoveFromList(BufferPoolManager *buffer_pool_manager, page_id_t page_id, const RID &rid,
+                             int *remaining);
+
+  /** Append the RIDs of a posting list to rids. */
+  static void ReadList(BufferPoolManager *buffer_pool_manager, page_id_t page_id, std::vector<RID> *rids);
+
+  /** Delete the pages of a posting list. */
+  static void DeleteList(BufferPoolManager *buffer_pool_manager, page_id_t page_id);
+
+ private:
+  /** @return the number of bytes of the RID when it follows prev */
+  static int EncodedSize(const RID &prev, const RID &rid);
+  /** Write the RID after prev to out, and return the end of it. */
+  static uint8_t *EncodeRid(const RID &prev, const RID &rid, uint8_t *out);
+  /** Read the RID after prev from in into rid, and return the end of it. */
+  static const uint8_t *DecodeRid(const RID &prev, const uint8_t *in, RID *rid);
+  static Page *FetchPage(BufferPoolManager *buffer_pool_manager, page_id_t page_id);
+  static BPlusTreePostingPage *NewPage(BufferPoolManager *buffer_pool_manager, page_id_t *page_id);
+
+  static constexpr size_t CAPACITY = PAGE_SIZE - POSTING_PAGE_HEADER_SIZE;
+  /** The bytes of compressed RIDs that an inline list RID holds. */
+  static constexpr int INLINE_CAPACITY = 7;
+
+  page_id_t next_page_id_;
+  page_id_t tail_page_id_;
+  int size_;
+  int total_size_;
+  uint32_t used_;
+  RID last_rid_;
+  // Flexible array member for page data.
+  uint8_t data_[1];
+};
+
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A free space map (FSM) page records, for a run of table pages, how much free space each of them has left. The
+ * amount of free space is stored as a one byte category (see FreeSpaceMap), so a single FSM page covers several
+ * hundred table pages. FSM pages of one table heap are chained together through NextPageId.
+ *
+ * Only the first FSM page of a chain uses the LastHeapPageId field; it remembers the tail of the table page list so
+ * that the heap can be extended without walking it.
+ *
+ *  Header format (size in bytes):
+ *  -----------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | EntryCount (4) | LastHeapPageId (4) |
+ *  -----------------------------------------------------------------------------------
+ *  -------------------------------------------------------------------------------
+ *  | HeapPageId_1 (4) | ... | HeapPageId_n (4) | Category_1 (1) | ... | Category_n (1) |
+ *  -------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** The maximum number of table pages that one FSM page can describe. */
+  static constexpr uint32_t MAX_ENTRIES = (PAGE_SIZE - 20) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  /**
+   * Initialize the FSM page header.
+   * @param page_id the page ID of this FSM page
+   */
+  void Init(page_id_t page_id);
+
+  /** @return the page ID of this FSM page */
+  page_id_t GetFsmPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the next FSM page in the chain */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next FSM page in the chain. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the id of the last page of the table heap (only meaningful on the first FSM page) */
+  page_id_t GetLastHeapPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_LAST_HEAP_PAGE_ID); }
+
+  /** Set the id of the last page of the table heap. */
+  void SetLastHeapPageId(page_id_t last_page_id) {
+    memcpy(GetData() + OFFSET_LAST_HEAP_PAGE_ID, &last_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table pages described by this FSM page */
+  uint32_t GetEntryCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return true if no more table pages can be added to this FSM page */
+  bool IsFull() { return GetEntryCount() >= MAX_ENTRIES; }
+
+  /**
+   * Add a table page to this FSM page.
+   * @param heap_page_id the id of the table page
+   * @param category the free space category of the table page
+   * @param[out] slot the slot the table page was stored in
+   * @return false if this FSM page is full, true otherwise
+   */
+  bool AppendEntry(page_id_t heap_page_id, uint8_t category, uint32_t *slot);
+
+  /** @return the id of the table page stored at slot */
+  page_id_t GetHeapPageId(uint32_t slot) {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_HEAP_PAGE_IDS + sizeof(page_id_t) * slot);
+  }
+
+  /** @return the free space category of the table page stored at slot */
+  uint8_t GetCategory(uint32_t slot) {
+    return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_CATEGORIES + sizeof(uint8_t) * slot);
+  }
+
+  /** Set the free space category of the table page stored at slot. */
+  void SetCategory(uint32_t slot, uint8_t category) {
+    memcpy(GetData() + OFFSET_CATEGORIES + sizeof(uint8_t) * slot, &category, sizeof(uint8_t));
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 12;
+  static constexpr size_t OFFSET_LAST_HEAP_PAGE_ID = 16;
+  static constexpr size_t OFFSET_HEAP_PAGE_IDS = 20;
+  static constexpr size_t OFFSET_CATEGORIES = OFFSET_HEAP_PAGE_IDS + sizeof(page_id_t) * MAX_ENTRIES;
+
+  /** Set the number of table pages described by this FSM page. */
+  void SetEntryCount(uint32_t entry_count) {
+    memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t));
+  }
+};
+
+}  // namespace bustub
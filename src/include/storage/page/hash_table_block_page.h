@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <atomic>
 #include <utility>
 #include <vector>
 
@@ -25,13 +24,27 @@ namespace bustub {
  * Store indexed key and and value together within block page. Supports
  * non-unique keys.
  *
- * Block page format (keys are stored in order):
+ * A block page is an open addressing hash table of its own, in the layout of
+ * a Swiss table: the slots are probed in groups of BLOCK_GROUP_SIZE, and each
+ * slot has a control byte, which is EMPTY, DELETED (a tombstone), or the low
+ * 7 bits of the hash of its key. A probe compares the control bytes of a whole
+ * group to those 7 bits at once, compares only the keys of the slots that
+ * match, and stops at the first group with an EMPTY slot.
+ *
+ * Block page format:
+ *  ---------------------------------------------------------------------------
+ * | NumReadable (2) | NumOccupied (2) | CONTROL(1) | ... | CONTROL(n) |
+ *  ---------------------------------------------------------------------------
  *  ----------------------------------------------------------------
  * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
  *  ----------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
+ * A removed slot is only marked DELETED when its group has no EMPTY slot,
+ * since a probe that reaches a group with an EMPTY slot never goes past it.
+ * The table rehashes a page once it runs out of EMPTY slots, which drops its
+ * tombstones.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -39,6 +52,9 @@ class HashTableBlockPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBlockPage() = delete;
 
+  /** Marks all the slots of a new block page EMPTY. */
+  void Init();
+
   /**
    * Gets the key at an index in the block.
    *
@@ -55,28 +71,6 @@ class HashTableBlockPage {
    */
   ValueType ValueAt(slot_offset_t bucket_ind) const;
 
-  /**
-   * Attempts to insert a key and value into an index in the block.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
-   *
-   * @param bucket_ind index to write the key and value to
-   * @param key key to insert
-   * @param value value to insert
-   * @return If the value is inserted successfully, it returns true. If the
-   * index is marked as occupied before the key and value can be inserted,
-   * Insert returns false.
-   */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
-
-  /**
-   * Removes a key and value at index.
-   *
-   * @param bucket_ind ind to remove the value
-   */
-  void Remove(slot_offset_t bucket_ind);
-
   /**
    * Returns whether or not an index is occupied (key/value pair or tombstone)
    *
@@ -94,44 +88,51 @@ class HashTableBlockPage {
   bool IsReadable(slot_offset_t bucket_ind) const;
 
   /**
-   * Scan the bucket and collect values that have the matching key
+   * Probe the block from the group of the hash and collect values that have the matching key
    *
+   * @param hash the hash of the key
    * @return true if at least one key matched
    */
-  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result);
+  bool GetValue(const KeyType &key, uint64_t hash, KeyComparator cmp, std::vector<ValueType> *result);
 
   /**
-   * Attempts to insert a key and value in the bucket.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * Inserts a key and value in the first slot on the probe of the hash that is not readable. The block must not be
+   * full.
    *
    * @param key key to insert
    * @param value value to insert
-   * @return true if inserted, false if duplicate KV pair or bucket is full
+   * @param hash the hash of the key
+   * @return true if inserted, false if duplicate KV pair
    */
-  bool Insert(KeyType key, ValueType value, KeyComparator cmp);
+  bool Insert(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp);
 
   /**
    * Removes a key and value.
+   * @param hash the hash of the key
    * @return true if removed, false if not found
    */
-  bool Remove(KeyType key, ValueType value, KeyComparator cmp);
+  bool Remove(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp);
 
   /**
    * @return the number of readable elements, i.e. current size
    */
-  uint32_t NumReadable();
+  uint32_t NumReadable() const { return num_readable_; }
 
   /**
-   * @return whether the bucket is full
+   * @return the number of occupied slots, readable slots and tombstones
    */
-  bool IsFull();
+  uint32_t NumOccupied() const { return num_occupied_; }
+
+  /**
+   * A block is full once 7/8 of its slots are occupied, so that probes end soon.
+   * @return whether the block is full
+   */
+  bool IsFull() const { return num_occupied_ >= BLOCK_ARRAY_SIZE / 8 * 7; }
 
   /**
    * @return whether the bucket is empty
    */
-  bool IsEmpty();
+  bool IsEmpty() const { return num_readable_ == 0; }
 
   /**
    * Prints the bucket's occupancy information
@@ -139,10 +140,25 @@ class HashTableBlockPage {
   void PrintBucket();
 
  private:
-  std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
-
-  // 0 if tombstone/brand new (never occupied), 1 otherwise.
-  std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  static constexpr int8_t EMPTY = -128;
+  static constexpr int8_t DELETED = -2;
+  static constexpr uint32_t NUM_GROUPS = BLOCK_ARRAY_SIZE / BLOCK_GROUP_SIZE;
+
+  /** @return the control byte of a readable slot whose key has the hash */
+  static int8_t ControlByte(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+  /** @return the group a probe for the hash starts from */
+  static uint32_t StartGroup(uint64_t hash) { return (hash >> 7) % NUM_GROUPS; }
+
+  /** @return a mask of the slots of the group whose control byte is control */
+  uint32_t MatchGroup(uint32_t group_idx, int8_t control) const;
+  /** @return a mask of the slots of the group that are EMPTY or DELETED, whose control bytes are negative */
+  uint32_t MatchFree(uint32_t group_idx) const;
+  /** @return a mask of the EMPTY slots of the group */
+  uint32_t MatchEmpty(uint32_t group_idx) const { return MatchGroup(group_idx, EMPTY); }
+
+  uint16_t num_readable_;
+  uint16_t num_occupied_;
+  int8_t control_[BLOCK_ARRAY_SIZE];
   // Flexible array member for page data.
   MappingType array_[1];
 };
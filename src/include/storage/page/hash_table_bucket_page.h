@@ -31,8 +31,15 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  readable_ arrays, and for the fingerprints_ array, which holds a byte of a
+ *  hash of the key of each slot. More information is in
+ *  storage/page/hash_table_page_defs.h.
  *
+ *  Lookups compare the fingerprint of the key to 32 slots at a time, and only
+ *  compare the keys of the readable slots whose fingerprint matches. Keys that
+ *  compare equal must have the same bytes, as generic keys do, since the
+ *  fingerprint is a hash of the bytes of the key. The bitmaps are read 64 bits
+ *  at a time to count and find slots.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -138,10 +145,26 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /** @return a byte of a hash of the bytes of the key, which is independent of the bits of the bucket index */
+  static uint8_t Fingerprint(const KeyType &key);
+
+  /** @return the 64 bits of a bitmap from slot 64 * word_idx on, with zeros past the end of the bucket */
+  static uint64_t BitmapWord(const char *bitmap, uint32_t word_idx);
+
+  /**
+   * @return a mask of the readable slots among the 32 from slot 32 * group_idx on whose fingerprint is the given one
+   */
+  uint32_t MatchGroup(uint32_t group_idx, uint8_t fingerprint) const;
+
+  /** @return the first slot that is not readable, or BUCKET_ARRAY_SIZE if the bucket is full */
+  uint32_t FirstFreeSlot() const;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // The fingerprint of the key of each occupied slot.
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   MappingType array_[1];
 };
 
@@ -26,6 +26,11 @@ namespace bustub {
  *
  * Directory Page for extendible hash table.
  *
+ * A directory page holds DIRECTORY_ARRAY_SIZE entries of the directory, and the
+ * root directory page (see HashTableDirectoryRootPage) holds the directory
+ * pages. The global depth of a directory page is that of the directory, up to
+ * DIRECTORY_PAGE_DEPTH, and the directory pages are copied once it is deeper.
+ *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
  * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
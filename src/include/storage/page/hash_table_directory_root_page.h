@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_root_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_root_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Root Directory Page for extendible hash table.
+ *
+ * The directory of an extendible hash table spans as many directory pages as
+ * it takes: directory index i is entry i % DIRECTORY_ARRAY_SIZE of directory
+ * page i / DIRECTORY_ARRAY_SIZE. The root page holds the global depth and the
+ * page ids of the directory pages, in order.
+ *
+ * Root format (size in byte):
+ * --------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | DirectoryPageIds(2048) | Free(2036)
+ * --------------------------------------------------------------------------
+ */
+class HashTableDirectoryRootPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id to which to set the page_id_ field
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number to which to set the lsn field
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * Sets the global depth of the directory
+   *
+   * @param global_depth the new global depth
+   */
+  void SetGlobalDepth(uint32_t global_depth);
+
+  /**
+   * @return the number of directory pages that the global depth takes
+   */
+  uint32_t NumDirectoryPages() const;
+
+  /**
+   * @param directory_page_idx the index of the directory page
+   * @return the page_id of the directory page
+   */
+  page_id_t GetDirectoryPageId(uint32_t directory_page_idx) const;
+
+  /**
+   * Sets the page_id of a directory page
+   *
+   * @param directory_page_idx the index of the directory page
+   * @param directory_page_id the page_id of the directory page
+   */
+  void SetDirectoryPageId(uint32_t directory_page_idx, page_id_t directory_page_id);
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  page_id_t directory_page_ids_[DIRECTORY_ROOT_ARRAY_SIZE];
+};
+
+}  // namespace bustub
@@ -22,6 +22,9 @@
 
 namespace bustub {
 
+/** The number of block page ids that fit in the header page, after its 16 bytes of fields. */
+#define HEADER_ARRAY_SIZE ((PAGE_SIZE - 16) / sizeof(page_id_t))
+
 /**
  *
  * Header Page for linear probing hash table.
@@ -89,13 +92,17 @@ class HashTableHeaderPage {
    */
   size_t NumBlocks();
 
+  /**
+   * Removes all the block page_ids from the header page
+   */
+  void ClearBlockPageIds();
+
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  lsn_t lsn_;
+  uint32_t size_;
+  page_id_t page_id_;
+  uint32_t next_ind_;
+  page_id_t block_page_ids_[HEADER_ARRAY_SIZE];
 };
 
 }  // namespace bustub
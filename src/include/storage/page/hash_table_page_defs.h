@@ -20,13 +20,12 @@
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
 
 /**
- * BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a linear probe hash block page. It is an
- * approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each
- * key/value pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) +
- * 1) = PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the
- * occupied and readable flags for a key value pair.
+ * The slots of a linear probe hash block page are probed in groups of BLOCK_GROUP_SIZE, with one SSE2 compare of
+ * their control bytes. BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a block page: as
+ * many groups as fit in the page after its 4 byte header, with a control byte for each key/value pair.
  */
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_GROUP_SIZE 16
+#define BLOCK_ARRAY_SIZE ((PAGE_SIZE - 4) / (sizeof(MappingType) + 1) / BLOCK_GROUP_SIZE * BLOCK_GROUP_SIZE)
 
 /**
  * Extendible Hashing Definitions
@@ -34,11 +33,19 @@
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
 
+/**
+ * A directory page resolves DIRECTORY_PAGE_DEPTH bits of the hash, and the root directory page holds up to
+ * DIRECTORY_ROOT_ARRAY_SIZE directory pages, which makes for a global depth of up to MAX_GLOBAL_DEPTH bits.
+ */
+#define DIRECTORY_PAGE_DEPTH 9
+#define DIRECTORY_ROOT_ARRAY_SIZE 512
+#define MAX_GLOBAL_DEPTH (DIRECTORY_PAGE_DEPTH + 9)
+
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_, and a byte for its fingerprint.
+ * 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 5) = PAGE_SIZE/(sizeof (MappingType) + 1.25) because 1.25 bytes = 10
+ * bits is the space required to maintain the occupied and readable flags and the fingerprint of a key value pair.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 5))
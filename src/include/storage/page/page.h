@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -40,26 +41,52 @@ class Page {
   inline char *GetData() { return data_; }
 
   /** @return the page id of this page */
-  inline page_id_t GetPageId() { return page_id_; }
+  inline page_id_t GetPageId() { return page_id_.load(std::memory_order_acquire); }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return pin_count_.load(std::memory_order_acquire); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
-  inline bool IsDirty() { return is_dirty_; }
+  inline bool IsDirty() { return is_dirty_.load(std::memory_order_acquire); }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version becomes odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Try to acquire the page read latch without waiting. @return true if it was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Optimistic readers read the page without latching it: they remember the version before reading and check that it
+   * is unchanged afterwards, see ValidateVersion.
+   * @return the version of the page, odd while a writer holds the write latch
+   */
+  inline uint64_t GetVersion() { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * @param version a version returned by GetVersion
+   * @return true if nobody has write-latched the page since the version was read
+   */
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,16 +105,21 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The actual data that is stored within a page. Aligned so that frames can be read and written with O_DIRECT. */
+  alignas(DISK_IO_ALIGNMENT) char data_[PAGE_SIZE]{};
+  /**
+   * The ID of this page. The buffer pool manager only changes it while the frame is being evicted, which lets the
+   * lock-free fetch path check that the frame it pinned still holds the page it looked up.
+   */
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
+  /** The pin count of this page. Negative while the buffer pool manager is evicting the page. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped when the write latch is acquired and when it is released. */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
@@ -1,15 +1,13 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
  * TmpTuplePage format:
  *
@@ -17,20 +15,71 @@ namespace bustub {
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ *
+ * A TmpTuplePage holds the tuples that an operator writes out of memory for itself, such as the partitions of a hash
+ * join that spill (see SpillFile). The tuples are never updated or deleted, so the page needs no slot array: FreeSpace
+ * points to the last tuple inserted, and the tuples follow each other up to the end of the page.
  */
 class TmpTuplePage : public Page {
  public:
+  /**
+   * Initialize the TmpTuplePage header.
+   * @param page_id the page ID of this page
+   * @param page_size the size of this page
+   */
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    SetFreeSpacePointer(page_size);
   }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /** @return the page ID of this page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /** Sets the page ID of this page, for a page that was filled before it had one. */
+  void SetTablePageId(page_id_t page_id) { memcpy(GetData(), &page_id, sizeof(page_id_t)); }
+
+  /** @return the offset of the last tuple inserted, which is the end of the page if there is none */
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /**
+   * Insert a tuple into the page.
+   * @param tuple the tuple to insert
+   * @param[out] out the location of the tuple
+   * @return false if the page has no room for the tuple
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    uint32_t free_space_pointer = GetFreeSpacePointer();
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    if (free_space_pointer < SIZE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
+
+  /**
+   * Read a tuple of the page.
+   * @param offset the offset of the tuple, from its TmpTuple
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple inserted before it, which is the end of the page for the first one
+   */
+  uint32_t Get(uint32_t offset, Tuple *tuple) {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_FREE_SPACE = sizeof(page_id_t) + sizeof(lsn_t);
+  static constexpr size_t SIZE_HEADER = OFFSET_FREE_SPACE + sizeof(uint32_t);
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap keeps track of how much free space every page of a TableHeap has, so that an insert can go straight
+ * to a page that is large enough instead of walking the page list.
+ *
+ * Free space is tracked in categories of FSM_CATEGORY_SIZE bytes: a page in category c has at least
+ * c * FSM_CATEGORY_SIZE free bytes. The categories are persisted in a chain of FreeSpaceMapPages, and are kept in
+ * memory as one bucket of pages per category together with a bitmap of the non-empty buckets, which makes finding a
+ * page a constant time operation.
+ *
+ * The map is a hint: it is not logged, and callers must still check that the page they were handed has enough room
+ * (and report back the real amount of free space if it does not).
+ */
+class FreeSpaceMap {
+ public:
+  /** Number of free space categories. */
+  static constexpr uint32_t FSM_NUM_CATEGORIES = 64;
+  /** Number of bytes covered by one free space category. */
+  static constexpr uint32_t FSM_CATEGORY_SIZE = PAGE_SIZE / FSM_NUM_CATEGORIES;
+
+  /**
+   * Create a new, empty free space map.
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager);
+
+  /**
+   * Open an existing free space map and load it into memory.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param root_page_id the id of the first FSM page, must be valid
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id);
+
+  ~FreeSpaceMap() = default;
+
+  /** @return the id of the first FSM page, which is how the map is found again after a restart */
+  page_id_t GetRootPageId() const { return root_page_id_; }
+
+  /**
+   * Find a table page with at least required_bytes of free space.
+   * @param required_bytes the number of free bytes needed
+   * @return the id of such a page, INVALID_PAGE_ID if no page is known to have enough space
+   */
+  page_id_t FindPage(uint32_t required_bytes);
+
+  /**
+   * Record the amount of free space that a page of the table has left.
+   * @param heap_page_id the id of the table page
+   * @param free_bytes the number of free bytes in the table page
+   */
+  void UpdatePage(page_id_t heap_page_id, uint32_t free_bytes);
+
+  /**
+   * Record a page that was appended to the end of the table.
+   * @param heap_page_id the id of the new last table page
+   * @param free_bytes the number of free bytes in the table page
+   */
+  void AppendPage(page_id_t heap_page_id, uint32_t free_bytes);
+
+  /** @return the id of the first page of the table */
+  page_id_t GetFirstPageId();
+
+  /** @return the id of the last page of the table */
+  page_id_t GetLastPageId();
+
+  /** @return the number of table pages tracked by the map */
+  size_t GetNumPages();
+
+  /**
+   * Look up the pages that follow a page in the table's page chain, e.g. to read them ahead of a scan.
+   * @param heap_page_id a page of the table
+   * @param max_pages the maximum number of pages to return
+   * @param[out] page_ids the pages following heap_page_id, in chain order
+   */
+  void GetPagesAfter(page_id_t heap_page_id, size_t max_pages, std::vector<page_id_t> *page_ids);
+
+  /** @param[out] page_ids every page of the table, in chain order */
+  void GetPageIds(std::vector<page_id_t> *page_ids);
+
+  /** @return the free space category that free_bytes falls into */
+  static uint8_t ToCategory(uint32_t free_bytes) {
+    return static_cast<uint8_t>(std::min(free_bytes / FSM_CATEGORY_SIZE, FSM_NUM_CATEGORIES - 1));
+  }
+
+ private:
+  /** Where a table page lives in the FSM pages and in the in-memory buckets. */
+  struct Entry {
+    /** Index of the FSM page (in fsm_page_ids_) holding the entry. */
+    size_t fsm_index_;
+    /** Slot of the entry within its FSM page. */
+    uint32_t slot_;
+    /** Current free space category. */
+    uint8_t category_;
+    /** Position of the page in buckets_[category_]. */
+    size_t bucket_pos_;
+    /** Position of the page in heap_page_ids_. */
+    size_t chain_pos_;
+  };
+
+  /** Add a page to the bucket of its category. Caller holds latch_. */
+  void BucketInsert(page_id_t heap_page_id, Entry *entry);
+
+  /** Remove a page from the bucket of its category. Caller holds latch_. */
+  void BucketRemove(const Entry &entry);
+
+  /** Persist a new entry in the last FSM page, growing the chain if necessary. Caller holds latch_. */
+  void AddEntry(page_id_t heap_page_id, uint8_t category);
+
+  /** Fetch an FSM page, throwing if the buffer pool is out of frames. */
+  FreeSpaceMapPage *FetchFsmPage(page_id_t page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  /** The first page of the FSM chain. */
+  page_id_t root_page_id_;
+  /** Every page of the FSM chain, in chain order. */
+  std::vector<page_id_t> fsm_page_ids_;
+  /** The last page of the table heap. */
+  page_id_t last_heap_page_id_{INVALID_PAGE_ID};
+  /** Every table page, in the order they were appended to the table, which is the order of the page chain. */
+  std::vector<page_id_t> heap_page_ids_;
+  /** Table page id -> location of its entry. */
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** Table pages grouped by free space category. */
+  std::vector<std::vector<page_id_t>> buckets_;
+  /** Bit c is set iff buckets_[c] is not empty. */
+  uint64_t non_empty_buckets_{0};
+  /** Protects all of the in-memory state above and the FSM pages. */
+  std::mutex latch_;
+
+  static_assert(FSM_NUM_CATEGORIES <= 64, "non_empty_buckets_ holds one bit per category");
+};
+
+}  // namespace bustub
@@ -12,9 +12,14 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -22,7 +27,7 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, plus a free space map that is used to pick the page for an insert.
  */
 class TableHeap {
   friend class TableIterator;
@@ -35,10 +40,12 @@ class TableHeap {
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
-   * @param first_page_id the id of the first page
+   * @param first_page_id the id of the first page, INVALID_PAGE_ID to take it from the free space map
+   * @param fsm_page_id the root of the table's free space map as GetFreeSpaceMap()->GetRootPageId() reported it,
+   * INVALID_PAGE_ID to rebuild the map from the page list
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, page_id_t fsm_page_id = INVALID_PAGE_ID);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -55,9 +62,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the buffer ring of a bulk load, nullptr for none
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -99,20 +107,80 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * Read many tuples from the table. RIDs of the same page that follow each other are read with one fetch of the page,
+   * so sorting them by page first reads each page once.
+   * @param rids rids of the tuples to read
+   * @param[out] tuples the tuples that exist, in the order of the rids
+   * @param txn transaction performing the read
+   * @return false if a page could not be fetched, in which case the transaction is aborted
+   */
+  bool GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn);
+
+  /**
+   * Read all the tuples of a page with one fetch of the page, for a scan that claims pages rather than following the
+   * page chain.
+   * @param page_id a page of the table
+   * @param[out] tuples the tuples of the page, in slot order
+   * @param txn transaction performing the read
+   * @param strategy the buffer ring of the scan, nullptr for none
+   * @return false if the page could not be fetched
+   */
+  bool GetPageTuples(page_id_t page_id, std::vector<Tuple> *tuples, Transaction *txn,
+                     BufferAccessStrategy *strategy = nullptr);
+
+  /** @param[out] page_ids every page of this table, in the order of the page chain */
+  void GetPageIds(std::vector<page_id_t> *page_ids) { fsm_->GetPageIds(page_ids); }
+
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the buffer ring of the scan, nullptr for none
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
 
+  /**
+   * A full scan of a table that takes up more than a quarter of the buffer pool should go through a buffer ring, so
+   * that it does not flush the pool. Smaller tables are better off staying cached.
+   * @return true if a full scan of this table should use a BufferAccessStrategy
+   */
+  bool ScanNeedsBufferRing();
+
+  /**
+   * Start reading the pages that follow a page of the table into the buffer pool, so that a scan finds them cached.
+   * @param page_id a page of the table
+   * @param strategy the buffer ring of the scan, nullptr for none
+   * @param num_pages the number of following pages to read ahead
+   */
+  void Prefetch(page_id_t page_id, BufferAccessStrategy *strategy, size_t num_pages = READ_AHEAD_PAGES);
+
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the free space map of this table */
+  inline FreeSpaceMap *GetFreeSpaceMap() { return fsm_.get(); }
+
  private:
+  /**
+   * Append a new page to the end of the table, unless another thread has already made room for the tuple.
+   * @param required_bytes the space needed by the tuple that did not fit
+   * @param txn the transaction performing the insert
+   * @param strategy the buffer ring of the insert, nullptr for none
+   * @return the id of a page with room for the tuple, INVALID_PAGE_ID if the buffer pool could not create a new page
+   */
+  page_id_t ExtendTable(uint32_t required_bytes, Transaction *txn, BufferAccessStrategy *strategy);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Tracks the free space of every page in the table. */
+  std::unique_ptr<FreeSpaceMap> fsm_;
+  /** Serializes threads that append pages to the end of the table. */
+  std::mutex extend_latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_backend.cpp
+//
+// Identification: src/storage/disk/disk_backend.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_backend.h"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "common/logger.h"
+#include "storage/disk/io_uring_disk_backend.h"
+#include "storage/disk/posix_disk_backend.h"
+
+namespace bustub {
+
+std::unique_ptr<DiskBackend> DiskBackend::Create(DiskBackendType type, int fd) {
+  if (type == DiskBackendType::IO_URING) {
+    auto backend = std::make_unique<IoUringDiskBackend>(fd);
+    if (backend->IsValid()) {
+      return backend;
+    }
+    LOG_WARN("io_uring is not available, falling back to pread/pwrite");
+  }
+  return std::make_unique<PosixDiskBackend>(fd);
+}
+
+bool DiskBackend::ReadPageAt(int fd, page_id_t page_id, char *page_data) {
+  auto offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    auto rc = pread(fd, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return false;
+    }
+    if (rc == 0) {
+      // The file ends before the page does.
+      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      break;
+    }
+    read_count += rc;
+  }
+  return true;
+}
+
+bool DiskBackend::WritePageAt(int fd, page_id_t page_id, const char *page_data) {
+  auto offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    auto rc = pwrite(fd, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    write_count += rc;
+  }
+  return true;
+}
+
+}  // namespace bustub
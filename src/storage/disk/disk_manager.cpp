@@ -10,28 +10,34 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
 #include <string>
-#include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** @return true if a buffer can be handed to the kernel as is when the file is opened with O_DIRECT */
+static bool IsAligned(const char *buffer) { return reinterpret_cast<uintptr_t>(buffer) % DISK_IO_ALIGNMENT == 0; }
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, DiskBackendType backend_type, bool direct_io)
+    : file_name_(db_file), num_flushes_(0), num_reads_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -53,30 +59,40 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("O_DIRECT is not supported for %s, using buffered I/O", db_file.c_str());
     }
+    direct_io_ = db_fd_ >= 0;
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
   }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  backend_ = DiskBackend::Create(backend_type, db_fd_);
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    ShutDown();
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  std::unique_lock db_fd_latch(db_fd_latch_);
+  if (backend_ != nullptr) {
+    backend_->ShutDown();
+  }
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
   }
   log_io_.close();
 }
@@ -85,48 +101,76 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+  std::shared_lock db_fd_latch(db_fd_latch_);
+  if (db_fd_ < 0) {
+    LOG_DEBUG("Write after shut down");
+    return;
+  }
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (direct_io_ && !IsAligned(page_data)) {
+    // O_DIRECT needs an aligned buffer, bounce through one.
+    auto bounce = static_cast<char *>(std::aligned_alloc(DISK_IO_ALIGNMENT, PAGE_SIZE));
+    memcpy(bounce, page_data, PAGE_SIZE);
+    DiskBackend::WritePageAt(db_fd_, page_id, bounce);
+    std::free(bounce);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  DiskBackend::WritePageAt(db_fd_, page_id, page_data);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+  std::shared_lock db_fd_latch(db_fd_latch_);
+  if (db_fd_ < 0) {
+    LOG_DEBUG("Read after shut down");
+    return;
+  }
+  num_reads_ += 1;
+  if (direct_io_ && !IsAligned(page_data)) {
+    auto bounce = static_cast<char *>(std::aligned_alloc(DISK_IO_ALIGNMENT, PAGE_SIZE));
+    if (DiskBackend::ReadPageAt(db_fd_, page_id, bounce)) {
+      memcpy(page_data, bounce, PAGE_SIZE);
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    std::free(bounce);
+    return;
+  }
+  DiskBackend::ReadPageAt(db_fd_, page_id, page_data);
+}
+
+/**
+ * Start a batch of asynchronous page reads and writes
+ */
+void DiskManager::SubmitRequests(DiskRequest *requests, size_t num_requests) {
+  std::shared_lock db_fd_latch(db_fd_latch_);
+  if (db_fd_ < 0) {
+    LOG_DEBUG("I/O after shut down");
+    for (size_t i = 0; i < num_requests; i++) {
+      requests[i].callback_.set_value(false);
+    }
+    return;
+  }
+  for (size_t i = 0; i < num_requests; i++) {
+    BUSTUB_ASSERT(!direct_io_ || IsAligned(requests[i].data_), "Direct I/O needs aligned buffers.");
+    if (requests[i].is_write_) {
+      num_writes_ += 1;
+    } else {
+      num_reads_ += 1;
     }
   }
+  backend_->Submit(requests, num_requests);
+}
+
+/**
+ * Block until every request of a batch has completed
+ */
+bool DiskManager::WaitForRequests(DiskRequest *requests, size_t num_requests) {
+  bool ok = true;
+  for (size_t i = 0; i < num_requests; i++) {
+    ok = requests[i].done_.get() && ok;
+  }
+  return ok;
 }
 
 /**
@@ -196,6 +240,11 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
  */
 int DiskManager::GetNumFlushes() const { return num_flushes_; }
 
+/**
+ * Returns number of Reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns number of Writes made so far
  */
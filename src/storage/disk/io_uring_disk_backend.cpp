@@ -0,0 +1,283 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_disk_backend.cpp
+//
+// Identification: src/storage/disk/io_uring_disk_backend.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring_disk_backend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+#ifdef BUSTUB_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bustub {
+
+#ifdef BUSTUB_HAS_IO_URING
+
+/** user_data of the no-op entry that tells the completion thread to exit. */
+static constexpr uint64_t SHUTDOWN_USER_DATA = 0;
+
+IoUringDiskBackend::IoUringDiskBackend(int fd, uint32_t queue_depth) : fd_(fd) {
+  SetUp(queue_depth);
+  if (ring_fd_ >= 0) {
+    completion_thread_ = std::thread(&IoUringDiskBackend::CompletionLoop, this);
+  }
+}
+
+IoUringDiskBackend::~IoUringDiskBackend() { ShutDown(); }
+
+void IoUringDiskBackend::SetUp(uint32_t queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+  if (ring_fd_ < 0) {
+    return;
+  }
+
+  // Plain reads and writes need a 5.6 kernel, older ones only know about the vectored variants.
+  std::vector<char> probe_buf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+  auto probe = reinterpret_cast<io_uring_probe *>(probe_buf.data());
+  if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+      probe->last_op < IORING_OP_WRITE || (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) == 0 ||
+      (probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED) == 0) {
+    TearDown();
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    TearDown();
+    return;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      TearDown();
+      return;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  auto sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    TearDown();
+    return;
+  }
+  sqes_ = reinterpret_cast<io_uring_sqe *>(sqes);
+
+  auto sq_base = reinterpret_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq_base + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq_base + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq_base + params.sq_off.array);
+  auto cq_base = reinterpret_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq_base + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq_base + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq_base + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq_base + params.cq_off.cqes);
+  sq_entries_ = params.sq_entries;
+  cq_entries_ = params.cq_entries;
+}
+
+void IoUringDiskBackend::TearDown() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = nullptr;
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  cq_ring_ = nullptr;
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = nullptr;
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+    ring_fd_ = -1;
+  }
+}
+
+void IoUringDiskBackend::Submit(DiskRequest *requests, size_t num_requests) {
+  std::unique_lock latch(submit_latch_);
+  BUSTUB_ASSERT(!shutdown_, "Submit after ShutDown.");
+  for (size_t i = 0; i < num_requests; i++) {
+    if (in_flight_ == cq_entries_) {
+      // Every completion needs a slot in the completion ring, so wait for some requests to be reaped first.
+      Enter(pending_);
+      in_flight_cv_.wait(latch, [&] { return in_flight_ < cq_entries_; });
+    }
+    PushEntry(requests[i].is_write_ ? IORING_OP_WRITE : IORING_OP_READ, &requests[i]);
+    if (pending_ == sq_entries_) {
+      Enter(pending_);
+    }
+  }
+  Enter(pending_);
+}
+
+void IoUringDiskBackend::ShutDown() {
+  if (!completion_thread_.joinable()) {
+    TearDown();
+    return;
+  }
+  {
+    std::unique_lock latch(submit_latch_);
+    shutdown_ = true;
+    in_flight_cv_.wait(latch, [&] { return in_flight_ == 0; });
+    PushEntry(IORING_OP_NOP, nullptr);
+    Enter(pending_);
+  }
+  completion_thread_.join();
+  TearDown();
+}
+
+void IoUringDiskBackend::PushEntry(uint8_t opcode, DiskRequest *request) {
+  // Only submitters write the tail, and they hold submit_latch_.
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  if (request != nullptr) {
+    sqe->fd = fd_;
+    sqe->off = static_cast<uint64_t>(request->page_id_) * PAGE_SIZE;
+    sqe->addr = reinterpret_cast<uint64_t>(request->data_);
+    sqe->len = PAGE_SIZE;
+    sqe->user_data = reinterpret_cast<uint64_t>(request);
+  } else {
+    sqe->user_data = SHUTDOWN_USER_DATA;
+  }
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  pending_++;
+  in_flight_++;
+}
+
+void IoUringDiskBackend::Enter(uint32_t to_submit) {
+  while (to_submit > 0) {
+    auto rc = syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, 0, nullptr, 0);
+    if (rc < 0) {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        UNREACHABLE("io_uring_enter failed.");
+      }
+      // The kernel is short on resources, give the completion thread a chance to reap.
+      std::this_thread::yield();
+      continue;
+    }
+    to_submit -= static_cast<uint32_t>(rc);
+    pending_ -= static_cast<uint32_t>(rc);
+  }
+}
+
+void IoUringDiskBackend::CompletionLoop() {
+  bool shutdown = false;
+  while (!shutdown) {
+    // Only this thread writes the head.
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+      continue;
+    }
+    {
+      // The kernel hands the requests over, but that is invisible to the memory model (and to TSan). Synchronize
+      // with the submitters so that the requests they filled in happen-before their completion.
+      std::scoped_lock latch(submit_latch_);
+    }
+    size_t num_reaped = 0;
+    for (; head != tail; head++) {
+      io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+      if (cqe->user_data == SHUTDOWN_USER_DATA) {
+        shutdown = true;
+      } else {
+        Complete(reinterpret_cast<DiskRequest *>(cqe->user_data), cqe->res);
+      }
+      num_reaped++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    {
+      std::scoped_lock latch(submit_latch_);
+      in_flight_ -= num_reaped;
+    }
+    in_flight_cv_.notify_all();
+  }
+}
+
+void IoUringDiskBackend::Complete(DiskRequest *request, int result) {
+  bool ok = true;
+  if (result < 0) {
+    LOG_DEBUG("I/O error on page %d: %s", request->page_id_, strerror(-result));
+    ok = false;
+  } else if (result < PAGE_SIZE) {
+    if (request->is_write_) {
+      // Short writes are rare enough that redoing the whole page synchronously is fine.
+      ok = WritePageAt(fd_, request->page_id_, request->data_);
+    } else {
+      // A read stops short at the end of the file. Anywhere else it was cut short, so read the rest synchronously.
+      struct stat file_stat;
+      auto end = static_cast<off_t>(request->page_id_) * PAGE_SIZE + result;
+      if (fstat(fd_, &file_stat) == 0 && end >= file_stat.st_size) {
+        memset(request->data_ + result, 0, PAGE_SIZE - result);
+      } else {
+        ok = ReadPageAt(fd_, request->page_id_, request->data_);
+      }
+    }
+  }
+  request->callback_.set_value(ok);
+}
+
+#else
+
+IoUringDiskBackend::IoUringDiskBackend(int fd, uint32_t /* queue_depth */) : fd_(fd) {}
+
+IoUringDiskBackend::~IoUringDiskBackend() = default;
+
+void IoUringDiskBackend::SetUp(uint32_t /* queue_depth */) {}
+
+void IoUringDiskBackend::TearDown() {}
+
+void IoUringDiskBackend::Submit(DiskRequest * /* requests */, size_t /* num_requests */) {
+  UNREACHABLE("io_uring is not supported on this platform.");
+}
+
+void IoUringDiskBackend::ShutDown() {}
+
+void IoUringDiskBackend::PushEntry(uint8_t /* opcode */, DiskRequest * /* request */) {}
+
+void IoUringDiskBackend::Enter(uint32_t /* to_submit */) {}
+
+void IoUringDiskBackend::CompletionLoop() {}
+
+void IoUringDiskBackend::Complete(DiskRequest * /* request */, int /* result */) {}
+
+#endif
+
+}  // namespace bustub
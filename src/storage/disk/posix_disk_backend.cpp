@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_backend.cpp
+//
+// Identification: src/storage/disk/posix_disk_backend.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/posix_disk_backend.h"
+
+namespace bustub {
+
+PosixDiskBackend::PosixDiskBackend(int fd, size_t num_threads) : fd_(fd), num_threads_(num_threads) {}
+
+PosixDiskBackend::~PosixDiskBackend() { ShutDown(); }
+
+void PosixDiskBackend::Submit(DiskRequest *requests, size_t num_requests) {
+  {
+    std::scoped_lock latch(latch_);
+    if (shutdown_) {
+      for (size_t i = 0; i < num_requests; i++) {
+        requests[i].callback_.set_value(false);
+      }
+      return;
+    }
+    // The workers are only started by the first request, most disk managers never do asynchronous I/O.
+    while (workers_.size() < num_threads_) {
+      workers_.emplace_back(&PosixDiskBackend::WorkerLoop, this);
+    }
+    for (size_t i = 0; i < num_requests; i++) {
+      queue_.push_back(&requests[i]);
+    }
+  }
+  cv_.notify_all();
+}
+
+void PosixDiskBackend::ShutDown() {
+  {
+    std::scoped_lock latch(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void PosixDiskBackend::WorkerLoop() {
+  while (true) {
+    DiskRequest *request;
+    {
+      std::unique_lock latch(latch_);
+      cv_.wait(latch, [&] { return shutdown_ || !queue_.empty(); });
+      // Drain the queue before exiting so that every submitted request completes.
+      if (queue_.empty()) {
+        return;
+      }
+      request = queue_.front();
+      queue_.pop_front();
+    }
+    bool ok = request->is_write_ ? WritePageAt(fd_, request->page_id_, request->data_)
+                                 : ReadPageAt(fd_, request->page_id_, request->data_);
+    request->callback_.set_value(ok);
+  }
+}
+
+}  // namespace bustub
@@ -9,7 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -20,30 +23,46 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool unique_keys, page_id_t header_page_id)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      unique_keys_(unique_keys),
+      header_page_id_(header_page_id) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key, in RID order if there are
+ * more than one
  * This method is used for point query
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  Page *page = FindLeafPageOptimistic(key, false, Operation::FIND);
+  if (page == nullptr) {
+    return false;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool found = leaf->Lookup(key, &value, comparator_);
+  if (found) {
+    // A posting list is read under the latch of the leaf.
+    BPlusTreePostingPage::ReadValues(buffer_pool_manager_, value, result);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
 }
 
 /*****************************************************************************
@@ -53,31 +72,125 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if keys are unique and user try to insert duplicate keys, or if
+ * user try to insert duplicate key & value pairs, return false, otherwise
+ * return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  // Most inserts do not split the leaf, and only need to latch it.
+  Page *page = FindLeafPageOptimistic(key, false, Operation::INSERT);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType existing;
+    if (!unique_keys_ && leaf->Lookup(key, &existing, comparator_)) {
+      // Another value of a key that is already there does not change the size of the leaf.
+      bool inserted = InsertIntoPostingList(leaf, key, existing, value);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      return inserted;
+    }
+    if (IsSafe(leaf, Operation::INSERT)) {
+      int size = leaf->GetSize();
+      bool inserted = leaf->Insert(key, value, comparator_) != size;
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      return inserted;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  std::deque<Page *> local_page_set;
+  auto *page_set = transaction != nullptr ? transaction->GetPageSet().get() : &local_page_set;
+  page = FindLeafPagePessimistic(key, Operation::INSERT, page_set);
+  bool inserted = true;
+  try {
+    if (page == nullptr) {
+      StartNewTree(key, value);
+    } else {
+      inserted = InsertIntoLeaf(reinterpret_cast<LeafPage *>(page->GetData()), key, value, page_set);
+    }
+  } catch (const Exception &) {
+    // The buffer pool ran out of frames half way through, give the latched pages back before giving up.
+    ReleaseLatches(page_set, true);
+    throw;
+  }
+  ReleaseLatches(page_set, inserted);
+  return inserted;
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * The caller holds root_latch_.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate the root page");
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+}
 
 /*
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if keys are unique and user try to insert duplicate keys, or if
+ * user try to insert duplicate key & value pairs, return false, otherwise
+ * return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::InsertIntoLeaf(LeafPage *leaf, const KeyType &key, const ValueType &value,
+                                    std::deque<Page *> *page_set) {
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    return !unique_keys_ && InsertIntoPostingList(leaf, key, existing, value);
+  }
+  if (leaf->Insert(key, value, comparator_) < leaf->GetMaxSize()) {
+    return true;
+  }
+  auto *new_leaf = Split(leaf, page_set);
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  leaf->SetNextPageId(new_leaf->GetPageId());
+  KeyType separator = InternalPage::ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0));
+  InsertIntoParent(leaf, separator, new_leaf, page_set);
+  return true;
+}
+
+/*
+ * Add a value to a key of the write-latched leaf, whose value is existing.
+ * The values of a key with a few of them stay in the leaf, in an inline list
+ * RID. Once they no longer fit, they move to a new posting list, and the value
+ * of the key in the leaf becomes the list RID.
+ * @return: false if the key already has the value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertIntoPostingList(LeafPage *leaf, const KeyType &key, const ValueType &existing,
+                                           const ValueType &value) {
+  if (BPlusTreePostingPage::IsListRid(existing)) {
+    return BPlusTreePostingPage::InsertIntoList(buffer_pool_manager_, existing.GetPageId(), value);
+  }
+  std::vector<ValueType> values;
+  BPlusTreePostingPage::ReadValues(buffer_pool_manager_, existing, &values);
+  auto it = std::lower_bound(values.begin(), values.end(), value,
+                             [](const ValueType &lhs, const ValueType &rhs) { return lhs.Get() < rhs.Get(); });
+  if (it != values.end() && *it == value) {
+    return false;
+  }
+  values.insert(it, value);
+  leaf->SetValue(key, BPlusTreePostingPage::MakeList(buffer_pool_manager_, values.data(), values.size()), comparator_);
+  return true;
 }
 
 /*
@@ -86,11 +199,27 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page is write-latched and added to the page set, so that nobody reads
+ * it before the operation is over.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+N *BPLUSTREE_TYPE::Split(N *node, std::deque<Page *> *page_set) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to split into");
+  }
+  page->WLatch();
+  page_set->push_back(page);
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  new_node->Init(page_id, node->GetParentPageId(), node->GetMaxSize());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    node->MoveHalfTo(new_node);
+  } else {
+    node->MoveHalfTo(new_node, buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -101,10 +230,279 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is write-latched in the page set, since old_node was not safe.
+ * A parent with truncated keys may run out of bytes before it overflows, then it
+ * is split first, and the key goes into the half that holds old_node.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      std::deque<Page *> *page_set) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a new root page");
+    }
+    page->WLatch();
+    page_set->push_back(page);
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId();
+    return;
+  }
+
+  page_id_t parent_page_id = old_node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchPage(parent_page_id)->GetData());
+  auto *target = parent;
+  try {
+    while (!target->CanInsert(key)) {
+      // The first key that moves to the new page separates the two, take it before it moves.
+      KeyType middle_key = target->KeyAt(target->GetSize() / 2);
+      auto *new_parent = Split(target, page_set);
+      InsertIntoParent(target, middle_key, new_parent, page_set);
+      if (new_parent->ValueIndex(old_node->GetPageId()) != -1) {
+        target = new_parent;
+      }
+    }
+    target->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    new_node->SetParentPageId(target->GetPageId());
+    if (target->GetSize() > target->GetMaxSize()) {
+      KeyType middle_key = target->KeyAt(target->GetSize() / 2);
+      auto *new_parent = Split(target, page_set);
+      InsertIntoParent(target, middle_key, new_parent, page_set);
+    }
+  } catch (const Exception &) {
+    buffer_pool_manager_->UnpinPage(parent_page_id, true);
+    throw;
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build an empty tree bottom-up from key & value pairs in strictly increasing
+ * key order, which next() returns one by one until it returns false. This is
+ * much faster than inserting the pairs one by one: every page is written once,
+ * in page id order, and filled up to fill_factor of its capacity instead of
+ * being left half full by splits. The fill factor is bounded by the minimum
+ * size of a page, and a leaf is never filled up, so that the first insert into
+ * it does not split it. The last two pages of a level share their entries if
+ * the last one would be too small.
+ * If keys are not unique, the pairs come in strictly increasing order of key
+ * and value instead, and the values of a key go into its posting list.
+ * @return: false if the tree is not empty, or if the pairs are out of order,
+ * in which case the tree is left empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor) {
+  // Writers wait for the tree to be loaded, readers find it empty until then.
+  std::lock_guard<std::mutex> guard(root_latch_);
+  if (!IsEmpty()) {
+    return false;
+  }
+  int max_size = leaf_max_size_ - 1;
+  int min_size = std::max(leaf_max_size_ / 2, 1);
+  int fill = std::clamp(static_cast<int>(fill_factor * max_size), min_size, max_size);
+
+  // The posting lists made so far, deleted again if the pairs turn out to be out of order.
+  std::vector<page_id_t> list_page_ids;
+  bool out_of_order = false;
+  // Pull the pairs of the next key, and put its values into a list if it has many.
+  MappingType lookahead;
+  bool has_lookahead = false;
+  bool source_exhausted = false;
+  std::vector<ValueType> values;
+  auto next_entry = [&](MappingType *entry) {
+    if (!has_lookahead && (source_exhausted || !next(&lookahead))) {
+      source_exhausted = true;
+      return false;
+    }
+    *entry = lookahead;
+    has_lookahead = false;
+    if (unique_keys_) {
+      return true;
+    }
+    values.assign(1, entry->second);
+    while (next(&lookahead)) {
+      if (comparator_(lookahead.first, entry->first) != 0) {
+        has_lookahead = true;
+        break;
+      }
+      if (values.back().Get() >= lookahead.second.Get()) {
+        out_of_order = true;
+        return false;
+      }
+      values.push_back(lookahead.second);
+    }
+    source_exhausted = !has_lookahead;
+    entry->second = BPlusTreePostingPage::MakeList(buffer_pool_manager_, values.data(), values.size());
+    if (BPlusTreePostingPage::IsListRid(entry->second)) {
+      list_page_ids.push_back(entry->second.GetPageId());
+    }
+    return true;
+  };
+
+  // The first key and the page id of each leaf, which make up the level above.
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  // Enough pairs to tell whether the rest goes into one leaf or two.
+  std::vector<MappingType> pending;
+  MappingType item;
+  bool exhausted = false;
+  Page *prev_page = nullptr;
+  // Undo the leaves and posting lists made so far, when the pairs are out of order or a page cannot be had.
+  auto discard = [&]() {
+    if (prev_page != nullptr) {
+      buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), false);
+      prev_page = nullptr;
+    }
+    for (const auto &entry : level) {
+      buffer_pool_manager_->DeletePage(entry.second);
+    }
+    for (page_id_t list_page_id : list_page_ids) {
+      BPlusTreePostingPage::DeleteList(buffer_pool_manager_, list_page_id);
+    }
+  };
+  try {
+    while (true) {
+      while (!exhausted && static_cast<int>(pending.size()) < fill + min_size) {
+        if (!next_entry(&item)) {
+          exhausted = true;
+          break;
+        }
+        const KeyType *last_key = !pending.empty() ? &pending.back().first : nullptr;
+        if (last_key == nullptr && prev_page != nullptr) {
+          auto *prev_leaf = reinterpret_cast<LeafPage *>(prev_page->GetData());
+          last_key = &prev_leaf->GetItem(prev_leaf->GetSize() - 1).first;
+        }
+        if (last_key != nullptr && comparator_(*last_key, item.first) >= 0) {
+          out_of_order = true;
+          break;
+        }
+        pending.push_back(item);
+      }
+      if (out_of_order) {
+        discard();
+        return false;
+      }
+      if (pending.empty()) {
+        break;
+      }
+
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a leaf page to bulk load");
+      }
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+      int size = BulkLoadPageSize(pending.size(), fill, max_size, min_size);
+      leaf->CopyNFrom(pending.data(), size);
+      pending.erase(pending.begin(), pending.begin() + size);
+      if (prev_page != nullptr) {
+        auto *prev_leaf = reinterpret_cast<LeafPage *>(prev_page->GetData());
+        level.emplace_back(
+            InternalPage::ShortestSeparator(prev_leaf->KeyAt(prev_leaf->GetSize() - 1), leaf->KeyAt(0)), page_id);
+        prev_leaf->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+      } else {
+        level.emplace_back(leaf->KeyAt(0), page_id);
+      }
+      prev_page = page;
+    }
+    if (prev_page == nullptr) {
+      return true;
+    }
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+    prev_page = nullptr;
+
+    // The level is replaced by the one above as it is built, keep the leaves to discard.
+    std::vector<std::pair<KeyType, page_id_t>> leaves = level;
+    try {
+      root_page_id_ = BulkLoadInternalLevels(&level, fill_factor);
+    } catch (const Exception &) {
+      level = std::move(leaves);
+      throw;
+    }
+  } catch (const Exception &) {
+    discard();
+    throw;
+  }
+  UpdateRootPageId(1);
+  return true;
+}
+
+/*
+ * Build the internal pages on top of a bulk loaded level, one level at a time,
+ * and adopt the pages of the level below. If a page cannot be had, the
+ * internal pages built so far are deleted again.
+ * @return: the page id of the root
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::BulkLoadInternalLevels(std::vector<std::pair<KeyType, page_id_t>> *level,
+                                                 double fill_factor) {
+  int max_size = internal_max_size_;
+  int min_size = std::max((internal_max_size_ + 1) / 2, 2);
+  int fill = std::clamp(static_cast<int>(fill_factor * max_size), min_size, max_size);
+  std::vector<page_id_t> internal_page_ids;
+  while (level->size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> parent_level;
+    for (size_t start = 0; start < level->size();) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        for (page_id_t internal_page_id : internal_page_ids) {
+          buffer_pool_manager_->DeletePage(internal_page_id);
+        }
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate an internal page to bulk load");
+      }
+      internal_page_ids.push_back(page_id);
+      auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+      internal->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+      int size = BulkLoadPageSize(level->size() - start, fill, max_size, min_size);
+      // Truncated keys may run out of bytes first.
+      while (!InternalPage::Fits(level->data() + start, size)) {
+        size--;
+      }
+      // The key of the first entry is ignored by the page, and moves up to the level above.
+      try {
+        internal->CopyNFrom(level->data() + start, size, buffer_pool_manager_);
+      } catch (const Exception &) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        for (page_id_t internal_page_id : internal_page_ids) {
+          buffer_pool_manager_->DeletePage(internal_page_id);
+        }
+        throw;
+      }
+      parent_level.emplace_back((*level)[start].first, page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      start += size;
+    }
+    *level = std::move(parent_level);
+  }
+  return level->front().second;
+}
+
+/*
+ * Return how many of the remaining entries of a level go into its next page:
+ * fill entries, unless that would leave the last page with fewer than min_size
+ * entries. Then the rest goes into one page if it fits, or is split into two.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::BulkLoadPageSize(int remaining, int fill, int max_size, int min_size) {
+  if (remaining >= fill + min_size) {
+    return fill;
+  }
+  if (remaining <= max_size) {
+    return remaining;
+  }
+  return remaining / 2;
+}
 
 /*****************************************************************************
  * REMOVE
@@ -117,19 +515,194 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) { RemoveEntry(key, nullptr, transaction); }
+
+/*
+ * Delete the given key & value pair. The key itself is only deleted along with
+ * its last value.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  RemoveEntry(key, &value, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
+  // Most removes do not merge the leaf, and only need to latch it.
+  Page *page = FindLeafPageOptimistic(key, false, Operation::REMOVE);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool changed = false;
+  bool remove_key = RemoveValue(leaf, key, value, &changed);
+  if (!remove_key || IsSafe(leaf, Operation::REMOVE)) {
+    if (remove_key) {
+      changed = RemoveKey(leaf, key);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), changed);
+    return;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+  std::deque<Page *> local_page_set;
+  std::unordered_set<page_id_t> local_deleted_page_set;
+  auto *page_set = transaction != nullptr ? transaction->GetPageSet().get() : &local_page_set;
+  auto *deleted_page_set =
+      transaction != nullptr ? transaction->GetDeletedPageSet().get() : &local_deleted_page_set;
+  page = FindLeafPagePessimistic(key, Operation::REMOVE, page_set);
+  if (page == nullptr) {
+    ReleaseLatches(page_set, false);
+    return;
+  }
+  leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool removed;
+  try {
+    removed = RemoveValue(leaf, key, value, &changed) && RemoveKey(leaf, key);
+    if (removed) {
+      CoalesceOrRedistribute(leaf, page_set, deleted_page_set);
+    }
+  } catch (const Exception &) {
+    ReleaseLatches(page_set, true);
+    throw;
+  }
+  ReleaseLatches(page_set, removed || changed);
+  DeletePages(deleted_page_set);
+}
+
+/*
+ * Remove the value from the list of the key in the write-latched leaf, if the
+ * key has a list. A posting list that is left with few enough values to go
+ * inline is deleted, and the values go back into the leaf.
+ * @return: true means the key has to be removed from the leaf, either because
+ * any value goes or because the value is its only one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveValue(LeafPage *leaf, const KeyType &key, const ValueType *value, bool *changed) {
+  ValueType existing;
+  if (!leaf->Lookup(key, &existing, comparator_)) {
+    return false;
+  }
+  bool is_list = BPlusTreePostingPage::IsListRid(existing);
+  if (!is_list && !BPlusTreePostingPage::IsInlineListRid(existing)) {
+    return value == nullptr || existing == *value;
+  }
+  if (value == nullptr) {
+    return true;
+  }
+  std::vector<ValueType> values;
+  if (!is_list) {
+    BPlusTreePostingPage::ReadValues(buffer_pool_manager_, existing, &values);
+    auto it = std::find(values.begin(), values.end(), *value);
+    if (it == values.end()) {
+      return false;
+    }
+    values.erase(it);
+    *changed = true;
+    leaf->SetValue(key, BPlusTreePostingPage::MakeList(buffer_pool_manager_, values.data(), values.size()),
+                   comparator_);
+    return false;
+  }
+  int remaining;
+  if (!BPlusTreePostingPage::RemoveFromList(buffer_pool_manager_, existing.GetPageId(), *value, &remaining)) {
+    return false;
+  }
+  *changed = true;
+  if (remaining <= BPlusTreePostingPage::INLINE_MAX_SIZE) {
+    BPlusTreePostingPage::ReadList(buffer_pool_manager_, existing.GetPageId(), &values);
+    ValueType list = values[0];
+    if (remaining == 1 || BPlusTreePostingPage::MakeInlineList(values.data(), values.size(), &list)) {
+      BPlusTreePostingPage::DeleteList(buffer_pool_manager_, existing.GetPageId());
+      leaf->SetValue(key, list, comparator_);
+    }
+  }
+  return false;
+}
+
+/*
+ * Remove the key from the write-latched leaf, and delete its posting list if it
+ * has one.
+ * @return: false if the key is not in the leaf
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveKey(LeafPage *leaf, const KeyType &key) {
+  ValueType existing;
+  if (!leaf->Lookup(key, &existing, comparator_)) {
+    return false;
+  }
+  if (BPlusTreePostingPage::IsListRid(existing)) {
+    BPlusTreePostingPage::DeleteList(buffer_pool_manager_, existing.GetPageId());
+  }
+  leaf->RemoveAndDeleteRecord(key, comparator_);
+  return true;
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * The parent is write-latched in the page set, since the node was not safe. The
+ * sibling is write-latched and added to the page set. Pages that become empty
+ * are added to the deleted page set.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, std::deque<Page *> *page_set,
+                                            std::unordered_set<page_id_t> *deleted_page_set) {
+  if (node->IsRootPage()) {
+    if (!AdjustRoot(node)) {
+      return false;
+    }
+    deleted_page_set->insert(node->GetPageId());
+    return true;
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+  if constexpr (!std::is_same_v<N, LeafPage>) {
+    if (node->IsHalfFull()) {
+      return false;
+    }
+  }
+
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchPage(parent_page_id)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  page_id_t neighbor_page_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  Page *neighbor_page = buffer_pool_manager_->FetchPage(neighbor_page_id);
+  if (neighbor_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(parent_page_id, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the sibling page");
+  }
+  neighbor_page->WLatch();
+  page_set->push_back(neighbor_page);
+  auto *neighbor = reinterpret_cast<N *>(neighbor_page->GetData());
+
+  // A leaf splits as soon as it is full, an internal page only once it overflows.
+  int merged_size = neighbor->GetSize() + node->GetSize();
+  bool fits = node->IsLeafPage() ? merged_size < node->GetMaxSize() : merged_size <= node->GetMaxSize();
+  if constexpr (!std::is_same_v<N, LeafPage>) {
+    fits = fits && (index == 0 ? neighbor->CanMoveAllTo(node, parent->KeyAt(1))
+                               : node->CanMoveAllTo(neighbor, parent->KeyAt(index)));
+  }
+  bool node_deleted = false;
+  try {
+    if (fits) {
+      node_deleted = index != 0;
+      Coalesce(&neighbor, &node, &parent, index, page_set, deleted_page_set);
+    } else {
+      Redistribute(neighbor, node, index);
+    }
+  } catch (const Exception &) {
+    buffer_pool_manager_->UnpinPage(parent_page_id, true);
+    throw;
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+  return node_deleted;
 }
 
 /*
@@ -138,6 +711,8 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
+ * The right one of the two pages is always merged into the left one, and added
+ * to the deleted page set.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
@@ -148,8 +723,19 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) {
-  return false;
+                              std::deque<Page *> *page_set, std::unordered_set<page_id_t> *deleted_page_set) {
+  if (index == 0) {
+    std::swap(*neighbor_node, *node);
+    index = 1;
+  }
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(*neighbor_node);
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(index);
+  deleted_page_set->insert((*node)->GetPageId());
+  return CoalesceOrRedistribute(*parent, page_set, deleted_page_set);
 }
 
 /*
@@ -158,12 +744,56 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  * otherwise move sibling page's last key & value pair into head of input
  * "node".
  * Using template N to represent either internal page or leaf page.
+ * With truncated keys, the new separator may not fit in the parent, or the middle
+ * key in the node. Then nothing moves, and the node stays underfull.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto *parent = reinterpret_cast<InternalPage *>(FetchPage(parent_page_id)->GetData());
+  // The pair that moves and the one next to it in the neighbor, the new separator goes between them.
+  int moved = index == 0 ? 0 : neighbor_node->GetSize() - 1;
+  int next = index == 0 ? 1 : neighbor_node->GetSize() - 2;
+  int parent_index = index == 0 ? 1 : index;
+  KeyType separator;
+  bool fits;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    separator = index == 0 ? InternalPage::ShortestSeparator(neighbor_node->KeyAt(moved), neighbor_node->KeyAt(next))
+                           : InternalPage::ShortestSeparator(neighbor_node->KeyAt(next), neighbor_node->KeyAt(moved));
+    fits = parent->CanSetKeyAt(parent_index, separator);
+  } else {
+    // The key of the moved pair goes up, and the middle key comes down.
+    separator = neighbor_node->KeyAt(index == 0 ? next : moved);
+    fits = parent->CanSetKeyAt(parent_index, separator) && node->CanInsert(parent->KeyAt(parent_index));
+  }
+  if (!fits) {
+    buffer_pool_manager_->UnpinPage(parent_page_id, false);
+    return;
+  }
+  try {
+    if (index == 0) {
+      if constexpr (std::is_same_v<N, LeafPage>) {
+        neighbor_node->MoveFirstToEndOf(node);
+      } else {
+        neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+      }
+    } else {
+      if constexpr (std::is_same_v<N, LeafPage>) {
+        neighbor_node->MoveLastToFrontOf(node);
+      } else {
+        neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+      }
+    }
+  } catch (const Exception &) {
+    buffer_pool_manager_->UnpinPage(parent_page_id, true);
+    throw;
+  }
+  parent->SetKeyAt(parent_index, separator);
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -175,7 +805,27 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId();
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  // The only child is latched in the page set: it is either the page we came from or its sibling.
+  page_id_t child_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  auto *child = reinterpret_cast<BPlusTreePage *>(FetchPage(child_page_id)->GetData());
+  child->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+  root_page_id_ = child_page_id;
+  UpdateRootPageId();
+  return true;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -186,7 +836,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  Page *page = FindLeafPage(KeyType{}, true);
+  if (page == nullptr) {
+    return End();
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, this, page, 0, &comparator_);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -194,7 +850,37 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return End();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, this, page, index, &comparator_);
+}
+
+/*
+ * Construct an index iterator over the keys between low and high. A bound that
+ * is nullptr leaves that side of the range open.
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::ScanRange(const KeyType *low, bool low_inclusive, const KeyType *high,
+                                             bool high_inclusive) {
+  Page *page = low == nullptr ? FindLeafPage(KeyType{}, true) : FindLeafPage(*low);
+  if (page == nullptr) {
+    return End();
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = 0;
+  if (low != nullptr) {
+    index = leaf->KeyIndex(*low, comparator_);
+    if (!low_inclusive && index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *low) == 0) {
+      index++;
+    }
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, this, page, index, &comparator_, high, high_inclusive);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -213,7 +899,204 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  return FindLeafPageOptimistic(key, leftMost, Operation::FIND);
+}
+
+/*
+ * Descend from the root without latching internal pages. The version of each
+ * page is read before its child pointer and checked afterwards, and the descent
+ * starts over if a writer got in between. The leaf is read-latched for FIND and
+ * write-latched otherwise; since its version is unchanged once it is latched, it
+ * is still the leaf that holds the key.
+ * @return: the leaf, pinned and latched, or nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, bool left_most, Operation op) {
+  while (true) {
+    page_id_t page_id = root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the root page");
+    }
+    uint64_t version = ReadVersion(page);
+    bool restart = root_page_id_ != page_id;
+    while (!restart) {
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      bool is_leaf = node->IsLeafPage();
+      if (!page->ValidateVersion(version)) {
+        restart = true;
+        break;
+      }
+      if (is_leaf) {
+        break;
+      }
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key, comparator_);
+      if (!page->ValidateVersion(version)) {
+        restart = true;
+        break;
+      }
+      Page *child = buffer_pool_manager_->FetchPage(child_page_id);
+      if (child == nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the child page");
+      }
+      uint64_t child_version = ReadVersion(child);
+      if (!page->ValidateVersion(version)) {
+        buffer_pool_manager_->UnpinPage(child_page_id, false);
+        restart = true;
+        break;
+      }
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child;
+      version = child_version;
+    }
+    if (!restart) {
+      if (op == Operation::FIND) {
+        page->RLatch();
+        if (page->ValidateVersion(version)) {
+          return page;
+        }
+        page->RUnlatch();
+      } else {
+        page->WLatch();
+        if (page->ValidateVersion(version + 1)) {
+          return page;
+        }
+        page->WUnlatch();
+      }
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*
+ * Descend from the root with write latches (latch crabbing). Once a page is
+ * safe for the operation, the latches above it are released: the page absorbs
+ * whatever happens below. root_latch_ is pushed into the page set as nullptr.
+ * @return: the leaf, pinned and write-latched, or nullptr if the tree is empty,
+ * in which case root_latch_ is still held in the page set
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPagePessimistic(const KeyType &key, Operation op, std::deque<Page *> *page_set) {
+  root_latch_.lock();
+  page_set->push_back(nullptr);
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      ReleaseLatches(page_set, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the tree");
+    }
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op)) {
+      ReleaseLatches(page_set, false);
+    }
+    page_set->push_back(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+  }
+}
+
+/*
+ * Wait until no writer holds the page, and return its version
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint64_t BPLUSTREE_TYPE::ReadVersion(Page *page) const {
+  while (true) {
+    uint64_t version = page->GetVersion();
+    if (version % 2 == 0) {
+      return version;
+    }
+    // Block on the latch rather than spin until the writer is done.
+    page->RLatch();
+    page->RUnlatch();
+  }
+}
+
+/*
+ * A page is safe for an operation if the operation cannot split or merge it,
+ * so that its parent will not change
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const {
+  switch (op) {
+    case Operation::FIND:
+      return true;
+    case Operation::INSERT:
+      // A leaf splits when it becomes full, an internal page when it overflows or runs out of bytes.
+      if (node->IsLeafPage()) {
+        return node->GetSize() + 1 < node->GetMaxSize();
+      }
+      return node->GetSize() < node->GetMaxSize() && reinterpret_cast<InternalPage *>(node)->HasRoomForAnyKey();
+    case Operation::REMOVE:
+      if (node->IsRootPage()) {
+        return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+      }
+      return node->GetSize() > node->GetMinSize();
+  }
+  return false;
+}
+
+/*
+ * Unlatch and unpin the pages of the page set in the order they were latched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatches(std::deque<Page *> *page_set, bool is_dirty) {
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.unlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of the tree");
+  }
+  return page;
+}
+
+/*
+ * Delete the pages emptied by a remove, along with those that earlier removes
+ * could not delete. A page that an optimistic reader still has pinned cannot
+ * be deleted yet; it is unreachable, so it waits for a later remove to find it
+ * unpinned.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(std::unordered_set<page_id_t> *deleted_page_set) {
+  std::vector<page_id_t> page_ids(deleted_page_set->begin(), deleted_page_set->end());
+  deleted_page_set->clear();
+  {
+    std::scoped_lock latch(pinned_deletes_latch_);
+    page_ids.insert(page_ids.end(), pinned_deletes_.begin(), pinned_deletes_.end());
+    pinned_deletes_.clear();
+  }
+  std::vector<page_id_t> pinned_page_ids;
+  for (page_id_t page_id : page_ids) {
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      pinned_page_ids.push_back(page_id);
+    }
+  }
+  if (!pinned_page_ids.empty()) {
+    std::scoped_lock latch(pinned_deletes_latch_);
+    pinned_deletes_.insert(pinned_deletes_.end(), pinned_page_ids.begin(), pinned_page_ids.end());
+  }
 }
 
 /*
@@ -226,15 +1109,16 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  auto *header_page = static_cast<HeaderPage *>(FetchPage(header_page_id_));
+  // The header page is shared by all indexes.
+  header_page->WLatch();
+  // A tree that became empty and grows again already has a record.
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 }
 
 /*
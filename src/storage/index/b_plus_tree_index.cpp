@@ -11,21 +11,28 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+#include <iterator>
+
+#include "common/exception.h"
+
 namespace bustub {
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     bool unique_keys, page_id_t header_page_id)
     : Index(std::move(metadata)),
-      comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE - 1,
+                 unique_keys, header_page_id),
+      buffer_pool_manager_(buffer_pool_manager) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,20 +41,193 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *, RID *)> &next) {
+  constexpr size_t run_size = BULK_LOAD_RUN_PAGES * SortedRun::ENTRIES_PER_PAGE;
+  std::vector<std::unique_ptr<SortedRun>> runs;
+  std::vector<MappingType> entries;
+  Tuple key;
+  RID rid;
+  while (next(&key, &rid)) {
+    if (entries.size() == run_size) {
+      runs.push_back(WriteRun(&entries));
+    }
+    entries.emplace_back();
+    entries.back().first.SetFromKey(key, GetKeySchema());
+    entries.back().second = rid;
+  }
+
+  if (runs.empty()) {
+    // Every entry fits in a single run, which needs no page.
+    std::sort(entries.begin(), entries.end(),
+              [this](const MappingType &lhs, const MappingType &rhs) { return EntryLess(lhs, rhs); });
+    size_t pos = 0;
+    return container_.BulkLoad([&](MappingType *item) {
+      if (pos == entries.size()) {
+        return false;
+      }
+      *item = entries[pos++];
+      return true;
+    });
+  }
+  if (!entries.empty()) {
+    runs.push_back(WriteRun(&entries));
+  }
+  entries.shrink_to_fit();
+
+  // Merge the runs into longer ones until a single merge is left.
+  while (runs.size() > BULK_LOAD_FAN_IN) {
+    std::vector<std::unique_ptr<SortedRun>> merged_runs;
+    for (size_t i = 0; i < runs.size(); i += BULK_LOAD_FAN_IN) {
+      auto begin = runs.begin() + i;
+      auto end = runs.begin() + std::min(i + BULK_LOAD_FAN_IN, runs.size());
+      RunMerger merger(this, std::vector<std::unique_ptr<SortedRun>>(std::make_move_iterator(begin),
+                                                                     std::make_move_iterator(end)));
+      auto run = std::make_unique<SortedRun>(buffer_pool_manager_);
+      MappingType entry;
+      while (merger.Next(&entry)) {
+        run->Append(entry);
+      }
+      run->Finish();
+      merged_runs.push_back(std::move(run));
+    }
+    runs = std::move(merged_runs);
+  }
+
+  RunMerger merger(this, std::move(runs));
+  return container_.BulkLoad([&](MappingType *item) { return merger.Next(item); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::EntryLess(const MappingType &lhs, const MappingType &rhs) const {
+  int cmp = comparator_(lhs.first, rhs.first);
+  return cmp < 0 || (cmp == 0 && lhs.second.Get() < rhs.second.Get());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::unique_ptr<typename BPLUSTREE_INDEX_TYPE::SortedRun> BPLUSTREE_INDEX_TYPE::WriteRun(
+    std::vector<MappingType> *entries) {
+  std::sort(entries->begin(), entries->end(),
+            [this](const MappingType &lhs, const MappingType &rhs) { return EntryLess(lhs, rhs); });
+  auto run = std::make_unique<SortedRun>(buffer_pool_manager_);
+  for (const auto &entry : *entries) {
+    run->Append(entry);
+  }
+  run->Finish();
+  entries->clear();
+  return run;
+}
+
+/*****************************************************************************
+ * SORTED RUN
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_INDEX_TYPE::SortedRun::~SortedRun() {
+  for (size_t i = num_read_pages_; i < page_ids_.size(); i++) {
+    buffer_pool_manager_->DeletePage(page_ids_[i]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SortedRun::Append(const MappingType &entry) {
+  if (entries_.size() == ENTRIES_PER_PAGE) {
+    Flush();
+  }
+  entries_.push_back(entry);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SortedRun::Finish() {
+  if (!entries_.empty()) {
+    Flush();
+  }
+  entries_.shrink_to_fit();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SortedRun::Flush() {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't create a page for a sorted run.");
+  }
+  auto size = static_cast<uint32_t>(entries_.size());
+  memcpy(page->GetData(), &size, sizeof(uint32_t));
+  std::copy(entries_.begin(), entries_.end(), reinterpret_cast<MappingType *>(page->GetData() + sizeof(uint32_t)));
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  page_ids_.push_back(page_id);
+  entries_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType *BPLUSTREE_INDEX_TYPE::SortedRun::Next() {
+  if (read_pos_ == entries_.size()) {
+    if (num_read_pages_ == page_ids_.size()) {
+      return nullptr;
+    }
+    page_id_t page_id = page_ids_[num_read_pages_];
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a page of a sorted run.");
+    }
+    uint32_t size;
+    memcpy(&size, page->GetData(), sizeof(uint32_t));
+    const auto *page_entries = reinterpret_cast<const MappingType *>(page->GetData() + sizeof(uint32_t));
+    entries_.assign(page_entries, page_entries + size);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    num_read_pages_++;
+    read_pos_ = 0;
+  }
+  return &entries_[read_pos_++];
+}
+
+/*****************************************************************************
+ * RUN MERGER
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_INDEX_TYPE::RunMerger::RunMerger(const BPlusTreeIndex *index,
+                                           std::vector<std::unique_ptr<SortedRun>> &&runs)
+    : runs_(std::move(runs)),
+      greater_([index](const RunHead &lhs, const RunHead &rhs) { return index->EntryLess(*rhs.first, *lhs.first); }),
+      heads_(greater_) {
+  for (size_t i = 0; i < runs_.size(); i++) {
+    const MappingType *head = runs_[i]->Next();
+    if (head != nullptr) {
+      heads_.emplace(head, i);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::RunMerger::Next(MappingType *entry) {
+  if (heads_.empty()) {
+    return false;
+  }
+  RunHead head = heads_.top();
+  heads_.pop();
+  *entry = *head.first;
+  const MappingType *next = runs_[head.second]->Next();
+  if (next != nullptr) {
+    heads_.emplace(next, head.second);
+  }
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.Begin(); }
 
@@ -57,6 +237,21 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high,
+                                                   bool high_inclusive) {
+  KeyType low_key;
+  KeyType high_key;
+  if (low != nullptr) {
+    low_key.SetFromKey(*low, GetKeySchema());
+  }
+  if (high != nullptr) {
+    high_key.SetFromKey(*high, GetKeySchema());
+  }
+  return container_.ScanRange(low == nullptr ? nullptr : &low_key, low_inclusive,
+                              high == nullptr ? nullptr : &high_key, high_inclusive);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
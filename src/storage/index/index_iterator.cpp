@@ -3,28 +3,248 @@
  */
 #include <cassert>
 
+#include "common/exception.h"
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *buffer_pool_manager,
+                                  BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *page, int index,
+                                  const KeyComparator *comparator, const KeyType *high_key, bool high_inclusive)
+    : buffer_pool_manager_(buffer_pool_manager),
+      tree_(tree),
+      page_(page),
+      leaf_(reinterpret_cast<LeafPage *>(page->GetData())),
+      comparator_(comparator),
+      has_high_key_(high_key != nullptr),
+      high_inclusive_(high_inclusive) {
+  if (high_key != nullptr) {
+    high_key_ = *high_key;
+  }
+  LoadBatch(index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      tree_(other.tree_),
+      page_(other.page_),
+      leaf_(other.leaf_),
+      version_(other.version_),
+      batch_(std::move(other.batch_)),
+      index_(other.index_),
+      last_key_(other.last_key_),
+      last_batch_(other.last_batch_),
+      comparator_(other.comparator_),
+      has_high_key_(other.has_high_key_),
+      high_key_(other.high_key_),
+      high_inclusive_(other.high_inclusive_) {
+  other.page_ = nullptr;
+  other.leaf_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    tree_ = other.tree_;
+    page_ = other.page_;
+    leaf_ = other.leaf_;
+    version_ = other.version_;
+    batch_ = std::move(other.batch_);
+    index_ = other.index_;
+    last_key_ = other.last_key_;
+    last_batch_ = other.last_batch_;
+    comparator_ = other.comparator_;
+    has_high_key_ = other.has_high_key_;
+    high_key_ = other.high_key_;
+    high_inclusive_ = other.high_inclusive_;
+    other.page_ = nullptr;
+    other.leaf_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::IsEnd() { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(!IsEnd());
+  return batch_[index_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  assert(!IsEnd());
+  if (++index_ < batch_.size()) {
+    return *this;
+  }
+  MoveToNextBatch();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::NextBatch(std::vector<ValueType> *values) {
+  if (IsEnd()) {
+    return false;
+  }
+  for (; index_ < batch_.size(); index_++) {
+    values->push_back(batch_[index_].second);
+  }
+  MoveToNextBatch();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadBatch(int index) {
+  while (true) {
+    batch_.clear();
+    index_ = 0;
+    int size = leaf_->GetSize();
+    for (; index < size; index++) {
+      const MappingType &item = leaf_->GetItem(index);
+      if (has_high_key_) {
+        int cmp = (*comparator_)(item.first, high_key_);
+        if (cmp > 0 || (cmp == 0 && !high_inclusive_)) {
+          last_batch_ = true;
+          break;
+        }
+      }
+      if (BPlusTreePostingPage::IsListRid(item.second) || BPlusTreePostingPage::IsInlineListRid(item.second)) {
+        // A key with many values returns one entry per value, read from its list under the leaf latch.
+        std::vector<ValueType> values;
+        BPlusTreePostingPage::ReadValues(buffer_pool_manager_, item.second, &values);
+        for (const auto &value : values) {
+          batch_.emplace_back(item.first, value);
+        }
+      } else {
+        batch_.push_back(item);
+      }
+    }
+    if (index > 0) {
+      last_key_ = leaf_->KeyAt(index - 1);
+    }
+    version_ = page_->GetVersion();
+    if (!batch_.empty()) {
+      page_->RUnlatch();
+      return;
+    }
+    if (last_batch_ || size == 0) {
+      page_->RUnlatch();
+      Release();
+      return;
+    }
+    index = MoveToNextLeaf(last_key_);
+    if (index < 0) {
+      return;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MoveToNextBatch() {
+  if (last_batch_) {
+    Release();
+    return;
+  }
+  page_->RLatch();
+  int index;
+  if (page_->ValidateVersion(version_)) {
+    // The batch covered the rest of the leaf, and the leaf still links to the one that follows it.
+    index = MoveToNextLeaf(last_key_);
+  } else {
+    page_->RUnlatch();
+    index = Seek(last_key_);
+  }
+  if (index >= 0) {
+    LoadBatch(index);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int INDEXITERATOR_TYPE::MoveToNextLeaf(const KeyType &last_key) {
+  while (true) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      page_->RUnlatch();
+      Release();
+      return -1;
+    }
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      page_->RUnlatch();
+      Release();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the next leaf");
+    }
+    if (next_page->TryRLatch()) {
+      page_->RUnlatch();
+    } else {
+      // The writer of the next leaf may be waiting for ours.
+      uint64_t version = page_->GetVersion();
+      page_->RUnlatch();
+      next_page->RLatch();
+      if (!page_->ValidateVersion(version)) {
+        // Entries may have moved between the leaves, or the current leaf may be gone, start over from the tree.
+        next_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(next_page_id, false);
+        int index = Seek(last_key);
+        if (index < 0 || index < leaf_->GetSize()) {
+          return index;
+        }
+        continue;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = next_page;
+    leaf_ = reinterpret_cast<LeafPage *>(next_page->GetData());
+    int index = UpperBound(last_key);
+    if (index < leaf_->GetSize()) {
+      return index;
+    }
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::IsEnd() { throw std::runtime_error("unimplemented"); }
+int INDEXITERATOR_TYPE::Seek(const KeyType &key) {
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  page_ = tree_->FindLeafPage(key);
+  if (page_ == nullptr) {
+    Release();
+    return -1;
+  }
+  leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+  return UpperBound(key);
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+int INDEXITERATOR_TYPE::UpperBound(const KeyType &key) const {
+  int index = leaf_->KeyIndex(key, *comparator_);
+  if (index < leaf_->GetSize() && (*comparator_)(leaf_->KeyAt(index), key) == 0) {
+    index++;
+  }
+  return index;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  }
+  page_ = nullptr;
+  leaf_ = nullptr;
+  batch_.clear();
+  index_ = 0;
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -9,11 +9,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
+#include "common/macros.h"
 #include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_key_search.h"
 
 namespace bustub {
 /*****************************************************************************
@@ -25,34 +30,78 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetMaxSize(max_size);
+  prefix_length_ = 0;
+}
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
+ * A truncated key is the prefix and its suffix, padded with zero bytes. The first
+ * key of a page with truncated keys is not stored, so it is not meaningful.
  */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
+  if constexpr (!TRUNCATE_KEYS) {
+    return Array()[index].first;
+  } else {
+    KeyType key;
+    auto *bytes = reinterpret_cast<char *>(&key);
+    memset(bytes, 0, sizeof(KeyType));
+    size_t prefix_length = StoredPrefixLength(SlotCount());
+    memcpy(bytes, data_ + SlotCount() * sizeof(Slot), prefix_length);
+    const Slot &slot = Slots()[index];
+    size_t offset = std::min<size_t>(slot.offset_, CAPACITY);
+    memcpy(bytes + prefix_length, data_ + offset,
+           std::min<size_t>({slot.length_, sizeof(KeyType) - prefix_length, CAPACITY - offset}));
+    return key;
+  }
 }
 
+/*
+ * Changing a truncated key re-encodes the page: the caller checks CanSetKeyAt first
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if constexpr (!TRUNCATE_KEYS) {
+    Array()[index].first = key;
+  } else {
+    std::vector<MappingType> entries = Entries();
+    entries[index].first = key;
+    SetEntries(entries);
+  }
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const { return 0; }
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (ValueAt(i) == value) {
+      return i;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  if constexpr (!TRUNCATE_KEYS) {
+    return Array()[index].second;
+  } else {
+    return Slots()[index].value_;
+  }
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -61,10 +110,44 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
  * Find and return the child pointer(page_id) which points to the child page
  * that contains input "key"
  * Start the search from the second key(the first key should always be invalid)
+ * Optimistic readers look up pages that may be changing under them, so the
+ * lookup of truncated keys never reads past the page whatever its header says;
+ * the reader validates the page version before it follows the child.
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  return INVALID_PAGE_ID;
+  if constexpr (!TRUNCATE_KEYS) {
+    // The child is left of the first key that is greater than the input key.
+    int index = KeySearch<KeyType, ValueType, KeyComparator>::UpperBound(Array(), 1, GetSize(), key, comparator);
+    return Array()[index - 1].second;
+  } else {
+    int size = SlotCount();
+    if (size == 0) {
+      return Slots()[0].value_;
+    }
+    // Every key but the first starts with the prefix, so a key that does not is left or right of all of them.
+    const auto *bytes = reinterpret_cast<const char *>(&key);
+    size_t prefix_length = StoredPrefixLength(size);
+    int cmp = memcmp(bytes, data_ + size * sizeof(Slot), prefix_length);
+    if (cmp < 0) {
+      return Slots()[0].value_;
+    }
+    if (cmp > 0) {
+      return Slots()[size - 1].value_;
+    }
+    size_t key_length = TrimmedLength(key);
+    int low = 1;
+    int high = size;
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      if (CompareSuffix(bytes, key_length, prefix_length, Slots()[mid]) >= 0) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return Slots()[low - 1].value_;
+  }
 }
 
 /*****************************************************************************
@@ -78,16 +161,23 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value) {
+  SetEntries({MappingType(new_key, old_value), MappingType(new_key, new_value)});
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
+ * The caller checks CanInsert first.
  * @return:  new size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  return 0;
+  std::vector<MappingType> entries = Entries();
+  int index = ValueIndex(old_value) + 1;
+  entries.insert(entries.begin() + index, MappingType(new_key, new_value));
+  SetEntries(entries);
+  return GetSize();
 }
 
 /*****************************************************************************
@@ -95,17 +185,31 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * This page keeps its first GetSize() / 2 pairs.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
+                                                BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> entries = Entries();
+  int keep = GetSize() / 2;
+  recipient->CopyNFrom(entries.data() + keep, GetSize() - keep, buffer_pool_manager);
+  entries.resize(keep);
+  SetEntries(entries);
+}
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> entries = Entries();
+  entries.insert(entries.end(), items, items + size);
+  SetEntries(entries);
+  for (int i = 0; i < size; i++) {
+    Adopt(items[i].second, buffer_pool_manager);
+  }
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +220,22 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  std::vector<MappingType> entries = Entries();
+  entries.erase(entries.begin() + index);
+  SetEntries(entries);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return INVALID_PAGE_ID; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  ValueType value = ValueAt(0);
+  SetSize(0);
+  return value;
+}
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -133,10 +245,16 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return IN
  * to make sure the middle key is added to the recipient to maintain the invariant.
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
  * pages that are moved to the recipient
+ * The caller checks CanMoveAllTo first.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+                                               BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> entries = Entries();
+  entries[0].first = middle_key;
+  recipient->CopyNFrom(entries.data(), GetSize(), buffer_pool_manager);
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -148,17 +266,17 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  * to make sure the middle key is added to the recipient to maintain the invariant.
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
  * pages that are moved to the recipient
+ * The caller checks that the recipient can insert the middle key first.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
-
-/* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+                                                      BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> entries = Entries();
+  MappingType pair(middle_key, entries[0].second);
+  recipient->CopyNFrom(&pair, 1, buffer_pool_manager);
+  entries.erase(entries.begin());
+  SetEntries(entries);
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
@@ -166,17 +284,261 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  * right place.
  * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
  * moved to the recipient
+ * The caller checks that the recipient can insert the middle key first.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+                                                       BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> entries = Entries();
+  std::vector<MappingType> recipient_entries = recipient->Entries();
+  recipient_entries[0].first = middle_key;
+  recipient_entries.insert(recipient_entries.begin(), entries.back());
+  recipient->SetEntries(recipient_entries);
+  recipient->Adopt(entries.back().second, buffer_pool_manager);
+  entries.pop_back();
+  SetEntries(entries);
+}
+
+/*****************************************************************************
+ * SPACE
+ *****************************************************************************/
+/*
+ * Whether one more pair with the key fits in this page. The new pair is never the
+ * first one, whose key is not stored, so where it goes does not matter.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsert(const KeyType &key) const {
+  if constexpr (!TRUNCATE_KEYS) {
+    return static_cast<size_t>(GetSize() + 1) * sizeof(MappingType) <= CAPACITY;
+  } else {
+    std::vector<MappingType> entries = Entries();
+    entries.emplace_back(key, ValueType());
+    return Fits(entries.data(), entries.size());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const {
+  if constexpr (!TRUNCATE_KEYS) {
+    return true;
+  } else {
+    std::vector<MappingType> entries = Entries();
+    entries[index].first = key;
+    return Fits(entries.data(), entries.size());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMoveAllTo(const BPlusTreeInternalPage *recipient,
+                                                  const KeyType &middle_key) const {
+  std::vector<MappingType> entries = recipient->Entries();
+  std::vector<MappingType> moved = Entries();
+  moved[0].first = middle_key;
+  entries.insert(entries.end(), moved.begin(), moved.end());
+  return Fits(entries.data(), entries.size());
+}
+
+/*
+ * Whether a pair with any key fits in this page: a new key may break the common
+ * prefix, and then every other key stores the prefix again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomForAnyKey() const {
+  if constexpr (!TRUNCATE_KEYS) {
+    return CanInsert(KeyType());
+  } else {
+    std::vector<MappingType> entries = Entries();
+    size_t used = EncodedSize(entries.data(), entries.size());
+    size_t needed = sizeof(Slot) + sizeof(KeyType) + entries.size() * PrefixLength(entries.data(), entries.size());
+    return used + needed <= CAPACITY;
+  }
+}
+
+/*
+ * Whether the keys take at least half of the page. A page with fewer pairs than its
+ * min size is not underfull when it is, which only happens with truncated keys.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsHalfFull() const {
+  if constexpr (!TRUNCATE_KEYS) {
+    return false;
+  } else {
+    std::vector<MappingType> entries = Entries();
+    return EncodedSize(entries.data(), entries.size()) * 2 >= CAPACITY;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::Fits(const MappingType *items, int size) {
+  return EncodedSize(items, size) <= CAPACITY;
+}
 
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
+/*
+ * The shortest key that separates left from right, i.e. left < key <= right: the bytes
+ * of right up to the first one that differs from left, followed by zero bytes. The tree
+ * pushes it up instead of right when a leaf splits, so that internal pages store less.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ShortestSeparator(const KeyType &left, const KeyType &right) {
+  if constexpr (!TRUNCATE_KEYS) {
+    return right;
+  } else {
+    const auto *left_bytes = reinterpret_cast<const char *>(&left);
+    const auto *right_bytes = reinterpret_cast<const char *>(&right);
+    size_t length = 0;
+    while (length < sizeof(KeyType) && left_bytes[length] == right_bytes[length]) {
+      length++;
+    }
+    KeyType separator;
+    auto *bytes = reinterpret_cast<char *>(&separator);
+    memset(bytes, 0, sizeof(KeyType));
+    memcpy(bytes, right_bytes, std::min(length + 1, sizeof(KeyType)));
+    return separator;
+  }
+}
+
+/*****************************************************************************
+ * ENCODING
+ *****************************************************************************/
+/*
+ * All the pairs of this page, with the keys of truncated pairs padded again.
+ * The pages with truncated keys are re-encoded for every change, which is cheap
+ * enough since internal pages change only when their children split or merge.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<MappingType> B_PLUS_TREE_INTERNAL_PAGE_TYPE::Entries() const {
+  if constexpr (!TRUNCATE_KEYS) {
+    return std::vector<MappingType>(Array(), Array() + GetSize());
+  } else {
+    std::vector<MappingType> entries;
+    entries.reserve(GetSize());
+    for (int i = 0; i < GetSize(); i++) {
+      entries.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    return entries;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetEntries(const std::vector<MappingType> &entries) {
+  int size = entries.size();
+  BUSTUB_ASSERT(Fits(entries.data(), size), "The pairs must fit in the page.");
+  if constexpr (!TRUNCATE_KEYS) {
+    std::copy(entries.begin(), entries.end(), Array());
+  } else {
+    size_t prefix_length = PrefixLength(entries.data(), size);
+    size_t offset = size * sizeof(Slot);
+    if (size > 1) {
+      memcpy(data_ + offset, &entries[1].first, prefix_length);
+    }
+    offset += prefix_length;
+    for (int i = 0; i < size; i++) {
+      size_t length = i == 0 ? 0 : TrimmedLength(entries[i].first);
+      length = length > prefix_length ? length - prefix_length : 0;
+      memcpy(data_ + offset, reinterpret_cast<const char *>(&entries[i].first) + prefix_length, length);
+      Slots()[i] = Slot{entries[i].second, static_cast<uint16_t>(offset), static_cast<uint16_t>(length)};
+      offset += length;
+    }
+    prefix_length_ = prefix_length;
+  }
+  SetSize(size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::EncodedSize(const MappingType *items, int size) {
+  if constexpr (!TRUNCATE_KEYS) {
+    return size * sizeof(MappingType);
+  } else {
+    size_t prefix_length = PrefixLength(items, size);
+    size_t encoded_size = size * sizeof(Slot) + prefix_length;
+    for (int i = 1; i < size; i++) {
+      size_t length = TrimmedLength(items[i].first);
+      encoded_size += length > prefix_length ? length - prefix_length : 0;
+    }
+    return encoded_size;
+  }
+}
+
+/*
+ * The length of the prefix that all keys but the first share, without the zero bytes
+ * that are past the end of every key anyway.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+size_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::PrefixLength(const MappingType *items, int size) {
+  if (size <= 1) {
+    return 0;
+  }
+  const auto *first = reinterpret_cast<const char *>(&items[1].first);
+  size_t prefix_length = TrimmedLength(items[1].first);
+  for (int i = 2; i < size && prefix_length > 0; i++) {
+    const auto *bytes = reinterpret_cast<const char *>(&items[i].first);
+    size_t length = 0;
+    while (length < prefix_length && bytes[length] == first[length]) {
+      length++;
+    }
+    prefix_length = length;
+  }
+  return prefix_length;
+}
+
+/*
+ * The length of the key without its trailing zero bytes.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::TrimmedLength(const KeyType &key) {
+  const auto *bytes = reinterpret_cast<const char *>(&key);
+  size_t length = sizeof(KeyType);
+  while (length > 0 && bytes[length - 1] == 0) {
+    length--;
+  }
+  return length;
+}
+
+/*
+ * The number of slots, and the length of the prefix stored after them, clamped to
+ * the page for the optimistic readers.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotCount() const {
+  return std::clamp<int>(GetSize(), 0, CAPACITY / sizeof(Slot));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::StoredPrefixLength(int size) const {
+  return std::min<size_t>({prefix_length_, sizeof(KeyType), CAPACITY - size * sizeof(Slot)});
+}
+
+/*
+ * Compare the bytes of a key after the prefix to the suffix of a slot. key_length is
+ * the length of the key without its trailing zero bytes.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::CompareSuffix(const char *key, size_t key_length, size_t prefix_length,
+                                                  const Slot &slot) const {
+  size_t offset = std::min<size_t>(slot.offset_, CAPACITY);
+  size_t length = std::min<size_t>({slot.length_, sizeof(KeyType) - prefix_length, CAPACITY - offset});
+  int cmp = memcmp(key + prefix_length, data_ + offset, length);
+  if (cmp != 0) {
+    return cmp;
+  }
+  // The rest of the stored key is zero bytes.
+  return key_length > prefix_length + length ? 1 : 0;
+}
+
+/*
+ * Make this page the parent of a child page.
+ * The child is not latched: the caller holds the write latch on this page, so
+ * nobody else follows the child's parent page id while it changes.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(page_id_t child_page_id, BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(child_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch the child page to adopt");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child_page_id, true);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
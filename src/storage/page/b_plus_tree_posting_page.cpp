@@ -0,0 +1,404 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+int VarintSize(uint64_t value) {
+  int size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+uint8_t *PutVarint(uint8_t *out, uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<uint8_t>(value) | 0x80;
+    value >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+const uint8_t *GetVarint(const uint8_t *in, uint64_t *value) {
+  *value = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = *in++;
+    *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return in;
+    }
+  }
+}
+
+}  // namespace
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+void BPlusTreePostingPage::Init(page_id_t page_id) {
+  next_page_id_ = INVALID_PAGE_ID;
+  tail_page_id_ = page_id;
+  size_ = 0;
+  total_size_ = 0;
+  used_ = 0;
+  last_rid_ = RID(0, 0);
+}
+
+/*
+ * The page id difference, then the slot number, or the slot number difference
+ * if the page ids are the same. The first RID of a page follows RID(0, 0).
+ */
+int BPlusTreePostingPage::EncodedSize(const RID &prev, const RID &rid) {
+  uint64_t page_delta = rid.GetPageId() - prev.GetPageId();
+  uint64_t slot = page_delta == 0 ? rid.GetSlotNum() - prev.GetSlotNum() : rid.GetSlotNum();
+  return VarintSize(page_delta) + VarintSize(slot);
+}
+
+uint8_t *BPlusTreePostingPage::EncodeRid(const RID &prev, const RID &rid, uint8_t *out) {
+  uint64_t page_delta = rid.GetPageId() - prev.GetPageId();
+  out = PutVarint(out, page_delta);
+  return PutVarint(out, page_delta == 0 ? rid.GetSlotNum() - prev.GetSlotNum() : rid.GetSlotNum());
+}
+
+const uint8_t *BPlusTreePostingPage::DecodeRid(const RID &prev, const uint8_t *in, RID *rid) {
+  uint64_t page_delta;
+  uint64_t slot;
+  in = GetVarint(in, &page_delta);
+  in = GetVarint(in, &slot);
+  *rid = RID(static_cast<page_id_t>(prev.GetPageId() + page_delta),
+             static_cast<uint32_t>(page_delta == 0 ? prev.GetSlotNum() + slot : slot));
+  return in;
+}
+
+bool BPlusTreePostingPage::Append(const RID &rid) {
+  RID prev = size_ == 0 ? RID(0, 0) : last_rid_;
+  if (used_ + EncodedSize(prev, rid) > CAPACITY) {
+    return false;
+  }
+  used_ = EncodeRid(prev, rid, data_ + used_) - data_;
+  last_rid_ = rid;
+  size_++;
+  return true;
+}
+
+int BPlusTreePostingPage::Encode(const RID *rids, int size) {
+  size_ = 0;
+  used_ = 0;
+  last_rid_ = RID(0, 0);
+  int count = 0;
+  while (count < size && Append(rids[count])) {
+    count++;
+  }
+  return count;
+}
+
+void BPlusTreePostingPage::Decode(std::vector<RID> *rids) const {
+  const uint8_t *in = data_;
+  RID prev(0, 0);
+  for (int i = 0; i < size_; i++) {
+    RID rid;
+    in = DecodeRid(prev, in, &rid);
+    rids->push_back(rid);
+    prev = rid;
+  }
+}
+
+/*****************************************************************************
+ * INLINE LIST
+ *****************************************************************************/
+/*
+ * The slot number holds 0xF, the number of RIDs and the first 3 bytes of the
+ * compressed RIDs, the page id the other 4.
+ */
+bool BPlusTreePostingPage::MakeInlineList(const RID *rids, int size, RID *list) {
+  if (size > INLINE_MAX_SIZE) {
+    return false;
+  }
+  int used = 0;
+  for (int i = 0; i < size; i++) {
+    used += EncodedSize(i == 0 ? RID(0, 0) : rids[i - 1], rids[i]);
+  }
+  if (used > INLINE_CAPACITY) {
+    return false;
+  }
+  uint8_t bytes[INLINE_CAPACITY] = {};
+  uint8_t *out = bytes;
+  for (int i = 0; i < size; i++) {
+    out = EncodeRid(i == 0 ? RID(0, 0) : rids[i - 1], rids[i], out);
+  }
+  uint32_t slot = 0xF0000000U | static_cast<uint32_t>(size) << 24 | bytes[0] << 16 | bytes[1] << 8 | bytes[2];
+  uint32_t page = static_cast<uint32_t>(bytes[3]) << 24 | bytes[4] << 16 | bytes[5] << 8 | bytes[6];
+  *list = RID(static_cast<page_id_t>(page), slot);
+  return true;
+}
+
+RID BPlusTreePostingPage::MakeList(BufferPoolManager *buffer_pool_manager, const RID *rids, int size) {
+  RID list;
+  if (size == 1) {
+    return rids[0];
+  }
+  if (MakeInlineList(rids, size, &list)) {
+    return list;
+  }
+  return ListRid(NewList(buffer_pool_manager, rids, size));
+}
+
+void BPlusTreePostingPage::ReadValues(BufferPoolManager *buffer_pool_manager, const RID &value,
+                                      std::vector<RID> *rids) {
+  if (IsListRid(value)) {
+    ReadList(buffer_pool_manager, value.GetPageId(), rids);
+    return;
+  }
+  if (!IsInlineListRid(value)) {
+    rids->push_back(value);
+    return;
+  }
+  uint32_t slot = value.GetSlotNum();
+  auto page = static_cast<uint32_t>(value.GetPageId());
+  uint8_t bytes[INLINE_CAPACITY] = {static_cast<uint8_t>(slot >> 16), static_cast<uint8_t>(slot >> 8),
+                                    static_cast<uint8_t>(slot),       static_cast<uint8_t>(page >> 24),
+                                    static_cast<uint8_t>(page >> 16), static_cast<uint8_t>(page >> 8),
+                                    static_cast<uint8_t>(page)};
+  int size = (slot >> 24) & 0xF;
+  const uint8_t *in = bytes;
+  RID prev(0, 0);
+  for (int i = 0; i < size; i++) {
+    RID rid;
+    in = DecodeRid(prev, in, &rid);
+    rids->push_back(rid);
+    prev = rid;
+  }
+}
+
+/*****************************************************************************
+ * LIST
+ *****************************************************************************/
+Page *BPlusTreePostingPage::FetchPage(BufferPoolManager *buffer_pool_manager, page_id_t page_id) {
+  Page *page = buffer_pool_manager->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a posting page");
+  }
+  return page;
+}
+
+BPlusTreePostingPage *BPlusTreePostingPage::NewPage(BufferPoolManager *buffer_pool_manager, page_id_t *page_id) {
+  Page *page = buffer_pool_manager->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a posting page");
+  }
+  auto *posting = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+  posting->Init(*page_id);
+  return posting;
+}
+
+page_id_t BPlusTreePostingPage::NewList(BufferPoolManager *buffer_pool_manager, const RID *rids, int size) {
+  page_id_t page_id;
+  auto *head = NewPage(buffer_pool_manager, &page_id);
+  int count = head->Encode(rids, size);
+  head->total_size_ = size;
+  page_id_t tail_page_id = page_id;
+  BPlusTreePostingPage *tail = head;
+  while (count < size) {
+    page_id_t new_page_id;
+    auto *new_tail = NewPage(buffer_pool_manager, &new_page_id);
+    count += new_tail->Encode(rids + count, size - count);
+    tail->next_page_id_ = new_page_id;
+    if (tail != head) {
+      buffer_pool_manager->UnpinPage(tail_page_id, true);
+    }
+    tail_page_id = new_page_id;
+    tail = new_tail;
+  }
+  head->tail_page_id_ = tail_page_id;
+  if (tail != head) {
+    buffer_pool_manager->UnpinPage(tail_page_id, true);
+  }
+  buffer_pool_manager->UnpinPage(page_id, true);
+  return page_id;
+}
+
+/*
+ * RIDs mostly come in increasing order, as the table grows, so they are appended
+ * to the last page of the list, which the first one keeps track of. Otherwise the
+ * page the RID belongs to is rewritten, and split if it overflows.
+ */
+bool BPlusTreePostingPage::InsertIntoList(BufferPoolManager *buffer_pool_manager, page_id_t page_id,
+                                          const RID &rid) {
+  Page *head_page = FetchPage(buffer_pool_manager, page_id);
+  auto *head = reinterpret_cast<BPlusTreePostingPage *>(head_page->GetData());
+
+  page_id_t tail_page_id = head->tail_page_id_;
+  Page *tail_page = tail_page_id == page_id ? head_page : FetchPage(buffer_pool_manager, tail_page_id);
+  auto *tail = reinterpret_cast<BPlusTreePostingPage *>(tail_page->GetData());
+  if (tail->last_rid_.Get() < rid.Get()) {
+    if (!tail->Append(rid)) {
+      page_id_t new_page_id;
+      auto *new_tail = NewPage(buffer_pool_manager, &new_page_id);
+      new_tail->Append(rid);
+      tail->next_page_id_ = new_page_id;
+      head->tail_page_id_ = new_page_id;
+      buffer_pool_manager->UnpinPage(new_page_id, true);
+    }
+    head->total_size_++;
+    if (tail_page != head_page) {
+      buffer_pool_manager->UnpinPage(tail_page_id, true);
+    }
+    buffer_pool_manager->UnpinPage(page_id, true);
+    return true;
+  }
+  if (tail_page != head_page) {
+    buffer_pool_manager->UnpinPage(tail_page_id, false);
+  }
+
+  // The first page whose last RID is not less than the RID.
+  page_id_t current_page_id = page_id;
+  Page *current_page = head_page;
+  auto *current = head;
+  while (current->last_rid_.Get() < rid.Get()) {
+    page_id_t next_page_id = current->next_page_id_;
+    if (current_page != head_page) {
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+    }
+    current_page_id = next_page_id;
+    current_page = FetchPage(buffer_pool_manager, current_page_id);
+    current = reinterpret_cast<BPlusTreePostingPage *>(current_page->GetData());
+  }
+  std::vector<RID> rids;
+  current->Decode(&rids);
+  auto it = std::lower_bound(rids.begin(), rids.end(), rid,
+                             [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); });
+  bool inserted = it == rids.end() || !(*it == rid);
+  if (inserted) {
+    rids.insert(it, rid);
+    int count = current->Encode(rids.data(), rids.size());
+    if (count < static_cast<int>(rids.size())) {
+      page_id_t new_page_id;
+      auto *new_page = NewPage(buffer_pool_manager, &new_page_id);
+      new_page->Encode(rids.data() + count, rids.size() - count);
+      new_page->next_page_id_ = current->next_page_id_;
+      current->next_page_id_ = new_page_id;
+      if (head->tail_page_id_ == current_page_id) {
+        head->tail_page_id_ = new_page_id;
+      }
+      buffer_pool_manager->UnpinPage(new_page_id, true);
+    }
+    head->total_size_++;
+  }
+  if (current_page != head_page) {
+    buffer_pool_manager->UnpinPage(current_page_id, inserted);
+  }
+  buffer_pool_manager->UnpinPage(page_id, inserted);
+  return inserted;
+}
+
+/*
+ * A page that becomes empty is unlinked and deleted. The first page of the list
+ * stays where it is, and takes over the RIDs of the second one instead.
+ */
+bool BPlusTreePostingPage::RemoveFromList(BufferPoolManager *buffer_pool_manager, page_id_t page_id, const RID &rid,
+                                          int *remaining) {
+  Page *head_page = FetchPage(buffer_pool_manager, page_id);
+  auto *head = reinterpret_cast<BPlusTreePostingPage *>(head_page->GetData());
+  *remaining = head->total_size_;
+
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  page_id_t current_page_id = page_id;
+  Page *current_page = head_page;
+  auto *current = head;
+  while (current->last_rid_.Get() < rid.Get() && current->next_page_id_ != INVALID_PAGE_ID) {
+    page_id_t next_page_id = current->next_page_id_;
+    if (current_page != head_page) {
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+    }
+    prev_page_id = current_page_id;
+    current_page_id = next_page_id;
+    current_page = FetchPage(buffer_pool_manager, current_page_id);
+    current = reinterpret_cast<BPlusTreePostingPage *>(current_page->GetData());
+  }
+  std::vector<RID> rids;
+  current->Decode(&rids);
+  auto it = std::find(rids.begin(), rids.end(), rid);
+  if (it == rids.end()) {
+    if (current_page != head_page) {
+      buffer_pool_manager->UnpinPage(current_page_id, false);
+    }
+    buffer_pool_manager->UnpinPage(page_id, false);
+    return false;
+  }
+  rids.erase(it);
+  current->Encode(rids.data(), rids.size());
+  head->total_size_--;
+  *remaining = head->total_size_;
+
+  if (current->size_ == 0 && current_page != head_page) {
+    Page *prev_page = FetchPage(buffer_pool_manager, prev_page_id);
+    auto *prev = reinterpret_cast<BPlusTreePostingPage *>(prev_page->GetData());
+    prev->next_page_id_ = current->next_page_id_;
+    if (head->tail_page_id_ == current_page_id) {
+      head->tail_page_id_ = prev_page_id;
+    }
+    buffer_pool_manager->UnpinPage(prev_page_id, true);
+    buffer_pool_manager->UnpinPage(current_page_id, true);
+    buffer_pool_manager->DeletePage(current_page_id);
+  } else if (current->size_ == 0 && head->next_page_id_ != INVALID_PAGE_ID) {
+    page_id_t next_page_id = head->next_page_id_;
+    Page *next_page = FetchPage(buffer_pool_manager, next_page_id);
+    auto *next = reinterpret_cast<BPlusTreePostingPage *>(next_page->GetData());
+    rids.clear();
+    next->Decode(&rids);
+    head->Encode(rids.data(), rids.size());
+    head->next_page_id_ = next->next_page_id_;
+    if (head->tail_page_id_ == next_page_id) {
+      head->tail_page_id_ = page_id;
+    }
+    buffer_pool_manager->UnpinPage(next_page_id, false);
+    buffer_pool_manager->DeletePage(next_page_id);
+  } else if (current_page != head_page) {
+    buffer_pool_manager->UnpinPage(current_page_id, true);
+  }
+  buffer_pool_manager->UnpinPage(page_id, true);
+  return true;
+}
+
+void BPlusTreePostingPage::ReadList(BufferPoolManager *buffer_pool_manager, page_id_t page_id,
+                                    std::vector<RID> *rids) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = FetchPage(buffer_pool_manager, page_id);
+    auto *posting = reinterpret_cast<BPlusTreePostingPage *>(page->GetData());
+    posting->Decode(rids);
+    page_id_t next_page_id = posting->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void BPlusTreePostingPage::DeleteList(BufferPoolManager *buffer_pool_manager, page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = FetchPage(buffer_pool_manager, page_id);
+    page_id_t next_page_id = reinterpret_cast<BPlusTreePostingPage *>(page->GetData())->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,37 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  // Set the page ID.
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetNextPageId(INVALID_PAGE_ID);
+  SetLastHeapPageId(INVALID_PAGE_ID);
+  SetEntryCount(0);
+}
+
+bool FreeSpaceMapPage::AppendEntry(page_id_t heap_page_id, uint8_t category, uint32_t *slot) {
+  if (IsFull()) {
+    return false;
+  }
+  uint32_t i = GetEntryCount();
+  memcpy(GetData() + OFFSET_HEAP_PAGE_IDS + sizeof(page_id_t) * i, &heap_page_id, sizeof(page_id_t));
+  SetCategory(i, category);
+  SetEntryCount(i + 1);
+  *slot = i;
+  return true;
+}
+
+}  // namespace bustub
@@ -11,36 +11,160 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_block_page.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/logger.h"
 #include "storage/index/generic_key.h"
 
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-KeyType HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
-  return {};
+void HASH_TABLE_BLOCK_TYPE::Init() {
+  num_readable_ = 0;
+  num_occupied_ = 0;
+  memset(control_, EMPTY, sizeof(control_));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
-  return {};
+uint32_t HASH_TABLE_BLOCK_TYPE::MatchGroup(uint32_t group_idx, int8_t control) const {
+  const int8_t *group = control_ + group_idx * BLOCK_GROUP_SIZE;
+#if defined(__SSE2__)
+  __m128i controls = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8(control)));
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < BLOCK_GROUP_SIZE; i++) {
+    matches |= static_cast<uint32_t>(group[i] == control) << i;
+  }
+  return matches;
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BLOCK_TYPE::MatchFree(uint32_t group_idx) const {
+  const int8_t *group = control_ + group_idx * BLOCK_GROUP_SIZE;
+#if defined(__SSE2__)
+  return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group)));
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < BLOCK_GROUP_SIZE; i++) {
+    matches |= static_cast<uint32_t>(group[i] < 0) << i;
+  }
+  return matches;
+#endif
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BLOCK_TYPE::GetValue(const KeyType &key, uint64_t hash, KeyComparator cmp,
+                                     std::vector<ValueType> *result) {
+  int8_t control = ControlByte(hash);
+  bool found = false;
+  uint32_t group_idx = StartGroup(hash);
+  for (uint32_t probes = 0; probes < NUM_GROUPS; probes++) {
+    for (uint32_t matches = MatchGroup(group_idx, control); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_ind = group_idx * BLOCK_GROUP_SIZE + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_ind].first) == 0) {
+        result->push_back(array_[bucket_ind].second);
+        found = true;
+      }
+    }
+    if (MatchEmpty(group_idx) != 0) {
+      break;
+    }
+    group_idx = (group_idx + 1) % NUM_GROUPS;
+  }
+  return found;
+}
+
+/*
+ * The probe goes on to the first group with an EMPTY slot to rule out a
+ * duplicate, and the pair goes into the first free slot it passed.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BLOCK_TYPE::Insert(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp) {
+  int8_t control = ControlByte(hash);
+  uint32_t free_ind = BLOCK_ARRAY_SIZE;
+  uint32_t group_idx = StartGroup(hash);
+  for (uint32_t probes = 0; probes < NUM_GROUPS; probes++) {
+    for (uint32_t matches = MatchGroup(group_idx, control); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_ind = group_idx * BLOCK_GROUP_SIZE + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_ind].first) == 0 && value == array_[bucket_ind].second) {
+        return false;
+      }
+    }
+    uint32_t free = MatchFree(group_idx);
+    if (free_ind == BLOCK_ARRAY_SIZE && free != 0) {
+      free_ind = group_idx * BLOCK_GROUP_SIZE + __builtin_ctz(free);
+    }
+    if (MatchEmpty(group_idx) != 0) {
+      break;
+    }
+    group_idx = (group_idx + 1) % NUM_GROUPS;
+  }
+  assert(free_ind < BLOCK_ARRAY_SIZE);
+  if (control_[free_ind] == EMPTY) {
+    num_occupied_++;
+  }
+  num_readable_++;
+  control_[free_ind] = control;
+  array_[free_ind] = MappingType(key, value);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
+bool HASH_TABLE_BLOCK_TYPE::Remove(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp) {
+  int8_t control = ControlByte(hash);
+  uint32_t group_idx = StartGroup(hash);
+  for (uint32_t probes = 0; probes < NUM_GROUPS; probes++) {
+    for (uint32_t matches = MatchGroup(group_idx, control); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_ind = group_idx * BLOCK_GROUP_SIZE + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_ind].first) == 0 && value == array_[bucket_ind].second) {
+        num_readable_--;
+        if (MatchEmpty(group_idx) != 0) {
+          control_[bucket_ind] = EMPTY;
+          num_occupied_--;
+        } else {
+          control_[bucket_ind] = DELETED;
+        }
+        return true;
+      }
+    }
+    if (MatchEmpty(group_idx) != 0) {
+      break;
+    }
+    group_idx = (group_idx + 1) % NUM_GROUPS;
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+KeyType HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].second;
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-  return false;
+  return control_[bucket_ind] != EMPTY;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-  return false;
+  return control_[bucket_ind] >= 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::PrintBucket() {
+  LOG_INFO("Block Capacity: %lu, Occupied: %u, Readable: %u, Tombstones: %u", BLOCK_ARRAY_SIZE, NumOccupied(),
+           NumReadable(), NumOccupied() - NumReadable());
 }
 
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
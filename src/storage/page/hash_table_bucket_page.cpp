@@ -11,6 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,63 +26,192 @@
 
 namespace bustub {
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint8_t HASH_TABLE_BUCKET_TYPE::Fingerprint(const KeyType &key) {
+  // Fold the key 8 bytes at a time with a multiplicative hash, and keep the top byte.
+  constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+  const auto *bytes = reinterpret_cast<const char *>(&key);
+  uint64_t hash = 0;
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= sizeof(KeyType); offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + offset, sizeof(uint64_t));
+    hash = (hash ^ word) * multiplier;
+  }
+  if (offset < sizeof(KeyType)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + offset, sizeof(KeyType) - offset);
+    hash = (hash ^ word) * multiplier;
+  }
+  return static_cast<uint8_t>(hash >> 56);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint64_t HASH_TABLE_BUCKET_TYPE::BitmapWord(const char *bitmap, uint32_t word_idx) {
+  constexpr size_t bitmap_size = (BUCKET_ARRAY_SIZE - 1) / 8 + 1;
+  size_t offset = word_idx * sizeof(uint64_t);
+  uint64_t word = 0;
+  memcpy(&word, bitmap + offset, std::min(sizeof(uint64_t), bitmap_size - offset));
+  return word;
+}
+
+/*
+ * The fingerprints of a group may run past the last slot, into the pairs of the
+ * page, which is harmless since the slots past the last one are never readable.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::MatchGroup(uint32_t group_idx, uint8_t fingerprint) const {
+  const uint8_t *fingerprints = fingerprints_ + group_idx * 32;
+  uint32_t matches;
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints));
+  matches = _mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(fingerprint))));
+#elif defined(__SSE2__)
+  __m128i target = _mm_set1_epi8(static_cast<char>(fingerprint));
+  __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints));
+  __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints + 16));
+  matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, target))) |
+            static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, target))) << 16;
+#else
+  matches = 0;
+  for (uint32_t i = 0; i < 32; i++) {
+    matches |= static_cast<uint32_t>(fingerprints[i] == fingerprint) << i;
+  }
+#endif
+  uint64_t readable = BitmapWord(readable_, group_idx / 2) >> (group_idx % 2 * 32);
+  return matches & static_cast<uint32_t>(readable);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::FirstFreeSlot() const {
+  for (uint32_t word_idx = 0; word_idx * 64 < BUCKET_ARRAY_SIZE; word_idx++) {
+    uint64_t free = ~BitmapWord(readable_, word_idx);
+    if (free != 0) {
+      return std::min<uint32_t>(word_idx * 64 + __builtin_ctzll(free), BUCKET_ARRAY_SIZE);
+    }
+  }
+  return BUCKET_ARRAY_SIZE;
+}
+
+/*
+ * Slots are taken in order and never become unoccupied again, so the occupied
+ * slots are a prefix of the bucket and the scans stop at the first group that
+ * is not occupied.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
-  return false;
+  uint8_t fingerprint = Fingerprint(key);
+  bool found = false;
+  for (uint32_t group_idx = 0; group_idx * 32 < BUCKET_ARRAY_SIZE && IsOccupied(group_idx * 32); group_idx++) {
+    for (uint32_t matches = MatchGroup(group_idx, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_idx * 32 + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_idx].first) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
 }
 
+/*
+ * The pair goes into the first slot that is not readable: the first tombstone,
+ * or the first slot after the occupied ones if there is none.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) {
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t group_idx = 0; group_idx * 32 < BUCKET_ARRAY_SIZE && IsOccupied(group_idx * 32); group_idx++) {
+    for (uint32_t matches = MatchGroup(group_idx, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_idx * 32 + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_idx].first) == 0 && value == array_[bucket_idx].second) {
+        return false;
+      }
+    }
+  }
+  uint32_t free_idx = FirstFreeSlot();
+  if (free_idx == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  fingerprints_[free_idx] = fingerprint;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) {
+  uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t group_idx = 0; group_idx * 32 < BUCKET_ARRAY_SIZE && IsOccupied(group_idx * 32); group_idx++) {
+    for (uint32_t matches = MatchGroup(group_idx, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = group_idx * 32 + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_idx].first) == 0 && value == array_[bucket_idx].second) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1U << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1U << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1U << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const {
-  return false;
+  return (readable_[bucket_idx / 8] & (1U << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1U << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsFull() {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() {
-  return 0;
+  uint32_t count = 0;
+  for (uint32_t word_idx = 0; word_idx * 64 < BUCKET_ARRAY_SIZE; word_idx++) {
+    count += __builtin_popcountll(BitmapWord(readable_, word_idx));
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsEmpty() {
-  return false;
+  for (uint32_t word_idx = 0; word_idx * 64 < BUCKET_ARRAY_SIZE; word_idx++) {
+    if (BitmapWord(readable_, word_idx) != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
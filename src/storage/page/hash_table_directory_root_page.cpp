@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_root_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_root_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_root_page.h"
+
+namespace bustub {
+page_id_t HashTableDirectoryRootPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryRootPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryRootPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryRootPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryRootPage::GetGlobalDepth() const { return global_depth_; }
+
+void HashTableDirectoryRootPage::SetGlobalDepth(uint32_t global_depth) {
+  assert(global_depth <= MAX_GLOBAL_DEPTH);
+  global_depth_ = global_depth;
+}
+
+uint32_t HashTableDirectoryRootPage::NumDirectoryPages() const {
+  return global_depth_ <= DIRECTORY_PAGE_DEPTH ? 1 : 1U << (global_depth_ - DIRECTORY_PAGE_DEPTH);
+}
+
+page_id_t HashTableDirectoryRootPage::GetDirectoryPageId(uint32_t directory_page_idx) const {
+  return directory_page_ids_[directory_page_idx];
+}
+
+void HashTableDirectoryRootPage::SetDirectoryPageId(uint32_t directory_page_idx, page_id_t directory_page_id) {
+  directory_page_ids_[directory_page_idx] = directory_page_id;
+}
+
+}  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager)
+    : buffer_pool_manager_(buffer_pool_manager), buckets_(FSM_NUM_CATEGORIES) {
+  auto root_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&root_page_id_));
+  if (root_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't create a page for the free space map.");
+  }
+  root_page->Init(root_page_id_);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  fsm_page_ids_.push_back(root_page_id_);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), root_page_id_(root_page_id), buckets_(FSM_NUM_CATEGORIES) {
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    throw Exception(ExceptionType::INVALID, "Can't open a free space map without a root page.");
+  }
+  // Load every FSM page of the chain into the in-memory buckets.
+  auto page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = FetchFsmPage(page_id);
+    if (page_id == root_page_id_) {
+      last_heap_page_id_ = page->GetLastHeapPageId();
+    }
+    for (uint32_t slot = 0; slot < page->GetEntryCount(); slot++) {
+      Entry entry{fsm_page_ids_.size(), slot, page->GetCategory(slot), 0, heap_page_ids_.size()};
+      BucketInsert(page->GetHeapPageId(slot), &entry);
+      entries_.emplace(page->GetHeapPageId(slot), entry);
+      heap_page_ids_.push_back(page->GetHeapPageId(slot));
+    }
+    fsm_page_ids_.push_back(page_id);
+    auto next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t required_bytes) {
+  // Any page in category c or above has at least c * FSM_CATEGORY_SIZE bytes, so round the request up.
+  uint32_t category = (required_bytes + FSM_CATEGORY_SIZE - 1) / FSM_CATEGORY_SIZE;
+  if (category >= FSM_NUM_CATEGORIES) {
+    return INVALID_PAGE_ID;
+  }
+  std::scoped_lock latch(latch_);
+  uint64_t candidates = non_empty_buckets_ & (~0ULL << category);
+  if (candidates == 0) {
+    return INVALID_PAGE_ID;
+  }
+  // Prefer the fullest page that still fits, which keeps the table compact.
+  return buckets_[__builtin_ctzll(candidates)].back();
+}
+
+void FreeSpaceMap::UpdatePage(page_id_t heap_page_id, uint32_t free_bytes) {
+  uint8_t category = ToCategory(free_bytes);
+  std::scoped_lock latch(latch_);
+  auto it = entries_.find(heap_page_id);
+  if (it == entries_.end()) {
+    AddEntry(heap_page_id, category);
+    return;
+  }
+  auto &entry = it->second;
+  if (entry.category_ == category) {
+    return;
+  }
+  BucketRemove(entry);
+  entry.category_ = category;
+  BucketInsert(heap_page_id, &entry);
+
+  auto page = FetchFsmPage(fsm_page_ids_[entry.fsm_index_]);
+  page->SetCategory(entry.slot_, category);
+  buffer_pool_manager_->UnpinPage(page->GetFsmPageId(), true);
+}
+
+void FreeSpaceMap::AppendPage(page_id_t heap_page_id, uint32_t free_bytes) {
+  std::scoped_lock latch(latch_);
+  AddEntry(heap_page_id, ToCategory(free_bytes));
+  last_heap_page_id_ = heap_page_id;
+
+  auto root_page = FetchFsmPage(root_page_id_);
+  root_page->SetLastHeapPageId(heap_page_id);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+}
+
+page_id_t FreeSpaceMap::GetFirstPageId() {
+  std::scoped_lock latch(latch_);
+  return heap_page_ids_.empty() ? INVALID_PAGE_ID : heap_page_ids_.front();
+}
+
+page_id_t FreeSpaceMap::GetLastPageId() {
+  std::scoped_lock latch(latch_);
+  return last_heap_page_id_;
+}
+
+size_t FreeSpaceMap::GetNumPages() {
+  std::scoped_lock latch(latch_);
+  return entries_.size();
+}
+
+void FreeSpaceMap::GetPagesAfter(page_id_t heap_page_id, size_t max_pages, std::vector<page_id_t> *page_ids) {
+  std::scoped_lock latch(latch_);
+  auto it = entries_.find(heap_page_id);
+  if (it == entries_.end()) {
+    return;
+  }
+  for (size_t pos = it->second.chain_pos_ + 1; pos < heap_page_ids_.size() && page_ids->size() < max_pages; pos++) {
+    page_ids->push_back(heap_page_ids_[pos]);
+  }
+}
+
+void FreeSpaceMap::GetPageIds(std::vector<page_id_t> *page_ids) {
+  std::scoped_lock latch(latch_);
+  page_ids->insert(page_ids->end(), heap_page_ids_.begin(), heap_page_ids_.end());
+}
+
+void FreeSpaceMap::BucketInsert(page_id_t heap_page_id, Entry *entry) {
+  auto &bucket = buckets_[entry->category_];
+  entry->bucket_pos_ = bucket.size();
+  bucket.push_back(heap_page_id);
+  non_empty_buckets_ |= 1ULL << entry->category_;
+}
+
+void FreeSpaceMap::BucketRemove(const Entry &entry) {
+  // Swap the page with the last one of the bucket so that removal is O(1).
+  auto &bucket = buckets_[entry.category_];
+  auto moved_page_id = bucket.back();
+  bucket[entry.bucket_pos_] = moved_page_id;
+  entries_.find(moved_page_id)->second.bucket_pos_ = entry.bucket_pos_;
+  bucket.pop_back();
+  if (bucket.empty()) {
+    non_empty_buckets_ &= ~(1ULL << entry.category_);
+  }
+}
+
+void FreeSpaceMap::AddEntry(page_id_t heap_page_id, uint8_t category) {
+  auto last_page = FetchFsmPage(fsm_page_ids_.back());
+  uint32_t slot;
+  if (!last_page->AppendEntry(heap_page_id, category, &slot)) {
+    // The last FSM page is full, chain a new one after it.
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&new_page_id));
+    if (new_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(last_page->GetFsmPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't create a page for the free space map.");
+    }
+    new_page->Init(new_page_id);
+    last_page->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(last_page->GetFsmPageId(), true);
+    fsm_page_ids_.push_back(new_page_id);
+    last_page = new_page;
+    last_page->AppendEntry(heap_page_id, category, &slot);
+  }
+  buffer_pool_manager_->UnpinPage(last_page->GetFsmPageId(), true);
+
+  Entry entry{fsm_page_ids_.size() - 1, slot, category, 0, heap_page_ids_.size()};
+  BucketInsert(heap_page_id, &entry);
+  entries_.emplace(heap_page_id, entry);
+  heap_page_ids_.push_back(heap_page_id);
+}
+
+FreeSpaceMapPage *FreeSpaceMap::FetchFsmPage(page_id_t page_id) {
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a free space map page.");
+  }
+  return page;
+}
+
+}  // namespace bustub
@@ -11,18 +11,43 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <vector>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, page_id_t fsm_page_id)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  if (fsm_page_id != INVALID_PAGE_ID) {
+    fsm_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, fsm_page_id);
+    if (first_page_id_ == INVALID_PAGE_ID) {
+      first_page_id_ = fsm_->GetFirstPageId();
+    }
+    return;
+  }
+  // Nobody remembered where the free space map lives, rebuild it by walking the page list.
+  fsm_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a table page to rebuild the free space map.");
+    }
+    page->RLatch();
+    fsm_->AppendPage(page_id, page->GetFreeSpaceRemaining());
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
@@ -32,64 +57,84 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  // Create the free space map.
+  fsm_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
+  fsm_->AppendPage(first_page_id_, first_page->GetFreeSpaceRemaining());
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
+  if (tuple.size_ + TablePage::SIZE_TABLE_PAGE_HEADER + TablePage::SIZE_TUPLE > PAGE_SIZE) {  // larger than one page
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
-    txn->SetState(TransactionState::ABORTED);
-    return false;
-  }
-
-  cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+  uint32_t required_bytes = tuple.size_ + TablePage::SIZE_TUPLE;
+  // Ask the free space map for a page with enough space. If there is no such page, append a new page to the table.
+  while (true) {
+    auto page_id = fsm_->FindPage(required_bytes);
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = ExtendTable(required_bytes, txn, strategy);
+      // If we could not create a new page, then life sucks and we abort the transaction.
+      if (page_id == INVALID_PAGE_ID) {
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+    }
+
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+    if (cur_page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+    bool inserted = cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    // The map is only a hint. Whether or not the tuple fit, record how much space the page really has left.
+    fsm_->UpdatePage(page_id, cur_page->GetFreeSpaceRemaining());
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      break;
     }
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+page_id_t TableHeap::ExtendTable(uint32_t required_bytes, Transaction *txn, BufferAccessStrategy *strategy) {
+  std::scoped_lock extend_latch(extend_latch_);
+  // Another thread may have made room while we were waiting for the latch.
+  auto page_id = fsm_->FindPage(required_bytes);
+  if (page_id != INVALID_PAGE_ID) {
+    return page_id;
+  }
+
+  auto last_page_id = fsm_->GetLastPageId();
+  auto last_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(last_page_id, strategy));
+  if (last_page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  page_id_t new_page_id;
+  auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPageWithStrategy(&new_page_id, strategy));
+  if (new_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(last_page_id, false);
+    return INVALID_PAGE_ID;
+  }
+  // Link the new page after the current last page and initialize it.
+  new_page->WLatch();
+  last_page->WLatch();
+  last_page->SetNextPageId(new_page_id);
+  new_page->Init(new_page_id, PAGE_SIZE, last_page_id, log_manager_, txn);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+  fsm_->AppendPage(new_page_id, new_page->GetFreeSpaceRemaining());
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  return new_page_id;
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -121,6 +166,9 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   Tuple old_tuple;
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    fsm_->UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
@@ -137,6 +185,7 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Delete the tuple from the page.
   page->WLatch();
   page->ApplyDelete(rid, txn, log_manager_);
+  fsm_->UpdatePage(rid.GetPageId(), page->GetFreeSpaceRemaining());
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
@@ -169,13 +218,54 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+bool TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn) {
+  for (size_t i = 0; i < rids.size();) {
+    page_id_t page_id = rids[i].GetPageId();
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->RLatch();
+    for (; i < rids.size() && rids[i].GetPageId() == page_id; i++) {
+      Tuple tuple;
+      if (page->GetTuple(rids[i], &tuple, txn, lock_manager_)) {
+        tuples->push_back(tuple);
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  return true;
+}
+
+bool TableHeap::GetPageTuples(page_id_t page_id, std::vector<Tuple> *tuples, Transaction *txn,
+                              BufferAccessStrategy *strategy) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
+  if (page == nullptr) {
+    return false;
+  }
+  page->RLatch();
+  RID rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    Tuple tuple;
+    if (page->GetTuple(rid, &tuple, txn, lock_manager_)) {
+      tuples->push_back(tuple);
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
+  Prefetch(page_id, strategy);
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
@@ -186,9 +276,19 @@ TableIterator TableHeap::Begin(Transaction *txn) {
     }
     page_id = page->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
+}
+
+void TableHeap::Prefetch(page_id_t page_id, BufferAccessStrategy *strategy, size_t num_pages) {
+  std::vector<page_id_t> page_ids;
+  fsm_->GetPagesAfter(page_id, num_pages, &page_ids);
+  if (!page_ids.empty()) {
+    buffer_pool_manager_->Prefetch(page_ids, strategy);
+  }
 }
 
+bool TableHeap::ScanNeedsBufferRing() { return fsm_->GetNumPages() > buffer_pool_manager_->GetPoolSize() / 4; }
+
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
 }  // namespace bustub
@@ -27,7 +27,8 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   // 1. Calculate the size of the tuple.
   uint32_t tuple_size = schema->GetLength();
   for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    // A NULL varchar is only its length field.
+    tuple_size += ((values[i].IsNull() ? 0 : values[i].GetLength()) + sizeof(uint32_t));
   }
 
   // 2. Allocate memory.
@@ -46,7 +47,7 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
       *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
       values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      offset += ((values[i].IsNull() ? 0 : values[i].GetLength()) + sizeof(uint32_t));
     } else {
       values[i].SerializeTo(data_ + col.GetOffset());
     }
@@ -11,17 +11,21 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/page_cleaner.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
+TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -86,7 +90,7 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
+TEST(BufferPoolManagerInstanceTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -141,4 +145,400 @@ TEST(BufferPoolManagerInstanceTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  const int num_threads = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Create more pages than fit in the pool, tagging every page with its own id.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: threads hammer a small hot set that stays cached and a cold set that forces evictions.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> hot_dist(0, 3);
+      std::uniform_int_distribution<int> cold_dist(0, num_pages - 1);
+      for (int i = 0; i < 5000; ++i) {
+        page_id_t page_id = i % 4 == 0 ? cold_dist(rng) : hot_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;  // every frame is pinned by the other threads
+        }
+        char expected[32];
+        snprintf(expected, sizeof(expected), "page %d", page_id);
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: all pins were released, so every frame can be reused.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const int buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Create twice as many pages as fit in the pool, so that the first half is evicted.
+  for (int i = 0; i < 2 * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: prefetched pages can be fetched, whether or not their reads have completed yet.
+  bpm->Prefetch({0, 1, 2, 3, 4});
+  for (int i = 0; i < 5; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+  }
+
+  // Scenario: with every frame pinned, prefetching is a no-op.
+  std::vector<page_id_t> new_page_ids;
+  for (int i = 0; i < 5; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    new_page_ids.push_back(page_id_temp);
+  }
+  bpm->Prefetch({5, 6, 7, 8, 9});
+  EXPECT_EQ(nullptr, bpm->FetchPage(5));
+
+  // Scenario: unpinned prefetched pages can be evicted again.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+    EXPECT_TRUE(bpm->UnpinPage(new_page_ids[i], false));
+  }
+  bpm->Prefetch({5, 6, 7, 8, 9});
+  for (int i = 10; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: a page can be deleted while it is being prefetched, and its frame is reused afterwards.
+  bpm->Prefetch({0});
+  EXPECT_TRUE(bpm->DeletePage(0));
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchLRUKTest) {
+  const std::string db_name = "test.db";
+  const int buffer_pool_size = 10;
+  const int num_prefetched = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  // The pages stay clean, so that the page cleaner never holds on to a frame that a prefetch could use.
+  for (int i = 0; i < 2 * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Prefetch some of the evicted pages, then read in as many pages as the pool has other frames.
+  std::vector<page_id_t> prefetched;
+  for (int i = 0; i < num_prefetched; ++i) {
+    prefetched.push_back(i);
+  }
+  bpm->Prefetch(prefetched);
+  // Let the reads land, so that the pool has to choose between the prefetched pages and the cached ones.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  for (int i = num_prefetched; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // The prefetched pages are more recent than the pages that were already in the pool, so they must still be there.
+  int num_reads = disk_manager->GetNumReads();
+  for (auto page_id : prefetched) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BufferRingTest) {
+  const std::string db_name = "test.db";
+  const int buffer_pool_size = 20;
+  const int num_hot_pages = 10;
+  const int num_scan_pages = 50;
+  const size_t ring_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  {
+    // Write the pages through a throwaway pool, so that the pool under test starts out empty.
+    BufferPoolManagerInstance loader(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_hot_pages + num_scan_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = loader.NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+      EXPECT_TRUE(loader.UnpinPage(page_id_temp, true));
+    }
+    loader.FlushAllPages();
+  }
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: a scan through a ring reads every page it has not seen, but only ever holds ring_size of them.
+  BufferAccessStrategy strategy(ring_size);
+  int num_reads = disk_manager->GetNumReads();
+  for (int i = num_hot_pages; i < num_hot_pages + num_scan_pages; ++i) {
+    auto *page = bpm->FetchPageWithStrategy(i, &strategy);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_reads + num_scan_pages, disk_manager->GetNumReads());
+  size_t num_scan_frames = 0;
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    num_scan_frames += bpm->GetPages()[i].GetPageId() >= num_hot_pages ? 1 : 0;
+  }
+  EXPECT_EQ(ring_size, num_scan_frames);
+
+  // Scenario: the pages that were cached before the scan are still cached.
+  num_reads = disk_manager->GetNumReads();
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+
+  // Scenario: a scan shares the pages that are already cached rather than reading them into its ring.
+  BufferAccessStrategy second_strategy(ring_size);
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPageWithStrategy(i, &second_strategy));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+
+  // Scenario: a ring frame that is still pinned is not reused; the scan takes another frame from the pool.
+  page_id_t pinned_page_id = num_hot_pages + num_scan_pages - 1;
+  ASSERT_NE(nullptr, bpm->FetchPageWithStrategy(pinned_page_id, &strategy));
+  for (int i = num_hot_pages; i < num_hot_pages + static_cast<int>(ring_size) * 2; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPageWithStrategy(i, &strategy));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  auto *pinned_page = bpm->FetchPage(pinned_page_id);
+  ASSERT_NE(nullptr, pinned_page);
+  char expected[32];
+  snprintf(expected, sizeof(expected), "page %d", pinned_page_id);
+  EXPECT_EQ(0, strcmp(pinned_page->GetData(), expected));
+  EXPECT_TRUE(bpm->UnpinPage(pinned_page_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(pinned_page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** Wait up to a second for the disk manager to have done num_writes writes. */
+static void WaitForWrites(DiskManager *disk_manager, int num_writes) {
+  for (int i = 0; i < 1000 && disk_manager->GetNumWrites() < num_writes; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const int buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  // An instance of a parallel pool does not start a cleaner of its own.
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, 1, 0, disk_manager);
+
+  // Scenario: fill the pool with dirty pages and let go of them.
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: a cleaner that keeps the whole pool clean writes every page in the background.
+  auto *page_cleaner = new PageCleaner({bpm}, 100);
+  WaitForWrites(disk_manager, buffer_pool_size);
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumWrites());
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_FALSE(bpm->GetPages()[i].IsDirty());
+  }
+  delete page_cleaner;
+
+  // Scenario: evicting the pages now needs no writes, and they can still be read back.
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumWrites());
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerWalTest) {
+  const std::string db_name = "test.db";
+  const int buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, 1, 0, disk_manager, log_manager);
+  enable_logging = true;
+
+  // Scenario: pages whose log records are not persistent yet must stay in memory.
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(i);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  log_manager->SetPersistentLSN(4);
+  EXPECT_EQ(5U, bpm->CleanFrames(buffer_pool_size));
+  EXPECT_EQ(5, disk_manager->GetNumWrites());
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(i > 4, bpm->GetPages()[i].IsDirty());
+  }
+
+  // Scenario: once the log catches up, the rest can go.
+  log_manager->SetPersistentLSN(buffer_pool_size);
+  EXPECT_EQ(5U, bpm->CleanFrames(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumWrites());
+
+  enable_logging = false;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, EvictionWalTest) {
+  const std::string db_name = "test.db";
+  const int buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, 1, 0, disk_manager, log_manager);
+  enable_logging = true;
+
+  // Scenario: dirty pages whose log records are not persistent yet are not evicted.
+  page_id_t page_id_temp;
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(i);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: once the log covers some of them, those are evicted and the rest stays in memory.
+  log_manager->SetPersistentLSN(1);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(2, disk_manager->GetNumWrites());
+  bool resident = false;
+  for (int i = 0; i < buffer_pool_size; ++i) {
+    if (bpm->GetPages()[i].GetPageId() == 2) {
+      resident = true;
+      EXPECT_TRUE(bpm->GetPages()[i].IsDirty());
+    }
+  }
+  EXPECT_TRUE(resident);
+
+  enable_logging = false;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+}
+
 }  // namespace bustub
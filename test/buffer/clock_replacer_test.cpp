@@ -19,7 +19,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +59,27 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, RecordAccessTest) {
+  ClockReplacer clock_replacer(7);
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+
+  // Scenario: the first sweep clears every bit and stops at 1.
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+
+  // Scenario: an access sets the bit of 2 again, so the hand passes over it once more.
+  clock_replacer.RecordAccess(2);
+  std::vector<frame_id_t> frame_ids;
+  clock_replacer.PeekVictims(2, &frame_ids);
+  EXPECT_EQ((std::vector<frame_id_t>{3, 2}), frame_ids);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+}
+
 }  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  // Every access is a separate reference.
+  LRUKReplacer lru_k_replacer(7, 2, 0, 1);
+
+  // Scenario: access six frames, and frame 1 a second time.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_k_replacer.RecordAccess(frame_id);
+  }
+  lru_k_replacer.RecordAccess(1);
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames referenced only once go first, least recently accessed first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: a pinned frame is not a victim, and a second reference protects frame 4.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.RecordAccess(4);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+
+  // Scenario: among frames with two references, the one whose second to last reference is oldest goes first.
+  lru_k_replacer.Unpin(5);
+  std::vector<frame_id_t> frame_ids;
+  lru_k_replacer.PeekVictims(3, &frame_ids);
+  EXPECT_EQ((std::vector<frame_id_t>{5, 1, 4}), frame_ids);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, CorrelatedAccessTest) {
+  LRUKReplacer lru_k_replacer(3, 2, 2, 1);
+
+  // Scenario: back to back accesses, like a scan over the tuples of a page, are a single reference.
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(2);
+  // Scenario: frame 1 is accessed again after more than the correlated period, which is a second reference.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+}
+
+TEST(LRUKReplacerTest, CoarseClockTest) {
+  LRUKReplacer lru_k_replacer(3, 2, 0, 4);
+
+  // Scenario: only the first access and every fourth one move the clock. The accesses in between happen at the same
+  // time, which makes them a single reference.
+  for (int i = 0; i < 4; i++) {
+    lru_k_replacer.RecordAccess(0);
+  }
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  std::vector<frame_id_t> frame_ids;
+  lru_k_replacer.PeekVictims(3, &frame_ids);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 1, 2}), frame_ids);
+
+  // Scenario: the fifth access to frame 0 moves the clock again, and is its second reference.
+  lru_k_replacer.RecordAccess(0);
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+}
+
+TEST(LRUKReplacerTest, RemoveTest) {
+  LRUKReplacer lru_k_replacer(3, 2, 0, 1);
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(0);
+  lru_k_replacer.Unpin(1);
+
+  // Scenario: a removed frame comes back without its history.
+  lru_k_replacer.Remove(0);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.Unpin(0);
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+}
+
+}  // namespace bustub
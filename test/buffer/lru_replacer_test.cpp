@@ -19,7 +19,7 @@
 
 namespace bustub {
 
-TEST(LRUReplacerTest, DISABLED_SampleTest) {
+TEST(LRUReplacerTest, SampleTest) {
   LRUReplacer lru_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +59,43 @@ TEST(LRUReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(LRUReplacerTest, PeekVictimsTest) {
+  LRUReplacer lru_replacer(7);
+  lru_replacer.Unpin(3);
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+
+  // Scenario: peeking returns the next victims in order and leaves them in the replacer.
+  std::vector<frame_id_t> frame_ids;
+  lru_replacer.PeekVictims(2, &frame_ids);
+  EXPECT_EQ((std::vector<frame_id_t>{3, 1}), frame_ids);
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+}
+
+TEST(LRUReplacerTest, RecordAccessTest) {
+  LRUReplacer lru_replacer(7);
+  lru_replacer.Unpin(1);
+  lru_replacer.Unpin(2);
+  lru_replacer.Unpin(3);
+
+  // Scenario: 1 is accessed while in the replacer, so it gets a second chance.
+  lru_replacer.RecordAccess(1);
+  std::vector<frame_id_t> frame_ids;
+  lru_replacer.PeekVictims(3, &frame_ids);
+  EXPECT_EQ((std::vector<frame_id_t>{2, 3}), frame_ids);
+
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(0, lru_replacer.Size());
+}
+
 }  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_benchmark_test.cpp
+//
+// Identification: test/buffer/replacer_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/*
+ * The trace is a table scan running next to index lookups. Every lookup reads the root and one leaf of the index. The
+ * leaves are hot, but a lookup only comes by every few table pages, so a leaf is reused after more distinct pages than
+ * the pool holds. The scan fetches each table page once per tuple.
+ */
+static constexpr size_t POOL_SIZE = 64;
+static constexpr page_id_t NUM_INDEX_PAGES = 40;
+static constexpr page_id_t NUM_TABLE_PAGES = 1000;
+static constexpr int FETCHES_PER_TABLE_PAGE = 20;
+static constexpr int TABLE_PAGES_PER_LOOKUP = 4;
+static constexpr int NUM_WARMUP_LOOKUPS = 2000;
+
+struct TraceResult {
+  int fetches_{0};
+  int reads_{0};
+};
+
+/** Warm the pool up with lookups alone, then replay the scan with the lookups and count its page reads. */
+static TraceResult ReplayTrace(DiskManager *disk_manager, ReplacerType replacer_type) {
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(POOL_SIZE, disk_manager, nullptr, replacer_type);
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> leaf(1, NUM_INDEX_PAGES - 1);
+  TraceResult result;
+  auto fetch = [&](page_id_t page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    EXPECT_NE(nullptr, page);
+    bpm->UnpinPage(page_id, false);
+    result.fetches_++;
+  };
+  auto lookup = [&] {
+    fetch(0);
+    fetch(leaf(rng));
+  };
+
+  for (int i = 0; i < NUM_WARMUP_LOOKUPS; i++) {
+    lookup();
+  }
+  result.fetches_ = 0;
+  int num_reads = disk_manager->GetNumReads();
+  for (page_id_t i = 0; i < NUM_TABLE_PAGES; i++) {
+    for (int j = 0; j < FETCHES_PER_TABLE_PAGE; j++) {
+      fetch(NUM_INDEX_PAGES + i);
+    }
+    if (i % TABLE_PAGES_PER_LOOKUP == 0) {
+      lookup();
+    }
+  }
+  result.reads_ = disk_manager->GetNumReads() - num_reads;
+  return result;
+}
+
+// NOLINTNEXTLINE
+TEST(ReplacerBenchmarkTest, MixedScanLookupTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  for (page_id_t page_id = 0; page_id < NUM_INDEX_PAGES + NUM_TABLE_PAGES; page_id++) {
+    disk_manager->WritePage(page_id, zeros.data());
+  }
+
+  std::vector<TraceResult> results;
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+    results.push_back(ReplayTrace(disk_manager, replacer_type));
+  }
+
+  // The scan has to read every table page, LRU-K should not have to read the index pages again.
+  EXPECT_LT(results[2].reads_, results[0].reads_);
+  EXPECT_LT(results[2].reads_, results[1].reads_);
+  EXPECT_LE(results[2].reads_, NUM_TABLE_PAGES + NUM_INDEX_PAGES);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdint>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -148,7 +149,8 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
 
   // Basic empty table attributes
   {
-    EXPECT_EQ(table_metadata->table_->GetFirstPageId(), 0);
+    // Page 0 is the header page of the catalog.
+    EXPECT_EQ(table_metadata->table_->GetFirstPageId(), 1);
     EXPECT_EQ(table_metadata->name_, table_name);
     EXPECT_EQ(table_metadata->schema_.GetColumnCount(), columns.size());
     for (std::size_t i = 0; i < columns.size(); ++i) {
@@ -175,6 +177,56 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
   }
 }
 
+// A table opened by a later catalog finds its free space map through the header page
+TEST(CatalogTest, OpenTableTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+
+  Schema schema{{Column("A", TypeId::INTEGER), Column("B", TypeId::VARCHAR, 200)}};
+  auto *table_info = catalog->CreateTable(nullptr, "foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog->CreateTable(nullptr, std::string(32, 'a'), schema));
+  Transaction txn(0);
+  const int32_t num_tuples = 200;
+  for (int32_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(150, 'x'))}, &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, &txn));
+  }
+  page_id_t first_page_id = table_info->table_->GetFirstPageId();
+  page_id_t fsm_page_id = table_info->table_->GetFreeSpaceMap()->GetRootPageId();
+  size_t num_pages = table_info->table_->GetFreeSpaceMap()->GetNumPages();
+  ASSERT_GT(num_pages, 1);
+  page_id_t header_page_id = catalog->GetHeaderPageId();
+  bpm->FlushAllPages();
+
+  // Reopen on a cold buffer pool.
+  catalog.reset();
+  bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr, header_page_id);
+  EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog->OpenTable("missing", schema));
+  table_info = catalog->OpenTable("foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  EXPECT_EQ(table_info, catalog->GetTable("foobar"));
+  EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog->OpenTable("foobar", schema));
+
+  // The map was read back, not rebuilt into a new chain of pages.
+  EXPECT_EQ(fsm_page_id, table_info->table_->GetFreeSpaceMap()->GetRootPageId());
+  EXPECT_EQ(num_pages, table_info->table_->GetFreeSpaceMap()->GetNumPages());
+  EXPECT_EQ(first_page_id, table_info->table_->GetFirstPageId());
+  int32_t expected = 0;
+  for (auto it = table_info->table_->Begin(&txn); it != table_info->table_->End(); ++it) {
+    EXPECT_EQ(expected++, it->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(num_tuples, expected);
+
+  catalog.reset();
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+}
+
 // Vanilla index creation for valid table
 TEST(CatalogTest, DISABLED_CreateIndex1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
@@ -217,6 +269,150 @@ TEST(CatalogTest, DISABLED_CreateIndex1) {
   remove("catalog_test.log");
 }
 
+// An index on more entries than BulkLoad sorts in memory is built from sorted runs that spill to pages
+TEST(CatalogTest, CreateIndexExternalSortTest) {
+  using TreeIndexType = BPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>;
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  Schema schema{{Column("A", TypeId::BIGINT), Column("B", TypeId::INTEGER)}};
+  auto *table_info = catalog->CreateTable(nullptr, "foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  // Enough runs for two rounds of merges, with each key twice and in descending order.
+  const int64_t entries_per_page = (PAGE_SIZE - sizeof(uint32_t)) / sizeof(std::pair<BigintKeyType, RID>);
+  const int64_t run_size = TreeIndexType::BULK_LOAD_RUN_PAGES * entries_per_page;
+  const int64_t num_tuples = (TreeIndexType::BULK_LOAD_FAN_IN + 1) * run_size + 100;
+  for (int64_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetBigIntValue((num_tuples - i) / 2), ValueFactory::GetIntegerValue(0)}, &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, &txn));
+  }
+
+  Schema key_schema{{Column("A", TypeId::BIGINT)}};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      &txn, "index1", "foobar", schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{},
+      IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *index = dynamic_cast<TreeIndexType *>(index_info->index_.get());
+  ASSERT_NE(nullptr, index);
+
+  // Every entry is in the tree, by key and then by RID.
+  BigintComparatorType comparator;
+  int64_t num_entries = 0;
+  int64_t num_keys = 0;
+  std::pair<BigintKeyType, RID> prev;
+  for (auto it = index->GetBeginIterator(); !it.IsEnd(); ++it) {
+    const auto &entry = *it;
+    if (num_entries > 0) {
+      int cmp = comparator(prev.first, entry.first);
+      ASSERT_LE(cmp, 0);
+      ASSERT_TRUE(cmp < 0 || prev.second.Get() < entry.second.Get());
+      num_keys += cmp < 0 ? 1 : 0;
+    } else {
+      num_keys++;
+    }
+    prev = entry;
+    num_entries++;
+  }
+  EXPECT_EQ(num_tuples, num_entries);
+  EXPECT_EQ(num_tuples / 2 + 1, num_keys);
+
+  // The runs left no frame pinned.
+  std::vector<page_id_t> page_ids(32);
+  for (auto &page_id : page_ids) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (auto page_id : page_ids) {
+    bpm->UnpinPage(page_id, false);
+  }
+
+  catalog.reset();
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+}
+
+/** A buffer pool that records the pages created and deleted through it, and runs out of frames for new pages. */
+class RecordingBufferPoolManager : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+  /** The number of pages NewPage may still create, as if the other frames were pinned */
+  size_t new_page_budget_{SIZE_MAX};
+  std::unordered_set<page_id_t> new_page_ids_;
+  std::unordered_set<page_id_t> deleted_page_ids_;
+
+ protected:
+  Page *NewPgImp(page_id_t *page_id) override {
+    if (new_page_budget_ == 0) {
+      return nullptr;
+    }
+    Page *page = BufferPoolManagerInstance::NewPgImp(page_id);
+    if (page != nullptr) {
+      new_page_budget_--;
+      new_page_ids_.insert(*page_id);
+    }
+    return page;
+  }
+
+  bool DeletePgImp(page_id_t page_id) override {
+    bool deleted = BufferPoolManagerInstance::DeletePgImp(page_id);
+    if (deleted) {
+      deleted_page_ids_.insert(page_id);
+    }
+    return deleted;
+  }
+};
+
+// An index that runs out of frames while it is loaded deletes every page it created, its header page included
+TEST(CatalogTest, CreateIndexOutOfMemoryTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<RecordingBufferPoolManager>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  Schema schema{{Column("A", TypeId::BIGINT), Column("B", TypeId::INTEGER)}};
+  auto *table_info = catalog->CreateTable(nullptr, "foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  // More entries than a single sorted run holds, so that the load writes runs, leaves and internal pages.
+  const int64_t num_tuples = 6000;
+  for (int64_t i = 0; i < num_tuples; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetBigIntValue(num_tuples - i), ValueFactory::GetIntegerValue(0)}, &schema);
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, &txn));
+  }
+
+  // Run out of frames at every page the load creates in turn, until it has all the frames it needs.
+  Schema key_schema{{Column("A", TypeId::BIGINT)}};
+  auto create_index = [&] {
+    return catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+        &txn, "index1", "foobar", schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{},
+        IndexType::B_PLUS_TREE);
+  };
+  size_t budget = 0;
+  for (;; budget++) {
+    bpm->new_page_budget_ = budget;
+    bpm->new_page_ids_.clear();
+    bpm->deleted_page_ids_.clear();
+    try {
+      ASSERT_NE(Catalog::NULL_INDEX_INFO, create_index());
+      break;
+    } catch (const Exception &e) {
+      EXPECT_EQ(ExceptionType::OUT_OF_MEMORY, e.GetType());
+    }
+    EXPECT_EQ(bpm->new_page_ids_, bpm->deleted_page_ids_);
+    EXPECT_TRUE(catalog->GetTableIndexes("foobar").empty());
+  }
+  EXPECT_GT(budget, 2);
+
+  catalog.reset();
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+}
+
 // Attempts to create an index with duplicate name should fail
 TEST(CatalogTest, DISABLED_CreateIndex2) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
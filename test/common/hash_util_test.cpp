@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_util_test.cpp
+//
+// Identification: test/common/hash_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// The low bits of the hash of sequential keys should fill the buckets they select evenly.
+template <typename KeyType>
+void CheckLowBits(const std::vector<KeyType> &keys) {
+  HashFunction<KeyType> hash_fn;
+  constexpr uint64_t num_buckets = 256;
+  std::vector<int> counts(num_buckets, 0);
+  for (const auto &key : keys) {
+    counts[hash_fn.GetHash(key) % num_buckets]++;
+  }
+  int expected = static_cast<int>(keys.size() / num_buckets);
+  for (int count : counts) {
+    EXPECT_GT(count, expected / 2);
+    EXPECT_LT(count, expected * 2);
+  }
+}
+
+TEST(HashUtilTest, IntegerKeyTest) {
+  std::vector<int> keys;
+  for (int i = 0; i < 100000; i++) {
+    keys.push_back(i);
+  }
+  CheckLowBits(keys);
+
+  std::unordered_set<uint64_t> hashes;
+  HashFunction<int> hash_fn;
+  for (int key : keys) {
+    EXPECT_EQ(hash_fn.GetHash(key), hash_fn.GetHash(key));
+    hashes.insert(hash_fn.GetHash(key));
+  }
+  EXPECT_EQ(keys.size(), hashes.size());
+}
+
+TEST(HashUtilTest, GenericKeyTest) {
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::BIGINT)});
+  std::vector<GenericKey<8>> narrow_keys(100000);
+  std::vector<GenericKey<64>> wide_keys(100000);
+  for (int64_t i = 0; i < 100000; i++) {
+    narrow_keys[i].SetFromInteger(i);
+    std::vector<Value> values{ValueFactory::GetBigIntValue(i % 7), ValueFactory::GetBigIntValue(i)};
+    wide_keys[i].SetFromKey(Tuple(values, &schema), &schema);
+  }
+  CheckLowBits(narrow_keys);
+  CheckLowBits(wide_keys);
+}
+
+TEST(HashUtilTest, HashBytesTest) {
+  // Strings of every length up to and past a round of HashBytes differ from each other, and in their last byte.
+  std::unordered_set<hash_t> hashes;
+  std::string str;
+  for (int length = 0; length < 200; length++) {
+    hashes.insert(HashUtil::HashBytes(str.data(), str.size()));
+    std::string other = str + 'b';
+    str += 'a';
+    hashes.insert(HashUtil::HashBytes(other.data(), other.size()));
+  }
+  EXPECT_EQ(400, hashes.size());
+}
+
+TEST(HashUtilTest, HashValueTest) {
+  // Equal values of the integer types hash the same, so that they join and group together.
+  std::vector<Value> values{ValueFactory::GetIntegerValue(42), ValueFactory::GetTinyIntValue(42),
+                            ValueFactory::GetSmallIntValue(42), ValueFactory::GetBigIntValue(42)};
+  hash_t hash = HashUtil::HashValue(&values[0]);
+  for (const auto &value : values) {
+    EXPECT_EQ(hash, HashUtil::HashValue(&value));
+  }
+  Value other = ValueFactory::GetIntegerValue(43);
+  EXPECT_NE(hash, HashUtil::HashValue(&other));
+
+  Value str = ValueFactory::GetVarcharValue("bustub");
+  Value same_str = ValueFactory::GetVarcharValue("bustub");
+  Value other_str = ValueFactory::GetVarcharValue("bustuc");
+  EXPECT_EQ(HashUtil::HashValue(&str), HashUtil::HashValue(&same_str));
+  EXPECT_NE(HashUtil::HashValue(&str), HashUtil::HashValue(&other_str));
+
+  EXPECT_NE(HashUtil::CombineHashes(1, 2), HashUtil::CombineHashes(2, 1));
+}
+
+/** CRC32C of the bytes of a little-endian word, bit by bit, the way the instruction computes it. */
+static uint64_t Crc32c(uint64_t crc, uint64_t word) {
+  for (int i = 0; i < 64; i++) {
+    uint64_t bit = (crc ^ (word >> i)) & 1;
+    crc = (crc >> 1) ^ (bit * 0x82f63b78ULL);
+  }
+  return crc;
+}
+
+TEST(HashUtilTest, Crc32Test) {
+  // Every CPU hashes a word the same, with the instruction or without it.
+  for (uint64_t word : {0ULL, 1ULL, 42ULL, 0xffffffffULL, 0x123456789abcdef0ULL, ~0ULL}) {
+    uint64_t low = Crc32c(0, word);
+    uint64_t high = Crc32c(0xffffffffULL, (word >> 32) | (word << 32));
+    EXPECT_EQ((high << 32) | low, HashUtil::HashWordTable(word));
+    EXPECT_EQ(HashUtil::HashWordTable(word), HashUtil::HashWord(word));
+#if defined(BUSTUB_HASH_CRC32)
+    if (HashUtil::HasCrc32()) {
+      EXPECT_EQ(HashUtil::HashWordTable(word), HashUtil::HashWordCrc32(word));
+    }
+#endif
+  }
+}
+
+}  // namespace bustub
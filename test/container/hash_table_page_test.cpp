@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -17,13 +18,14 @@
 #include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -57,7 +59,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -114,4 +116,102 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFullTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  const int capacity = static_cast<int>((4 * PAGE_SIZE / (4 * sizeof(std::pair<int, int>) + 5)));
+
+  // Keys have two values each, so that some slots share a fingerprint.
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_TRUE(bucket_page->Insert(i / 2, i, IntComparator()));
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(capacity, bucket_page->NumReadable());
+  EXPECT_FALSE(bucket_page->Insert(capacity, capacity, IntComparator()));
+
+  // Remove every third pair, and check the others are still found.
+  for (int i = 0; i < capacity; i += 3) {
+    EXPECT_TRUE(bucket_page->Remove(i / 2, i, IntComparator()));
+    EXPECT_FALSE(bucket_page->Remove(i / 2, i, IntComparator()));
+  }
+  EXPECT_FALSE(bucket_page->IsFull());
+  for (int i = 0; i < capacity; i++) {
+    std::vector<int> result;
+    bucket_page->GetValue(i / 2, IntComparator(), &result);
+    EXPECT_EQ(i % 3 != 0, std::find(result.begin(), result.end(), i) != result.end());
+    // A pair that is there goes in once.
+    EXPECT_EQ(i % 3 == 0, bucket_page->Insert(i / 2, i, IntComparator()));
+  }
+  EXPECT_TRUE(bucket_page->IsFull());
+
+  for (int i = 0; i < capacity; i++) {
+    EXPECT_TRUE(bucket_page->Remove(i / 2, i, IntComparator()));
+  }
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  EXPECT_EQ(0, bucket_page->NumReadable());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BlockPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  auto block_page = reinterpret_cast<HashTableBlockPage<int, int, IntComparator> *>(
+      bpm->NewPage(&block_page_id, nullptr)->GetData());
+  block_page->Init();
+  EXPECT_TRUE(block_page->IsEmpty());
+
+  // All the keys have the same hash, so that they fill the groups from the first one on.
+  const int num_pairs = 2 * BLOCK_GROUP_SIZE + 8;
+  for (int i = 0; i < num_pairs; i++) {
+    EXPECT_TRUE(block_page->Insert(i, i, 0, IntComparator()));
+    EXPECT_FALSE(block_page->Insert(i, i, 0, IntComparator()));
+  }
+  EXPECT_EQ(num_pairs, block_page->NumReadable());
+  EXPECT_EQ(num_pairs, block_page->NumOccupied());
+
+  // A pair of a full group leaves a tombstone, so that the probe goes on past the group.
+  EXPECT_TRUE(block_page->Remove(0, 0, 0, IntComparator()));
+  EXPECT_FALSE(block_page->IsReadable(0));
+  EXPECT_TRUE(block_page->IsOccupied(0));
+  EXPECT_EQ(num_pairs, block_page->NumOccupied());
+  std::vector<int> result;
+  EXPECT_TRUE(block_page->GetValue(num_pairs - 1, 0, IntComparator(), &result));
+  EXPECT_EQ(std::vector<int>{num_pairs - 1}, result);
+
+  // A pair of a group with an EMPTY slot leaves an EMPTY slot.
+  EXPECT_TRUE(block_page->Remove(num_pairs - 1, num_pairs - 1, 0, IntComparator()));
+  EXPECT_FALSE(block_page->IsOccupied(num_pairs - 1));
+  EXPECT_EQ(num_pairs - 1, block_page->NumOccupied());
+
+  // The tombstone is taken first.
+  EXPECT_TRUE(block_page->Insert(num_pairs, num_pairs, 0, IntComparator()));
+  EXPECT_TRUE(block_page->IsReadable(0));
+  EXPECT_EQ(num_pairs, block_page->KeyAt(0));
+
+  for (int i = 1; i <= num_pairs; i++) {
+    EXPECT_EQ(i != num_pairs - 1, block_page->Remove(i, i, 0, IntComparator()));
+  }
+  EXPECT_TRUE(block_page->IsEmpty());
+
+  bpm->UnpinPage(block_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -18,13 +19,24 @@
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
 
 namespace bustub {
 
-// NOLINTNEXTLINE
+// helper function to launch multiple threads
+template <typename... Args>
+void LaunchParallelTest(uint64_t num_threads, Args &&...args) {
+  std::vector<std::thread> thread_group;
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    thread_group.push_back(std::thread(args..., thread_itr));
+  }
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    thread_group[thread_itr].join();
+  }
+}
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +129,236 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // Each thread inserts its own keys, two values per key, so that buckets split under all of them.
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+    for (int i = 0; i < keys_per_thread; i++) {
+      int key = static_cast<int>(thread_itr) * keys_per_thread + i;
+      EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      EXPECT_TRUE(ht.Insert(nullptr, key, -key - 1));
+    }
+  });
+  ht.VerifyIntegrity();
+  EXPECT_LT(0, ht.GetGlobalDepth());
+
+  for (int key = 0; key < num_threads * keys_per_thread; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(2, res.size()) << "Failed to keep " << key << std::endl;
+    EXPECT_TRUE((res[0] == key && res[1] == -key - 1) || (res[0] == -key - 1 && res[1] == key));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentMixedTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // The stable keys stay in the table while writers insert and remove others around them.
+  const int num_stable_keys = 2000;
+  for (int key = 0; key < num_stable_keys; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+
+  const int num_threads = 6;
+  const int keys_per_writer = 4000;
+  LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+    if (thread_itr % 2 == 0) {
+      for (int round = 0; round < 3; round++) {
+        for (int key = 0; key < num_stable_keys; key++) {
+          std::vector<int> res;
+          EXPECT_TRUE(ht.GetValue(nullptr, key, &res));
+          EXPECT_EQ(1, res.size());
+        }
+      }
+      return;
+    }
+    // Fill buckets until they split, then empty them so that they merge again.
+    int base = num_stable_keys + static_cast<int>(thread_itr) * keys_per_writer;
+    for (int round = 0; round < 2; round++) {
+      for (int key = base; key < base + keys_per_writer; key++) {
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      }
+      for (int key = base; key < base + keys_per_writer; key++) {
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+      }
+    }
+  });
+  ht.VerifyIntegrity();
+
+  for (int key = 0; key < num_stable_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    EXPECT_EQ(1, res.size());
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, MultiPageDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // Wide keys make for small buckets, so that the directory outgrows its first page with few keys.
+  GenericComparator<64> comparator;
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator,
+                                                                     HashFunction<GenericKey<64>>());
+
+  const int64_t num_keys = 20000;
+  GenericKey<64> key;
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Insert(nullptr, key, RID(i)));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_LT(DIRECTORY_PAGE_DEPTH, ht.GetGlobalDepth());
+
+  for (int64_t i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    key.SetFromInteger(i);
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(RID(i), res[0]);
+  }
+
+  // The directory shrinks back into one page, and then to a single bucket.
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Remove(nullptr, key, RID(i)));
+    if (i == num_keys * 9 / 10) {
+      ht.VerifyIntegrity();
+    }
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, FetchFailureTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // Pin all but one frame, which is enough for inserts until the first split needs the directory and the bucket.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < 9; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+  }
+  int num_keys = 0;
+  bool thrown = false;
+  while (!thrown && num_keys < 10000) {
+    try {
+      EXPECT_TRUE(ht.Insert(nullptr, num_keys, num_keys));
+      num_keys++;
+    } catch (const Exception &) {
+      thrown = true;
+    }
+  }
+  ASSERT_TRUE(thrown);
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  // The table latch and the pins were let go, so the table works again once there are frames.
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+  for (int key = num_keys; key < num_keys * 2; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  for (int key = 0; key < num_keys * 2; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(key, res[0]);
+  }
+  EXPECT_LT(0, ht.GetGlobalDepth());
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentReadMostlyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_keys = 20000;
+  for (int key = 0; key < num_keys; key++) {
+    ht.Insert(nullptr, key, key);
+  }
+
+  // Nine lookups for every insert or remove of a key of the thread's own range.
+  const int ops_per_thread = 40000;
+  for (uint64_t num_threads : {1, 2, 4}) {
+    std::atomic<int> lookups_found{0};
+    std::atomic<int> writes_done{0};
+    LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+      int found = 0;
+      int written = 0;
+      int own_key = num_keys + static_cast<int>(thread_itr) * ops_per_thread;
+      for (int i = 0; i < ops_per_thread; i++) {
+        if (i % 10 == 0) {
+          written += static_cast<int>(ht.Insert(nullptr, own_key + i, i));
+        } else if (i % 10 == 5) {
+          written += static_cast<int>(ht.Remove(nullptr, own_key + i - 5, i - 5));
+        } else {
+          std::vector<int> res;
+          found += static_cast<int>(ht.GetValue(nullptr, (i * 7919) % num_keys, &res));
+        }
+      }
+      lookups_found += found;
+      writes_done += written;
+    });
+    EXPECT_EQ(num_threads * ops_per_thread * 8 / 10, lookups_found);
+    EXPECT_EQ(num_threads * ops_per_thread * 2 / 10, writes_done);
+  }
+
+  // Every key of the threads was removed again, and the keys loaded first are all there.
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(key, res[0]);
+  }
+  for (int key = num_keys; key < num_keys + 4 * ops_per_thread; key++) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, key, &res));
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
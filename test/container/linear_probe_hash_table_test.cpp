@@ -0,0 +1,321 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// helper function to launch multiple threads
+template <typename... Args>
+void LaunchParallelTest(uint64_t num_threads, Args &&...args) {
+  std::vector<std::thread> thread_group;
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    thread_group.push_back(std::thread(args..., thread_itr));
+  }
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    thread_group[thread_itr].join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // insert one more value for each key
+  for (int i = 0; i < 5; i++) {
+    if (i == 0) {
+      // duplicate values for the same key are not allowed
+      EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
+    } else {
+      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+    }
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i == 0 ? 1 : 2, res.size());
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      EXPECT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, GrowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // Wide keys make for small blocks, so that the table grows several times.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator;
+  LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator, 10,
+                                                                      HashFunction<GenericKey<64>>());
+  size_t initial_size = ht.GetSize();
+
+  const int64_t num_keys = 5000;
+  GenericKey<64> key;
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Insert(nullptr, key, RID(i)));
+  }
+  EXPECT_LE(num_keys, ht.GetSize());
+  EXPECT_LT(initial_size, ht.GetSize());
+
+  for (int64_t i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    key.SetFromInteger(i);
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(RID(i), res[0]);
+  }
+
+  size_t size = ht.GetSize();
+  ht.Resize(size);
+  EXPECT_LE(2 * size, ht.GetSize());
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Remove(nullptr, key, RID(i)));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, FetchFailureTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  // Pin all but one frame: the new blocks of a grow are made one at a time, but moving a key needs two of them.
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < 9; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+  }
+  size_t size = ht.GetSize();
+  int num_keys = 0;
+  bool thrown = false;
+  while (!thrown && num_keys < 100000) {
+    try {
+      EXPECT_TRUE(ht.Insert(nullptr, num_keys, num_keys));
+      num_keys++;
+    } catch (const Exception &) {
+      thrown = true;
+    }
+  }
+  ASSERT_TRUE(thrown);
+  EXPECT_EQ(size, ht.GetSize());
+
+  // The table latch and the pins were let go, so the table grows once there are frames.
+  for (page_id_t page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+  for (int key = num_keys; key < num_keys * 2; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  for (int key = 0; key < num_keys * 2; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(key, res[0]);
+  }
+  EXPECT_LT(size, ht.GetSize());
+  // No page of the table is left pinned.
+  for (size_t i = 0; i < 10; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, TombstoneTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  size_t size = ht.GetSize();
+
+  // A sliding window of keys leaves tombstones behind, which the blocks rehash away instead of growing.
+  const int window = static_cast<int>(size / 4);
+  for (int key = 0; key < 50 * window; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+    if (key >= window) {
+      EXPECT_TRUE(ht.Remove(nullptr, key - window, key - window));
+    }
+  }
+  EXPECT_EQ(size, ht.GetSize());
+
+  for (int key = 49 * window; key < 50 * window; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << key << std::endl;
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentMixedTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // The stable keys stay in the table while writers insert and remove others around them, growing the table.
+  const int num_stable_keys = 2000;
+  for (int key = 0; key < num_stable_keys; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+
+  const int num_threads = 6;
+  const int keys_per_writer = 4000;
+  LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+    if (thread_itr % 2 == 0) {
+      for (int round = 0; round < 3; round++) {
+        for (int key = 0; key < num_stable_keys; key++) {
+          std::vector<int> res;
+          EXPECT_TRUE(ht.GetValue(nullptr, key, &res));
+          EXPECT_EQ(1, res.size());
+        }
+      }
+      return;
+    }
+    int base = num_stable_keys + static_cast<int>(thread_itr) * keys_per_writer;
+    for (int round = 0; round < 2; round++) {
+      for (int key = base; key < base + keys_per_writer; key++) {
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      }
+      for (int key = base; key < base + keys_per_writer; key++) {
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+      }
+    }
+  });
+
+  for (int key = 0; key < num_stable_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    EXPECT_EQ(1, res.size());
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentReadMostlyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  const int num_keys = 20000;
+  for (int key = 0; key < num_keys; key++) {
+    ht.Insert(nullptr, key, key);
+  }
+
+  // Nine lookups for every insert or remove of a key of the thread's own range.
+  const int ops_per_thread = 40000;
+  for (uint64_t num_threads : {1, 2, 4}) {
+    std::atomic<int> lookups_found{0};
+    std::atomic<int> writes_done{0};
+    LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+      int found = 0;
+      int written = 0;
+      int own_key = num_keys + static_cast<int>(thread_itr) * ops_per_thread;
+      for (int i = 0; i < ops_per_thread; i++) {
+        if (i % 10 == 0) {
+          written += static_cast<int>(ht.Insert(nullptr, own_key + i, i));
+        } else if (i % 10 == 5) {
+          written += static_cast<int>(ht.Remove(nullptr, own_key + i - 5, i - 5));
+        } else {
+          std::vector<int> res;
+          found += static_cast<int>(ht.GetValue(nullptr, (i * 7919) % num_keys, &res));
+        }
+      }
+      lookups_found += found;
+      writes_done += written;
+    });
+    EXPECT_EQ(num_threads * ops_per_thread * 8 / 10, lookups_found);
+    EXPECT_EQ(num_threads * ops_per_thread * 2 / 10, writes_done);
+  }
+
+  // Every key of the threads was removed again, and the keys loaded first are all there.
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(key, res[0]);
+  }
+  for (int key = num_keys; key < num_keys + 4 * ops_per_thread; key++) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, key, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
@@ -10,8 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -21,6 +26,7 @@
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
+#include "execution/executor_factory.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
@@ -30,10 +36,14 @@
 #include "execution/expressions/constant_value_expression.h"
 #include "execution/plans/delete_plan.h"
 #include "execution/plans/distinct_plan.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/plans/gather_plan.h"
 #include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/update_plan.h"
+#include "execution/spill_file.h"
 #include "executor_test_util.h"  // NOLINT
 #include "gtest/gtest.h"
 #include "storage/table/tuple.h"
@@ -87,7 +97,7 @@ using ComparatorType = GenericComparator<8>;
 using HashFunctionType = HashFunction<KeyType>;
 
 // SELECT col_a, col_b FROM test_1 WHERE col_a < 500
-TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
+TEST_F(ExecutorTest, SimpleSeqScanTest) {
   // Construct query plan
   TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
   const Schema &schema = table_info->schema_;
@@ -110,6 +120,746 @@ TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
   }
 }
 
+// SELECT col_a, col_b FROM test_1 WHERE col_a < 500, a batch at a time and a tuple at a time
+TEST_F(ExecutorTest, SeqScanBatchTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  executor->Init();
+  std::vector<int32_t> batch_col_a;
+  std::vector<RID> batch_rids;
+  TupleBatch batch;
+  while (executor->NextBatch(&batch)) {
+    ASSERT_LE(batch.Size(), TupleBatch::BATCH_SIZE);
+    for (uint32_t row = 0; row < batch.Size(); row++) {
+      batch_col_a.push_back(batch.GetValue(row, 0).GetAs<int32_t>());
+      batch_rids.push_back(batch.GetRid(row));
+    }
+  }
+  ASSERT_EQ(500, batch_col_a.size());
+
+  // The tuples of Next are the rows of NextBatch, in order.
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  for (size_t i = 0; i < batch_col_a.size(); i++) {
+    ASSERT_TRUE(executor->Next(&tuple, &rid));
+    ASSERT_EQ(batch_col_a[i], tuple.GetValue(out_schema, 0).GetAs<int32_t>());
+    ASSERT_EQ(batch_rids[i], rid);
+  }
+  ASSERT_FALSE(executor->Next(&tuple, &rid));
+
+  // A scan of every column outputs the tuples of the table as they are.
+  auto *col_c = MakeColumnValueExpression(schema, 0, "colC");
+  auto *col_d = MakeColumnValueExpression(schema, 0, "colD");
+  auto *all_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}, {"colC", col_c}, {"colD", col_d}});
+  SeqScanPlanNode all_plan{all_schema, predicate, table_info->oid_};
+  auto all_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &all_plan);
+  all_executor->Init();
+  for (size_t i = 0; i < batch_col_a.size(); i++) {
+    ASSERT_TRUE(all_executor->Next(&tuple, &rid));
+    ASSERT_EQ(batch_rids[i], rid);
+    Tuple table_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rid, &table_tuple, GetTxn()));
+    ASSERT_EQ(table_tuple.GetLength(), tuple.GetLength());
+    ASSERT_EQ(0, memcmp(table_tuple.GetData(), tuple.GetData(), tuple.GetLength()));
+  }
+  ASSERT_FALSE(all_executor->Next(&tuple, &rid));
+}
+
+/** An expression without an EvaluateBatch of its own, which evaluates a batch a tuple at a time: its child plus one */
+class PlusOneExpression : public AbstractExpression {
+ public:
+  explicit PlusOneExpression(const AbstractExpression *child) : AbstractExpression({child}, TypeId::INTEGER) {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    return GetChildAt(0)->Evaluate(tuple, schema).Add(ValueFactory::GetIntegerValue(1));
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    return GetChildAt(0)
+        ->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema)
+        .Add(ValueFactory::GetIntegerValue(1));
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    return GetChildAt(0)->EvaluateAggregate(group_bys, aggregates).Add(ValueFactory::GetIntegerValue(1));
+  }
+};
+
+// SELECT colA + 1 FROM test_1 WHERE colA < 500, where the scan only decodes colA
+TEST_F(ExecutorTest, SeqScanPartialBatchTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(col_a, const500, ComparisonType::LessThan);
+  PlusOneExpression plus_one(col_a);
+  auto *out_schema = MakeOutputSchema({{"colA", &plus_one}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  // The tuple of a row of a partial batch holds NULL in the columns that were not decoded.
+  TableIterator iter = table_info->table_->Begin(GetTxn());
+  TupleBatch table_batch(&schema);
+  table_batch.Append(*iter, iter->GetRid(), {0});
+  Tuple partial = table_batch.GetTuple(0);
+  EXPECT_EQ(iter->GetValue(&schema, 0).GetAs<int32_t>(), partial.GetValue(&schema, 0).GetAs<int32_t>());
+  for (uint32_t col_idx = 1; col_idx < schema.GetColumnCount(); col_idx++) {
+    EXPECT_TRUE(partial.GetValue(&schema, col_idx).IsNull());
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(500, result_set.size());
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(static_cast<int32_t>(i) + 1, result_set[i].GetValue(out_schema, 0).GetAs<int32_t>());
+  }
+}
+
+/** @return the nanoseconds per row that a scan takes to produce its rows a number of times, by batch or by tuple */
+static double TimeScan(AbstractExecutor *executor, bool batches, int rounds, size_t num_rows, size_t *num_results) {
+  auto start = std::chrono::steady_clock::now();
+  *num_results = 0;
+  for (int round = 0; round < rounds; round++) {
+    executor->Init();
+    if (batches) {
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
+        *num_results += batch.Size();
+      }
+    } else {
+      Tuple tuple;
+      RID rid;
+      while (executor->Next(&tuple, &rid)) {
+        (*num_results)++;
+      }
+    }
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         (rounds * num_rows);
+}
+
+// SELECT col0 FROM wide_table WHERE col1 < 5 and SELECT * FROM wide_table WHERE col1 < 5, a batch and a tuple at a
+// time. A narrow scan decodes one column of the eight on each row. The table fits in the buffer pool, so that the scans
+// measure the executor rather than the disk.
+// A microbenchmark, run it with --gtest_also_run_disabled_tests in a release build.
+TEST_F(ExecutorTest, DISABLED_SeqScanBenchmarkTest) {
+  const int32_t num_rows = 2000;
+  const int rounds = 200;
+  const uint32_t num_columns = 8;
+  std::vector<Column> columns;
+  for (uint32_t col_idx = 0; col_idx < num_columns; col_idx++) {
+    columns.emplace_back("col" + std::to_string(col_idx), TypeId::INTEGER);
+  }
+  Schema table_schema(columns);
+  TableInfo *table_info = GetCatalog()->CreateTable(GetTxn(), "wide_table", table_schema);
+  for (int32_t i = 0; i < num_rows; i++) {
+    std::vector<Value> values;
+    for (uint32_t col_idx = 0; col_idx < num_columns; col_idx++) {
+      values.push_back(ValueFactory::GetIntegerValue(col_idx == 1 ? i % 10 : i));
+    }
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_schema), &rid, GetTxn()));
+  }
+  const Schema &schema = table_info->schema_;
+  auto *col1 = MakeColumnValueExpression(schema, 0, "col1");
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(col1, const5, ComparisonType::LessThan);
+  std::vector<std::pair<std::string, const AbstractExpression *>> all_columns;
+  for (uint32_t col_idx = 0; col_idx < num_columns; col_idx++) {
+    const std::string &name = columns[col_idx].GetName();
+    all_columns.emplace_back(name, MakeColumnValueExpression(schema, 0, name));
+  }
+  SeqScanPlanNode narrow_plan{MakeOutputSchema({all_columns[0]}), predicate, table_info->oid_};
+  SeqScanPlanNode wide_plan{MakeOutputSchema(all_columns), predicate, table_info->oid_};
+  auto narrow_scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &narrow_plan);
+  auto wide_scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &wide_plan);
+
+  for (bool batches : {true, false}) {
+    size_t narrow_results = 0;
+    size_t wide_results = 0;
+    // Warm the buffer pool up.
+    TimeScan(wide_scan.get(), batches, 1, num_rows, &wide_results);
+    double narrow_nanos = TimeScan(narrow_scan.get(), batches, rounds, num_rows, &narrow_results);
+    double wide_nanos = TimeScan(wide_scan.get(), batches, rounds, num_rows, &wide_results);
+    char line[128];
+    snprintf(line, sizeof(line), "%s: one of %u columns %.1f ns per row, every column %.1f ns per row",
+             batches ? "NextBatch" : "Next", num_columns, narrow_nanos, wide_nanos);
+    std::cout << line << std::endl;
+    EXPECT_EQ(rounds * num_rows / 2, narrow_results);
+    EXPECT_EQ(rounds * num_rows / 2, wide_results);
+  }
+}
+
+// SELECT colA, colB FROM test_1 WHERE colA in a range, with a B+ tree index on colA
+TEST_F(ExecutorTest, IndexScanTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("a int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+
+  auto key = [&](int32_t col_a) { return Tuple({ValueFactory::GetIntegerValue(col_a)}, key_schema.get()); };
+  auto scan = [&](std::optional<Tuple> low, bool low_inclusive, std::optional<Tuple> high, bool high_inclusive) {
+    IndexScanPlanNode plan{out_schema,    nullptr,         index_info->index_oid_, std::move(low),
+                           low_inclusive, std::move(high), high_inclusive};
+    std::vector<Tuple> result_set{};
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<int32_t> col_a_values;
+    for (const auto &tuple : result_set) {
+      col_a_values.push_back(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    }
+    std::sort(col_a_values.begin(), col_a_values.end());
+    return col_a_values;
+  };
+  // colA is 0, 1, 2... in test_1.
+  auto range = [](int32_t begin, int32_t end) {
+    std::vector<int32_t> col_a_values(end - begin);
+    std::iota(col_a_values.begin(), col_a_values.end(), begin);
+    return col_a_values;
+  };
+
+  EXPECT_EQ(range(100, 200), scan(key(100), true, key(200), false));
+  EXPECT_EQ(range(101, 201), scan(key(100), false, key(200), true));
+  EXPECT_EQ(range(0, 10), scan(std::nullopt, true, key(10), false));
+  EXPECT_EQ(range(990, TEST1_SIZE), scan(key(990), true, std::nullopt, true));
+  EXPECT_EQ(range(0, TEST1_SIZE), scan(std::nullopt, true, std::nullopt, true));
+  EXPECT_EQ(range(500, 501), scan(key(500), true, key(500), true));
+
+  // Empty ranges
+  EXPECT_TRUE(scan(key(500), false, key(500), true).empty());
+  EXPECT_TRUE(scan(key(200), true, key(100), true).empty());
+  EXPECT_TRUE(scan(key(TEST1_SIZE), true, std::nullopt, true).empty());
+  EXPECT_TRUE(scan(std::nullopt, true, key(0), false).empty());
+}
+
+// SELECT colB FROM test_1 with a B+ tree index on colB, whose keys are not in table order
+TEST_F(ExecutorTest, IndexScanKeyOrderTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("b int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {1}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colB", col_b}});
+  IndexScanPlanNode plan{out_schema, nullptr, index_info->index_oid_, std::nullopt, true, std::nullopt, true};
+
+  // The tuples of a batch are read in page order, but come out in key order.
+  std::vector<Tuple> result_set{};
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(TEST1_SIZE, result_set.size());
+  for (size_t i = 1; i < result_set.size(); i++) {
+    ASSERT_LE(result_set[i - 1].GetValue(out_schema, 0).GetAs<int32_t>(),
+              result_set[i].GetValue(out_schema, 0).GetAs<int32_t>());
+  }
+}
+
+// BPlusTreeIndex::ScanRange over a key that many tuples share, and TableHeap::GetTuples on its RIDs
+TEST_F(ExecutorTest, IndexScanRangeTest) {
+  TableInfo *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  const Schema &schema = table_info->schema_;
+  auto key_schema = ParseCreateStatement("b int");
+  auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {1}, 8, HashFunctionType{}, IndexType::B_PLUS_TREE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  auto *tree_index = dynamic_cast<BPlusTreeIndex<KeyType, ValueType, ComparatorType> *>(index_info->index_.get());
+  ASSERT_NE(nullptr, tree_index);
+
+  // The RIDs of the tuples with 3 <= colB < 5, by a scan of the table.
+  std::vector<RID> expected_rids;
+  for (auto tuple = table_info->table_->Begin(GetTxn()); tuple != table_info->table_->End(); ++tuple) {
+    int32_t col_b = tuple->GetValue(&schema, 1).GetAs<int32_t>();
+    if (col_b >= 3 && col_b < 5) {
+      expected_rids.push_back(tuple->GetRid());
+    }
+  }
+  ASSERT_FALSE(expected_rids.empty());
+
+  Tuple low{{ValueFactory::GetIntegerValue(3)}, key_schema.get()};
+  Tuple high{{ValueFactory::GetIntegerValue(5)}, key_schema.get()};
+  auto iterator = tree_index->ScanRange(&low, true, &high, false);
+  std::vector<RID> rids;
+  std::vector<RID> batch;
+  while (iterator.NextBatch(&batch)) {
+    rids.insert(rids.end(), batch.begin(), batch.end());
+  }
+  auto by_page = [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); };
+  std::sort(rids.begin(), rids.end(), by_page);
+  std::sort(expected_rids.begin(), expected_rids.end(), by_page);
+  ASSERT_EQ(expected_rids, rids);
+
+  // GetTuples reads the tuples in the order of the RIDs.
+  std::vector<Tuple> tuples;
+  ASSERT_TRUE(table_info->table_->GetTuples(rids, &tuples, GetTxn()));
+  ASSERT_EQ(rids.size(), tuples.size());
+  for (size_t i = 0; i < rids.size(); i++) {
+    EXPECT_EQ(rids[i], tuples[i].GetRid());
+    int32_t col_b = tuples[i].GetValue(&schema, 1).GetAs<int32_t>();
+    EXPECT_TRUE(col_b >= 3 && col_b < 5);
+  }
+
+  // A range with no keys
+  Tuple missing{{ValueFactory::GetIntegerValue(10)}, key_schema.get()};
+  auto empty_iterator = tree_index->ScanRange(&missing, true, nullptr, true);
+  EXPECT_FALSE(empty_iterator.NextBatch(&batch));
+  tuples.clear();
+  ASSERT_TRUE(table_info->table_->GetTuples({}, &tuples, GetTxn()));
+  EXPECT_TRUE(tuples.empty());
+}
+
+// Creates big_table(colA, colB) with colA = i and colB = i % 10, over many more pages than a morsel.
+TableInfo *CreateBigTable(Catalog *catalog, Transaction *txn, int32_t num_rows) {
+  Schema table_schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER)});
+  TableInfo *table_info = catalog->CreateTable(txn, "big_table", table_schema);
+  for (int32_t i = 0; i < num_rows; i++) {
+    RID rid;
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)};
+    EXPECT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_schema), &rid, txn));
+  }
+  return table_info;
+}
+
+// SELECT colA, colB FROM big_table WHERE colA < 15000, on four threads
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const15000 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(15000));
+  auto *predicate = MakeComparisonExpression(col_a, const15000, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+  GatherPlanNode plan{out_schema, &scan_plan, 4};
+
+  // Every qualifying row comes out once, in some order. Scanning again starts over.
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  for (int round = 0; round < 2; round++) {
+    executor->Init();
+    std::vector<bool> seen(num_rows, false);
+    size_t num_seen = 0;
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      for (uint32_t row = 0; row < batch.Size(); row++) {
+        int32_t col_a_value = batch.GetValue(row, 0).GetAs<int32_t>();
+        ASSERT_LT(col_a_value, 15000);
+        ASSERT_FALSE(seen[col_a_value]);
+        ASSERT_EQ(col_a_value % 10, batch.GetValue(row, 1).GetAs<int32_t>());
+        seen[col_a_value] = true;
+        num_seen++;
+      }
+    }
+    ASSERT_EQ(15000, num_seen);
+  }
+
+  // A limit stops the scan early, which turns the copies away.
+  LimitPlanNode limit_plan{out_schema, &plan, 10};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+}
+
+// Plans whose copies under a Gather would not produce their output are refused
+TEST_F(ExecutorTest, ParallelUnsafePlanTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  ExchangePlanNode hash_exchange_plan{scan_schema, &scan_plan, 2, ExchangeType::Hash, {col_a}};
+  ExchangePlanNode broadcast_exchange_plan{scan_schema, &scan_plan, 2, ExchangeType::Broadcast};
+  auto *outer_col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *inner_col_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *join_schema = MakeOutputSchema({{"colA", outer_col_a}});
+  auto *join_predicate = MakeComparisonExpression(outer_col_a, inner_col_a, ComparisonType::Equal);
+
+  auto create = [&](const AbstractPlanNode *child) {
+    GatherPlanNode plan{child->OutputSchema(), child, 4};
+    return ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  };
+  std::vector<std::vector<Value>> raw_vals{{ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(0)}};
+  InsertPlanNode raw_insert_plan{std::move(raw_vals), table_info->oid_};
+  EXPECT_THROW(create(&raw_insert_plan), NotImplementedException);
+  DeletePlanNode delete_plan{&scan_plan, table_info->oid_};
+  EXPECT_THROW(create(&delete_plan), NotImplementedException);
+  LimitPlanNode limit_plan{scan_schema, &scan_plan, 10};
+  EXPECT_THROW(create(&limit_plan), NotImplementedException);
+  DistinctPlanNode distinct_plan{scan_schema, &scan_plan};
+  EXPECT_THROW(create(&distinct_plan), NotImplementedException);
+  NestedLoopJoinPlanNode nlj_plan{join_schema, {&hash_exchange_plan, &hash_exchange_plan}, join_predicate};
+  EXPECT_THROW(create(&nlj_plan), NotImplementedException);
+  HashJoinPlanNode scan_join_plan{join_schema, {&scan_plan, &scan_plan}, outer_col_a, inner_col_a};
+  EXPECT_THROW(create(&scan_join_plan), NotImplementedException);
+  HashJoinPlanNode half_exchange_join_plan{join_schema, {&hash_exchange_plan, &scan_plan}, outer_col_a, inner_col_a};
+  EXPECT_THROW(create(&half_exchange_join_plan), NotImplementedException);
+
+  // With their input partitioned by an Exchange, or the build side broadcast, the copies are right.
+  DistinctPlanNode exchange_distinct_plan{scan_schema, &hash_exchange_plan};
+  EXPECT_NO_THROW(create(&exchange_distinct_plan));
+  HashJoinPlanNode broadcast_join_plan{join_schema, {&broadcast_exchange_plan, &scan_plan}, outer_col_a, inner_col_a};
+  EXPECT_NO_THROW(create(&broadcast_join_plan));
+  // A single copy of any plan is fine.
+  EXPECT_NO_THROW(ExecutorFactory::CreateExecutor(GetExecutorContext(), &limit_plan));
+}
+
+// SELECT COUNT(colA), colB FROM big_table GROUP BY colB, with the groups partitioned between four threads
+TEST_F(ExecutorTest, ParallelExchangeAggregationTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  ExchangePlanNode exchange_plan{scan_schema, &scan_plan, 3, ExchangeType::Hash, {col_b}};
+
+  auto *count_a = MakeAggregateValueExpression(false, 0);
+  auto *groupby_b = MakeAggregateValueExpression(true, 0);
+  auto *agg_schema = MakeOutputSchema({{"countA", count_a}, {"colB", groupby_b}});
+  AggregationPlanNode agg_plan{
+      agg_schema, &exchange_plan, nullptr, {col_b}, {col_a}, {AggregationType::CountAggregate}};
+  GatherPlanNode plan{agg_schema, &agg_plan, 4};
+
+  // Each group is counted by one copy of the aggregation, which sees all of its rows.
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(10, result_set.size());
+  std::unordered_set<int32_t> encountered;
+  for (const auto &tuple : result_set) {
+    ASSERT_EQ(num_rows / 10, tuple.GetValue(agg_schema, 0).GetAs<int32_t>());
+    ASSERT_TRUE(encountered.insert(tuple.GetValue(agg_schema, 1).GetAs<int32_t>()).second);
+  }
+
+  // A limit stops the consumers of the exchange early, while its producers may wait for the others.
+  LimitPlanNode limit_plan{agg_schema, &plan, 1};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&limit_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1, result_set.size());
+}
+
+// SELECT colB, COUNT(colA), SUM(colA), MIN(colA), MAX(colA) FROM big_table GROUP BY colB, and
+// SELECT colA, COUNT(colB), SUM(colB) FROM big_table GROUP BY colA, aggregated on four threads
+TEST_F(ExecutorTest, ParallelAggregationTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+
+  auto *groupby = MakeAggregateValueExpression(true, 0);
+  auto *count = MakeAggregateValueExpression(false, 0);
+  auto *sum = MakeAggregateValueExpression(false, 1);
+  auto *min = MakeAggregateValueExpression(false, 2);
+  auto *max = MakeAggregateValueExpression(false, 3);
+  auto *few_groups_schema =
+      MakeOutputSchema({{"colB", groupby}, {"countA", count}, {"sumA", sum}, {"minA", min}, {"maxA", max}});
+  AggregationPlanNode few_groups_plan{
+      few_groups_schema,
+      &scan_plan,
+      nullptr,
+      {col_b},
+      {col_a, col_a, col_a, col_a},
+      {AggregationType::CountAggregate, AggregationType::SumAggregate, AggregationType::MinAggregate,
+       AggregationType::MaxAggregate},
+      4};
+
+  // The partial aggregates of the workers add up to those of the whole table, also when aggregating again.
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &few_groups_plan);
+  for (int round = 0; round < 2; round++) {
+    executor->Init();
+    std::vector<bool> seen(10, false);
+    Tuple tuple;
+    RID rid;
+    size_t num_groups = 0;
+    while (executor->Next(&tuple, &rid)) {
+      auto b = tuple.GetValue(few_groups_schema, 0).GetAs<int32_t>();
+      ASSERT_FALSE(seen[b]);
+      seen[b] = true;
+      num_groups++;
+      ASSERT_EQ(num_rows / 10, tuple.GetValue(few_groups_schema, 1).GetAs<int32_t>());
+      ASSERT_EQ(b * (num_rows / 10) + 10 * (num_rows / 10) * (num_rows / 10 - 1) / 2,
+                tuple.GetValue(few_groups_schema, 2).GetAs<int32_t>());
+      ASSERT_EQ(b, tuple.GetValue(few_groups_schema, 3).GetAs<int32_t>());
+      ASSERT_EQ(num_rows - 10 + b, tuple.GetValue(few_groups_schema, 4).GetAs<int32_t>());
+    }
+    ASSERT_EQ(10, num_groups);
+  }
+
+  // Far more groups than a worker holds, so that the workers spill them many times.
+  auto *many_groups_schema = MakeOutputSchema({{"colA", groupby}, {"countB", count}, {"sumB", sum}});
+  AggregationPlanNode many_groups_plan{many_groups_schema,
+                                       &scan_plan,
+                                       nullptr,
+                                       {col_a},
+                                       {col_b, col_b},
+                                       {AggregationType::CountAggregate, AggregationType::SumAggregate},
+                                       4};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&many_groups_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(num_rows, result_set.size());
+  std::vector<bool> seen(num_rows, false);
+  for (const auto &tuple : result_set) {
+    auto a = tuple.GetValue(many_groups_schema, 0).GetAs<int32_t>();
+    ASSERT_FALSE(seen[a]);
+    seen[a] = true;
+    ASSERT_EQ(1, tuple.GetValue(many_groups_schema, 1).GetAs<int32_t>());
+    ASSERT_EQ(a % 10, tuple.GetValue(many_groups_schema, 2).GetAs<int32_t>());
+  }
+}
+
+// SELECT colA, COUNT(colB) FROM big_table GROUP BY colA, on four threads, with more partial aggregates than fit in
+// the buffer pool
+TEST_F(ExecutorTest, ParallelAggregationSpillTest) {
+  const int32_t num_rows = 100000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto *groupby = MakeAggregateValueExpression(true, 0);
+  auto *count = MakeAggregateValueExpression(false, 0);
+  auto *out_schema = MakeOutputSchema({{"colA", groupby}, {"countB", count}});
+  AggregationPlanNode plan{out_schema, &scan_plan, nullptr, {col_a}, {col_b}, {AggregationType::CountAggregate}, 4};
+
+  page_id_t first_page_id;
+  ASSERT_NE(nullptr, GetBPM()->NewPage(&first_page_id));
+  GetBPM()->UnpinPage(first_page_id, false);
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  page_id_t last_page_id;
+  ASSERT_NE(nullptr, GetBPM()->NewPage(&last_page_id));
+  GetBPM()->UnpinPage(last_page_id, false);
+
+  // The runs went to pages of their own, many more than the buffer pool has frames.
+  EXPECT_GT(last_page_id - first_page_id, 32 * 2);
+  ASSERT_EQ(num_rows, result_set.size());
+  std::vector<bool> seen(num_rows, false);
+  for (const auto &tuple : result_set) {
+    auto a = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+    ASSERT_FALSE(seen[a]);
+    seen[a] = true;
+    ASSERT_EQ(1, tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+  }
+}
+
+// SELECT big.colA, small.colB FROM big_table big JOIN big_table small ON big.colA = small.colA WHERE small.colA < 1000,
+// with both sides partitioned on colA between four threads
+TEST_F(ExecutorTest, ParallelExchangeHashJoinTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto *const1000 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(1000));
+  auto *predicate = MakeComparisonExpression(col_a, const1000, ComparisonType::LessThan);
+  SeqScanPlanNode small_scan_plan{scan_schema, predicate, table_info->oid_};
+  SeqScanPlanNode big_scan_plan{scan_schema, nullptr, table_info->oid_};
+  ExchangePlanNode small_exchange_plan{scan_schema, &small_scan_plan, 2, ExchangeType::Hash, {col_a}};
+  ExchangePlanNode big_exchange_plan{scan_schema, &big_scan_plan, 2, ExchangeType::Hash, {col_a}};
+
+  auto *small_col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *small_col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *big_col_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *out_schema = MakeOutputSchema({{"colA", big_col_a}, {"colB", small_col_b}});
+  HashJoinPlanNode join_plan{out_schema, {&small_exchange_plan, &big_exchange_plan}, small_col_a, big_col_a};
+  GatherPlanNode plan{out_schema, &join_plan, 4};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(1000, result_set.size());
+  std::vector<bool> seen(1000, false);
+  for (const auto &tuple : result_set) {
+    int32_t col_a_value = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+    ASSERT_LT(col_a_value, 1000);
+    ASSERT_FALSE(seen[col_a_value]);
+    ASSERT_EQ(col_a_value % 10, tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+    seen[col_a_value] = true;
+  }
+}
+
+// Rows read back from a SpillFile come in batches of at most BATCH_SIZE, also when a batch ends within a page.
+TEST_F(ExecutorTest, SpillFileBatchTest) {
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER)});
+  SpillFile spill(GetExecutorContext()->GetBufferPoolManager(), &schema);
+  const int32_t num_rows = 5000;
+  TupleBatch rows;
+  rows.Reset(&schema);
+  for (int32_t i = 0; i < num_rows; i++) {
+    rows.Append({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)}, RID());
+    spill.Append(rows, i);
+  }
+  ASSERT_EQ(num_rows, spill.GetNumRows());
+  ASSERT_GT(spill.GetNumPages(), 1);
+
+  std::vector<bool> seen(num_rows, false);
+  TupleBatch batch;
+  int32_t num_read = 0;
+  while (spill.NextBatch(&batch)) {
+    ASSERT_LE(batch.Size(), TupleBatch::BATCH_SIZE);
+    for (uint32_t row = 0; row < batch.Size(); row++) {
+      int32_t col_a = batch.GetValue(row, 0).GetAs<int32_t>();
+      ASSERT_FALSE(seen[col_a]);
+      seen[col_a] = true;
+      EXPECT_EQ(col_a % 10, batch.GetValue(row, 1).GetAs<int32_t>());
+    }
+    num_read += batch.Size();
+  }
+  EXPECT_EQ(num_rows, num_read);
+  EXPECT_FALSE(spill.NextBatch(&batch));
+}
+
+// SELECT big.colA, small.colB FROM big_table big JOIN big_table small ON big.colA = small.colA, and
+// SELECT big.colA, small.colB FROM big_table big JOIN big_table small ON big.colB = small.colB WHERE small.colA < 5,
+// with the build sides far larger than the memory budget of the joins
+TEST_F(ExecutorTest, SpillingHashJoinTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(col_a, const5, ComparisonType::LessThan);
+  SeqScanPlanNode big_scan_plan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode small_scan_plan{scan_schema, predicate, table_info->oid_};
+
+  auto *build_col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *build_col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *probe_col_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *probe_col_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", build_col_a}, {"colB", probe_col_b}});
+  const size_t memory_budget = 16 * 1024;
+
+  // The partitions of the build side spill, and split up again until they fit, both when joining and rejoining.
+  HashJoinPlanNode unique_plan{
+      out_schema, {&big_scan_plan, &big_scan_plan}, build_col_a, probe_col_a, memory_budget};
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &unique_plan);
+  for (int round = 0; round < 2; round++) {
+    executor->Init();
+    std::vector<bool> seen(num_rows, false);
+    size_t num_seen = 0;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      int32_t col_a_value = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+      ASSERT_FALSE(seen[col_a_value]);
+      ASSERT_EQ(col_a_value % 10, tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+      seen[col_a_value] = true;
+      num_seen++;
+    }
+    ASSERT_EQ(num_rows, num_seen);
+  }
+
+  // A partition whose rows share a few keys never fits, and joins in memory once it can split no more.
+  HashJoinPlanNode skewed_plan{
+      out_schema, {&big_scan_plan, &small_scan_plan}, build_col_b, probe_col_b, memory_budget};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&skewed_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(5 * num_rows / 10, result_set.size());
+  for (const auto &tuple : result_set) {
+    ASSERT_EQ(tuple.GetValue(out_schema, 0).GetAs<int32_t>() % 10, tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+  }
+}
+
+// SELECT big.colA, small.colB FROM big_table big JOIN big_table small ON big.colA = small.colA, and
+// SELECT big.colA, small.colB FROM big_table big JOIN big_table small ON big.colB = small.colB WHERE small.colA < 5,
+// probing the build sides a cache-sized chunk at a time, both in memory and spilling
+TEST_F(ExecutorTest, RadixHashJoinTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(col_a, const5, ComparisonType::LessThan);
+  SeqScanPlanNode big_scan_plan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode small_scan_plan{scan_schema, predicate, table_info->oid_};
+
+  auto *build_col_a = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto *build_col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *probe_col_a = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto *probe_col_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", build_col_a}, {"colB", probe_col_b}});
+
+  for (size_t memory_budget : {static_cast<size_t>(HASH_JOIN_MEMORY_BUDGET), static_cast<size_t>(16 * 1024)}) {
+    HashJoinPlanNode unique_plan{
+        out_schema, {&big_scan_plan, &big_scan_plan}, build_col_a, probe_col_a, memory_budget, true};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&unique_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(num_rows, result_set.size());
+    std::vector<bool> seen(num_rows, false);
+    for (const auto &tuple : result_set) {
+      int32_t col_a_value = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+      ASSERT_FALSE(seen[col_a_value]);
+      ASSERT_EQ(col_a_value % 10, tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+      seen[col_a_value] = true;
+    }
+
+    // Many rows of a chunk share a key, and every one of them matches.
+    HashJoinPlanNode skewed_plan{
+        out_schema, {&big_scan_plan, &small_scan_plan}, build_col_b, probe_col_b, memory_budget, true};
+    result_set.clear();
+    GetExecutionEngine()->Execute(&skewed_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(5 * num_rows / 10, result_set.size());
+    for (const auto &tuple : result_set) {
+      ASSERT_EQ(tuple.GetValue(out_schema, 0).GetAs<int32_t>() % 10, tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+  }
+}
+
+// SELECT big.colA, small.colB FROM big_table big JOIN big_table small ON big.colB = small.colB WHERE small.colA < 5,
+// whose probe rows each match more build rows than a batch holds
+TEST_F(ExecutorTest, HashJoinBatchSizeTest) {
+  const int32_t num_rows = 20000;
+  TableInfo *table_info = CreateBigTable(GetCatalog(), GetTxn(), num_rows);
+  const Schema &schema = table_info->schema_;
+  auto *col_a = MakeColumnValueExpression(schema, 0, "colA");
+  auto *col_b = MakeColumnValueExpression(schema, 0, "colB");
+  auto *scan_schema = MakeOutputSchema({{"colA", col_a}, {"colB", col_b}});
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  auto *predicate = MakeComparisonExpression(col_a, const5, ComparisonType::LessThan);
+  SeqScanPlanNode big_scan_plan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode small_scan_plan{scan_schema, predicate, table_info->oid_};
+
+  auto *build_col_b = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto *probe_col_b = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  auto *out_schema = MakeOutputSchema({{"colB", build_col_b}});
+
+  for (bool radix_partitioned : {false, true}) {
+    HashJoinPlanNode plan{out_schema,          {&big_scan_plan, &small_scan_plan}, build_col_b, probe_col_b,
+                          HASH_JOIN_MEMORY_BUDGET, radix_partitioned};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+    executor->Init();
+    TupleBatch batch;
+    size_t num_seen = 0;
+    while (executor->NextBatch(&batch)) {
+      ASSERT_GE(TupleBatch::BATCH_SIZE, batch.Size());
+      num_seen += batch.Size();
+    }
+    ASSERT_EQ(5 * num_rows / 10, num_seen);
+  }
+}
+
 // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
 TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
   // Create Values to insert
@@ -217,7 +967,6 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
   InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
 
   auto key_schema = ParseCreateStatement("a bigint");
-  ComparatorType comparator{key_schema.get()};
   auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
       GetTxn(), "index1", "empty_table2", table_info->schema_, *key_schema, {0}, 8, HashFunctionType{});
 
@@ -341,7 +1090,6 @@ TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
 
   // Create the index
   auto key_schema = ParseCreateStatement("a bigint");
-  ComparatorType comparator{key_schema.get()};
   auto *index_info = GetExecutorContext()->GetCatalog()->CreateIndex<KeyType, ValueType, ComparatorType>(
       GetTxn(), "index1", "test_1", GetExecutorContext()->GetCatalog()->GetTable("test_1")->schema_, *key_schema, {0},
       8, HashFunctionType{});
@@ -418,7 +1166,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
 }
 
 // SELECT test_4.colA, test_4.colB, test_6.colA, test_6.colB FROM test_4 JOIN test_6 ON test_4.colA = test_6.colA;
-TEST_F(ExecutorTest, DISABLED_SimpleHashJoinTest) {
+TEST_F(ExecutorTest, SimpleHashJoinTest) {
   // Construct sequential scan of table test_4
   const Schema *out_schema1{};
   std::unique_ptr<AbstractPlanNode> scan_plan1{};
@@ -487,7 +1235,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleHashJoinTest) {
 }
 
 // SELECT COUNT(col_a), SUM(col_a), min(col_a), max(col_a) from test_1;
-TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
+TEST_F(ExecutorTest, SimpleAggregationTest) {
   const Schema *scan_schema;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   {
@@ -537,7 +1285,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
 }
 
 // SELECT count(col_a), col_b, sum(col_c) FROM test_1 Group By col_b HAVING count(col_a) > 100
-TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
+TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   const Schema *scan_schema;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   {
@@ -590,7 +1338,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
 }
 
 // SELECT colA, colB FROM test_3 LIMIT 10
-TEST_F(ExecutorTest, DISABLED_SimpleLimitTest) {
+TEST_F(ExecutorTest, SimpleLimitTest) {
   auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
   auto &schema = table_info->schema_;
 
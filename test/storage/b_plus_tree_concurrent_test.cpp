@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -100,10 +101,10 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
@@ -152,10 +153,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
   // create b+ tree
@@ -203,10 +204,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
@@ -245,10 +246,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
@@ -288,10 +289,10 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
@@ -333,4 +334,116 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, MixedReadWriteTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(256, disk_manager);
+  // small pages, so that the writers split and merge all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Keys k % 3 == 0 stay in the tree, k % 3 == 1 are removed and k % 3 == 2 are inserted.
+  const int64_t num_keys = 3000;
+  const int num_writers = 4;
+  const int num_readers = 4;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    if (key % 3 != 2) {
+      keys.push_back(key);
+    }
+  }
+  InsertHelper(&tree, keys);
+
+  std::vector<int64_t> insert_keys;
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    if (key % 3 == 1) {
+      remove_keys.push_back(key);
+    } else if (key % 3 == 2) {
+      insert_keys.push_back(key);
+    }
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> num_missing{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_readers; i++) {
+    threads.emplace_back([&] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      while (!done) {
+        for (int64_t key = 0; key < num_keys; key += 3) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          if (!tree.GetValue(index_key, &rids) || rids[0].GetSlotNum() != key) {
+            num_missing++;
+          }
+        }
+      }
+    });
+  }
+  // Scans see every key that stays, in order, while the leaves change under them.
+  for (int i = 0; i < num_readers; i++) {
+    threads.emplace_back([&] {
+      while (!done) {
+        int64_t expected_key = 0;
+        int64_t last_key = -1;
+        for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+          int64_t key = (*iterator).second.GetSlotNum();
+          if (key <= last_key) {
+            num_missing++;
+          }
+          last_key = key;
+          if (key % 3 != 0) {
+            continue;
+          }
+          if (key != expected_key) {
+            num_missing++;
+          }
+          expected_key = key + 3;
+        }
+        if (expected_key != num_keys) {
+          num_missing++;
+        }
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < num_writers; i++) {
+    writers.emplace_back([&, i] {
+      InsertHelperSplit(&tree, insert_keys, num_writers, i);
+      DeleteHelperSplit(&tree, remove_keys, num_writers, i);
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, num_missing);
+
+  int64_t expected_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ(expected_key, (*iterator).second.GetSlotNum());
+    expected_key += expected_key % 3 == 0 ? 2 : 1;
+  }
+  EXPECT_EQ(num_keys, expected_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
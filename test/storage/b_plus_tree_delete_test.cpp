@@ -12,6 +12,8 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <map>
+#include <random>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -20,10 +22,10 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
@@ -98,10 +100,10 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
@@ -175,4 +177,178 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+/** Build a small tree, remove most of its keys, and return the number of tree pages that were deleted. */
+static int RemoveAndCountDeletedPages(bool pin_pages) {
+  GenericComparator<8> comparator;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree with small pages, so that removes empty some of them
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  for (int64_t key = 1; key <= 20; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  // The tree pages are the ones between the header page and the next new page.
+  page_id_t end_page_id;
+  EXPECT_NE(nullptr, bpm->NewPage(&end_page_id));
+  bpm->UnpinPage(end_page_id, false);
+  bpm->DeletePage(end_page_id);
+
+  // Pages that a reader has pinned survive the removes that empty them.
+  if (pin_pages) {
+    for (page_id_t tree_page_id = HEADER_PAGE_ID + 1; tree_page_id < end_page_id; tree_page_id++) {
+      EXPECT_NE(nullptr, bpm->FetchPage(tree_page_id));
+    }
+  }
+  for (int64_t key = 1; key <= 15; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  if (pin_pages) {
+    for (page_id_t tree_page_id = HEADER_PAGE_ID + 1; tree_page_id < end_page_id; tree_page_id++) {
+      EXPECT_TRUE(bpm->FlushPage(tree_page_id));
+      bpm->UnpinPage(tree_page_id, false);
+    }
+  }
+  // The next remove deletes them once they are unpinned.
+  index_key.SetFromInteger(16);
+  tree.Remove(index_key, transaction);
+
+  int deleted = 0;
+  for (page_id_t tree_page_id = HEADER_PAGE_ID + 1; tree_page_id < end_page_id; tree_page_id++) {
+    deleted += bpm->FlushPage(tree_page_id) ? 0 : 1;
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 20; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key > 16, tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  return deleted;
+}
+
+TEST(BPlusTreeTests, PinnedDeleteTest) {
+  // Scenario: pages emptied while pinned are deleted as well, only later.
+  int deleted = RemoveAndCountDeletedPages(false);
+  EXPECT_GT(deleted, 1);
+  EXPECT_EQ(deleted, RemoveAndCountDeletedPages(true));
+}
+
+TEST(BPlusTreeTests, NonUniqueKeyTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree with non-unique keys and small pages, so that it splits and merges
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4, false);
+  GenericKey<8> index_key;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Key k has RIDs on 10 pages with k * 30 + 1 slots each, so the RIDs of the last keys fill many posting pages.
+  std::vector<std::pair<int64_t, RID>> entries;
+  for (int64_t key = 0; key < 8; key++) {
+    for (int page = 0; page < 10; page++) {
+      for (int slot = 0; slot <= key * 30; slot++) {
+        entries.emplace_back(key, RID(page * 1000, slot));
+      }
+    }
+  }
+  std::mt19937 generator(15445);
+  std::shuffle(entries.begin(), entries.end(), generator);
+  for (const auto &entry : entries) {
+    index_key.SetFromInteger(entry.first);
+    EXPECT_TRUE(tree.Insert(index_key, entry.second, transaction));
+  }
+  // The same key & value pair goes in once.
+  index_key.SetFromInteger(entries[0].first);
+  EXPECT_FALSE(tree.Insert(index_key, entries[0].second, transaction));
+
+  auto check = [&](const std::vector<std::pair<int64_t, RID>> &expected_entries) {
+    std::map<int64_t, std::vector<RID>> expected;
+    for (const auto &entry : expected_entries) {
+      expected[entry.first].push_back(entry.second);
+    }
+    for (int64_t key = 0; key < 8; key++) {
+      auto &rids = expected[key];
+      std::sort(rids.begin(), rids.end(), [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); });
+      std::vector<RID> result;
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(!rids.empty(), tree.GetValue(index_key, &result));
+      EXPECT_EQ(rids, result);
+    }
+    // The iterator returns a key once per value.
+    std::map<int64_t, std::vector<RID>> scanned;
+    size_t size = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      scanned[(*iterator).first.ToString()].push_back((*iterator).second);
+      size++;
+    }
+    for (const auto &[key, rids] : scanned) {
+      EXPECT_EQ(expected[key], rids);
+    }
+    EXPECT_EQ(expected_entries.size(), size);
+  };
+  check(entries);
+
+  // Remove the RIDs of even slots, one by one.
+  std::vector<std::pair<int64_t, RID>> remaining;
+  for (const auto &entry : entries) {
+    index_key.SetFromInteger(entry.first);
+    if (entry.second.GetSlotNum() % 2 == 0) {
+      tree.Remove(index_key, entry.second, transaction);
+    } else {
+      remaining.push_back(entry);
+    }
+  }
+  check(remaining);
+
+  // Remove a RID that is not there.
+  index_key.SetFromInteger(7);
+  tree.Remove(index_key, RID(0, 0), transaction);
+  check(remaining);
+
+  // Remove the first keys with all of their RIDs, and the RIDs of the others one by one.
+  for (int64_t key = 0; key < 4; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  for (const auto &entry : remaining) {
+    if (entry.first >= 4) {
+      index_key.SetFromInteger(entry.first);
+      tree.Remove(index_key, entry.second, transaction);
+    }
+  }
+  check({});
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
 }  // namespace bustub
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_key_search_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+/** Compares generic keys like GenericComparator, but is not specialized, so that KeySearch falls back to memcmp. */
+template <size_t KeySize>
+class MemcmpComparator {
+ public:
+  inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+};
+
+/** A page worth of sorted keys, some of them negative, with gaps between them to search for. */
+template <size_t KeySize>
+static std::vector<std::pair<GenericKey<KeySize>, RID>> MakePage(size_t size, std::mt19937 *generator) {
+  std::vector<int64_t> integers;
+  std::uniform_int_distribution<int64_t> distribution(-100000, 100000);
+  while (integers.size() < size) {
+    integers.push_back(distribution(*generator) * 2);
+  }
+  std::sort(integers.begin(), integers.end());
+  integers.erase(std::unique(integers.begin(), integers.end()), integers.end());
+  std::vector<std::pair<GenericKey<KeySize>, RID>> page(integers.size());
+  for (size_t i = 0; i < integers.size(); i++) {
+    page[i].first.SetFromInteger(integers[i]);
+    page[i].second.Set(0, i);
+  }
+  return page;
+}
+
+template <size_t KeySize>
+static void CheckSearch() {
+  std::mt19937 generator(15445);
+  GenericComparator<KeySize> comparator;
+  MemcmpComparator<KeySize> memcmp_comparator;
+  using Specialized = KeySearch<GenericKey<KeySize>, RID, GenericComparator<KeySize>>;
+  using Fallback = KeySearch<GenericKey<KeySize>, RID, MemcmpComparator<KeySize>>;
+  for (size_t size : {0, 1, 2, 7, 8, 9, 16, 31, 100, 255}) {
+    auto page = MakePage<KeySize>(size, &generator);
+    int high = page.size();
+    for (int low : {0, 1}) {
+      low = std::min(low, high);
+      for (int64_t integer = -200002; integer <= 200002; integer += 97) {
+        GenericKey<KeySize> key;
+        key.SetFromInteger(integer);
+        EXPECT_EQ(Fallback::LowerBound(page.data(), low, high, key, memcmp_comparator),
+                  Specialized::LowerBound(page.data(), low, high, key, comparator));
+        EXPECT_EQ(Fallback::UpperBound(page.data(), low, high, key, memcmp_comparator),
+                  Specialized::UpperBound(page.data(), low, high, key, comparator));
+      }
+      // Every key of the page, exactly.
+      for (const auto &pair : page) {
+        EXPECT_EQ(Fallback::LowerBound(page.data(), low, high, pair.first, memcmp_comparator),
+                  Specialized::LowerBound(page.data(), low, high, pair.first, comparator));
+        EXPECT_EQ(Fallback::UpperBound(page.data(), low, high, pair.first, memcmp_comparator),
+                  Specialized::UpperBound(page.data(), low, high, pair.first, comparator));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, IntegerKeyTest) {
+  CheckSearch<4>();
+  CheckSearch<8>();
+}
+
+/** Search a full leaf page for random keys, and return the time per search. */
+template <typename Search, typename Comparator>
+static double TimeSearch(const std::vector<std::pair<GenericKey<8>, RID>> &page,
+                         const std::vector<GenericKey<8>> &keys, const Comparator &comparator, int64_t *checksum) {
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &key : keys) {
+    *checksum += Search::LowerBound(page.data(), 0, page.size(), key, comparator);
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / keys.size();
+}
+
+// A microbenchmark, run it with --gtest_also_run_disabled_tests in a release build.
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, DISABLED_IntegerKeyBenchmarkTest) {
+  std::mt19937 generator(15445);
+  // As many keys as a leaf page of 8 byte keys holds.
+  auto page = MakePage<8>((PAGE_SIZE - 28) / sizeof(std::pair<GenericKey<8>, RID>), &generator);
+  std::vector<GenericKey<8>> keys(1000000);
+  std::uniform_int_distribution<int64_t> distribution(-200000, 200000);
+  for (auto &key : keys) {
+    key.SetFromInteger(distribution(generator));
+  }
+
+  GenericComparator<8> comparator;
+  MemcmpComparator<8> memcmp_comparator;
+  int64_t specialized_checksum = 0;
+  int64_t fallback_checksum = 0;
+  double fallback_nanos = TimeSearch<KeySearch<GenericKey<8>, RID, MemcmpComparator<8>>>(page, keys, memcmp_comparator,
+                                                                                          &fallback_checksum);
+  double specialized_nanos = TimeSearch<KeySearch<GenericKey<8>, RID, GenericComparator<8>>>(page, keys, comparator,
+                                                                                              &specialized_checksum);
+  char line[128];
+  snprintf(line, sizeof(line), "%zu keys per page: memcmp search %.1f ns, integer search %.1f ns", page.size(),
+           fallback_nanos, specialized_nanos);
+  std::cout << line << std::endl;
+  EXPECT_EQ(fallback_checksum, specialized_checksum);
+}
+
+#if defined(BUSTUB_KEY_SEARCH_AVX2)
+/** Compare CountBelowAvx2 to a plain count at every offset of a page. */
+template <size_t KeySize>
+static void CheckCountBelowAvx2() {
+  using Search = IntegerKeySearch<KeySize, RID>;
+  constexpr int lanes = 32 / KeySize;
+  std::mt19937 generator(15445);
+  auto page = MakePage<KeySize>(64, &generator);
+  for (size_t offset = 0; offset + lanes <= page.size(); offset++) {
+    for (int64_t integer = -200002; integer <= 200002; integer += 97) {
+      GenericKey<KeySize> key;
+      key.SetFromInteger(integer);
+      auto target = Search::ToWord(key);
+      int less = 0;
+      int not_greater = 0;
+      for (int i = 0; i < lanes; i++) {
+        auto word = Search::ToWord(page[offset + i].first);
+        less += word < target;
+        not_greater += word <= target;
+      }
+      EXPECT_EQ(less, Search::template CountBelowAvx2<false>(page.data() + offset, target));
+      EXPECT_EQ(not_greater, Search::template CountBelowAvx2<true>(page.data() + offset, target));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, Avx2Test) {
+  if (!IntegerKeySearch<8, RID>::HasAvx2()) {
+    GTEST_SKIP() << "the CPU has no AVX2";
+  }
+  CheckCountBelowAvx2<4>();
+  CheckCountBelowAvx2<8>();
+}
+#endif
+
+}  // namespace bustub
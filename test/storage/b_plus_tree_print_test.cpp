@@ -55,7 +55,7 @@ TEST(BptTreeTest, DISABLED_UnitTest) {
   // create KeyComparator and index schema
   std::string create_stmt = "a bigint";
   auto key_schema = ParseCreateStatement(create_stmt);
-  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<8> comparator;
 
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManagerInstance(100, disk_manager);
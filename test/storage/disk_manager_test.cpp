@@ -10,11 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
 
 namespace bustub {
 
@@ -72,6 +77,105 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, BatchedReadWritePageTest) {
+  const size_t num_pages = 200;
+  std::string db_file("test.db");
+  for (auto backend_type : {DiskBackendType::IO_URING, DiskBackendType::POSIX}) {
+    auto dm = DiskManager(db_file, backend_type);
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<DiskRequest> writes(num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+      std::snprintf(data[i].data(), PAGE_SIZE, "page %zu", i);
+    }
+    for (size_t i = 0; i < num_pages; i++) {
+      // Write in reverse order so that the file grows from its end.
+      auto page_id = static_cast<page_id_t>(num_pages - 1 - i);
+      writes[i].is_write_ = true;
+      writes[i].data_ = data[page_id].data();
+      writes[i].page_id_ = page_id;
+    }
+    dm.SubmitRequests(writes.data(), writes.size());
+    EXPECT_TRUE(DiskManager::WaitForRequests(writes.data(), writes.size()));
+    EXPECT_EQ(static_cast<int>(num_pages), dm.GetNumWrites());
+
+    // Read every page back, plus one past the end of the file which should come back zeroed.
+    std::vector<std::vector<char>> buf(num_pages + 1, std::vector<char>(PAGE_SIZE, 'x'));
+    std::vector<DiskRequest> reads(num_pages + 1);
+    for (size_t i = 0; i <= num_pages; i++) {
+      reads[i].is_write_ = false;
+      reads[i].data_ = buf[i].data();
+      reads[i].page_id_ = static_cast<page_id_t>(i);
+    }
+    dm.SubmitRequests(reads.data(), reads.size());
+    EXPECT_TRUE(DiskManager::WaitForRequests(reads.data(), reads.size()));
+    for (size_t i = 0; i < num_pages; i++) {
+      EXPECT_EQ(data[i], buf[i]);
+    }
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), buf[num_pages]);
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PartialLastPageTest) {
+  std::string db_file("test.db");
+  for (auto backend_type : {DiskBackendType::IO_URING, DiskBackendType::POSIX}) {
+    // The file ends in the middle of page 1.
+    std::vector<char> contents(PAGE_SIZE + 100, 'a');
+    FILE *file = std::fopen(db_file.c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    ASSERT_EQ(contents.size(), std::fwrite(contents.data(), 1, contents.size(), file));
+    std::fclose(file);
+
+    auto dm = DiskManager(db_file, backend_type);
+    std::vector<std::vector<char>> buf(2, std::vector<char>(PAGE_SIZE, 'x'));
+    std::vector<DiskRequest> reads(2);
+    for (size_t i = 0; i < reads.size(); i++) {
+      reads[i].is_write_ = false;
+      reads[i].data_ = buf[i].data();
+      reads[i].page_id_ = static_cast<page_id_t>(i);
+    }
+    dm.SubmitRequests(reads.data(), reads.size());
+    EXPECT_TRUE(DiskManager::WaitForRequests(reads.data(), reads.size()));
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 'a'), buf[0]);
+    std::vector<char> last_page(PAGE_SIZE, 0);
+    std::fill(last_page.begin(), last_page.begin() + 100, 'a');
+    EXPECT_EQ(last_page, buf[1]);
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, DiskBackendType::IO_URING, true);
+  Page page;
+  std::strncpy(page.GetData(), "A test string.", PAGE_SIZE);
+
+  DiskRequest write{true, page.GetData(), 3};
+  dm.SubmitRequests(&write, 1);
+  EXPECT_TRUE(DiskManager::WaitForRequests(&write, 1));
+
+  // Unaligned buffers are fine for the blocking calls.
+  char buf[PAGE_SIZE + 1] = {0};
+  dm.ReadPage(3, buf + 1);
+  EXPECT_EQ(std::memcmp(buf + 1, page.GetData(), PAGE_SIZE), 0);
+  dm.WritePage(4, buf + 1);
+
+  Page read_page;
+  DiskRequest read{false, read_page.GetData(), 4};
+  dm.SubmitRequests(&read, 1);
+  EXPECT_TRUE(DiskManager::WaitForRequests(&read, 1));
+  EXPECT_EQ(std::memcmp(read_page.GetData(), page.GetData(), PAGE_SIZE), 0);
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+// Compare two key tuples column by column, the way keys were compared before they were normalized.
+static int CompareValues(const Tuple &lhs, const Tuple &rhs, const Schema *schema) {
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    Value lhs_value = lhs.GetValue(schema, i);
+    Value rhs_value = rhs.GetValue(schema, i);
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, OrderTest) {
+  auto key_schema = ParseCreateStatement("a varchar(4),b int,c double,d smallint");
+  GenericComparator<32> comparator;
+
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int> small(-3, 3);
+  // Strings of a few characters, including zero bytes, so that many keys share a prefix.
+  auto random_string = [&] {
+    std::string str(generator() % 4, 'a');
+    for (auto &c : str) {
+      c = "\0ab\xFF"[generator() % 4];
+    }
+    return str;
+  };
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    std::vector<Value> values{Value(TypeId::VARCHAR, random_string()), Value(TypeId::INTEGER, small(generator) * 1000),
+                              Value(TypeId::DECIMAL, small(generator) / 2.0),
+                              Value(TypeId::SMALLINT, static_cast<int16_t>(small(generator)))};
+    tuples.emplace_back(values, key_schema.get());
+  }
+
+  std::vector<GenericKey<32>> keys(tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++) {
+    keys[i].SetFromKey(tuples[i], key_schema.get());
+    for (uint32_t column = 0; column < key_schema->GetColumnCount(); column++) {
+      EXPECT_EQ(CmpBool::CmpTrue,
+                keys[i].ToValue(key_schema.get(), column).CompareEquals(tuples[i].GetValue(key_schema.get(), column)));
+    }
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    for (size_t j = 0; j < tuples.size(); j++) {
+      int expected = CompareValues(tuples[i], tuples[j], key_schema.get());
+      int actual = comparator(keys[i], keys[j]);
+      EXPECT_EQ(expected < 0, actual < 0);
+      EXPECT_EQ(expected == 0, actual == 0);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, IntegerTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator;
+
+  std::vector<int64_t> integers = {BUSTUB_INT64_MIN, -1000, -1, 0, 1, 255, 256, 1000, BUSTUB_INT64_MAX};
+  for (size_t i = 0; i < integers.size(); i++) {
+    GenericKey<8> key;
+    key.SetFromInteger(integers[i]);
+    EXPECT_EQ(integers[i], key.ToString());
+
+    // A key set from a tuple is the same as one set from the integer.
+    Tuple tuple({Value(TypeId::BIGINT, integers[i])}, key_schema.get());
+    GenericKey<8> tuple_key;
+    tuple_key.SetFromKey(tuple, key_schema.get());
+    EXPECT_EQ(0, comparator(key, tuple_key));
+
+    if (i > 0) {
+      GenericKey<8> prev_key;
+      prev_key.SetFromInteger(integers[i - 1]);
+      EXPECT_LT(comparator(prev_key, key), 0);
+      EXPECT_GT(comparator(key, prev_key), 0);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NullAndBoundsTest) {
+  auto key_schema = ParseCreateStatement("a varchar(32),b int");
+  GenericComparator<16> comparator;
+
+  // A NULL varchar is neither the empty string nor equal to it, and sorts first.
+  Tuple null_tuple({ValueFactory::GetNullValueByType(TypeId::VARCHAR), Value(TypeId::INTEGER, 1)}, key_schema.get());
+  Tuple empty_tuple({Value(TypeId::VARCHAR, ""), Value(TypeId::INTEGER, 0)}, key_schema.get());
+  GenericKey<16> null_key;
+  GenericKey<16> empty_key;
+  null_key.SetFromKey(null_tuple, key_schema.get());
+  empty_key.SetFromKey(empty_tuple, key_schema.get());
+  EXPECT_LT(comparator(null_key, empty_key), 0);
+  EXPECT_TRUE(null_key.ToValue(key_schema.get(), 0).IsNull());
+  EXPECT_EQ(1, null_key.ToValue(key_schema.get(), 1).GetAs<int32_t>());
+  EXPECT_FALSE(empty_key.ToValue(key_schema.get(), 0).IsNull());
+  EXPECT_EQ(0, empty_key.ToValue(key_schema.get(), 1).GetAs<int32_t>());
+
+  // A string and an integer that take more than 16 bytes do not fit.
+  Tuple long_tuple({Value(TypeId::VARCHAR, std::string(11, 'a')), Value(TypeId::INTEGER, 0)}, key_schema.get());
+  GenericKey<16> long_key;
+  EXPECT_THROW(long_key.SetFromKey(long_tuple, key_schema.get()), Exception);
+  Tuple fitting_tuple({Value(TypeId::VARCHAR, std::string(10, 'a')), Value(TypeId::INTEGER, 0)}, key_schema.get());
+  GenericKey<16> fitting_key;
+  fitting_key.SetFromKey(fitting_tuple, key_schema.get());
+  EXPECT_EQ(std::string(10, 'a'), fitting_key.ToValue(key_schema.get(), 0).ToString());
+
+  // Decoding stops at the end of the key, even if the string never ends.
+  GenericKey<16> garbage_key;
+  memset(garbage_key.data_, 'a', sizeof(garbage_key.data_));
+  EXPECT_THROW(garbage_key.ToValue(key_schema.get(), 0), Exception);
+}
+
+}  // namespace bustub
@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_test.cpp
+//
+// Identification: test/table/free_space_map_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, ReuseFreedSpaceTest) {
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 200}}};
+  Tuple tuple{std::vector<Value>{Value(TypeId::VARCHAR, std::string(200, 'x'))}, &schema};
+
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 1000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rid_v.push_back(rid);
+  }
+  auto *fsm = table->GetFreeSpaceMap();
+  size_t num_pages = fsm->GetNumPages();
+  EXPECT_GT(num_pages, 1);
+  // Every page except the last one is full.
+  EXPECT_EQ(fsm->GetLastPageId(), rid_v.back().GetPageId());
+
+  // Free up all the tuples of the first page.
+  int num_freed = 0;
+  for (const auto &rid : rid_v) {
+    if (rid.GetPageId() == table->GetFirstPageId()) {
+      table->ApplyDelete(rid, transaction);
+      num_freed++;
+    }
+  }
+
+  // New tuples should go into the freed space instead of growing the table.
+  bool reused_first_page = false;
+  for (int i = 0; i < num_freed; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    reused_first_page = reused_first_page || rid.GetPageId() == table->GetFirstPageId();
+  }
+  EXPECT_TRUE(reused_first_page);
+  EXPECT_EQ(num_pages, fsm->GetNumPages());
+
+  // Open the table again without the root of the map, which then has to be rebuilt from the table pages.
+  page_id_t fsm_page_id = fsm->GetRootPageId();
+  page_id_t last_page_id = fsm->GetLastPageId();
+  page_id_t first_page_id = table->GetFirstPageId();
+  delete table;
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, first_page_id);
+  fsm = table->GetFreeSpaceMap();
+  EXPECT_NE(fsm_page_id, fsm->GetRootPageId());
+  EXPECT_EQ(num_pages, fsm->GetNumPages());
+  EXPECT_EQ(last_page_id, fsm->GetLastPageId());
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  EXPECT_EQ(num_pages, fsm->GetNumPages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, PersistenceTest) {
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 200}}};
+  Tuple tuple{std::vector<Value>{Value(TypeId::VARCHAR, std::string(200, 'x'))}, &schema};
+
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 2000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    rid_v.push_back(rid);
+  }
+  // Free up a page in the middle of the table.
+  page_id_t victim_page_id = rid_v[rid_v.size() / 2].GetPageId();
+  int num_freed = 0;
+  for (const auto &rid : rid_v) {
+    if (rid.GetPageId() == victim_page_id) {
+      table->ApplyDelete(rid, transaction);
+      num_freed++;
+    }
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  page_id_t last_page_id = table->GetFreeSpaceMap()->GetLastPageId();
+  page_id_t fsm_page_id = table->GetFreeSpaceMap()->GetRootPageId();
+  size_t num_pages = table->GetFreeSpaceMap()->GetNumPages();
+
+  // Restart: write everything out and open the table again from a cold buffer pool.
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete buffer_pool_manager;
+  buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, first_page_id, fsm_page_id);
+
+  EXPECT_EQ(fsm_page_id, table->GetFreeSpaceMap()->GetRootPageId());
+  EXPECT_EQ(num_pages, table->GetFreeSpaceMap()->GetNumPages());
+  EXPECT_EQ(last_page_id, table->GetFreeSpaceMap()->GetLastPageId());
+  bool reused_victim_page = false;
+  for (int i = 0; i < num_freed; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    reused_victim_page = reused_victim_page || rid.GetPageId() == victim_page_id;
+  }
+  EXPECT_TRUE(reused_victim_page);
+  EXPECT_EQ(num_pages, table->GetFreeSpaceMap()->GetNumPages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapTest, ReadAheadScanTest) {
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::VARCHAR, 200}}};
+  Tuple tuple{std::vector<Value>{Value(TypeId::VARCHAR, std::string(200, 'x'))}, &schema};
+
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  page_id_t fsm_page_id = table->GetFreeSpaceMap()->GetRootPageId();
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete buffer_pool_manager;
+
+  // Scan from a cold buffer pool that is smaller than the read-ahead window.
+  buffer_pool_manager = new BufferPoolManagerInstance(10, disk_manager);
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, first_page_id, fsm_page_id);
+
+  // The pages read ahead are the ones that follow in the page chain.
+  std::vector<page_id_t> page_ids;
+  table->GetFreeSpaceMap()->GetPagesAfter(first_page_id, READ_AHEAD_PAGES, &page_ids);
+  page_id_t page_id = first_page_id;
+  for (auto next_page_id : page_ids) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(next_page_id, page->GetNextPageId());
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  int num_scanned = 0;
+  for (auto it = table->Begin(transaction); it != table->End(); ++it) {
+    EXPECT_EQ(tuple.GetLength(), it->GetLength());
+    num_scanned++;
+  }
+  EXPECT_EQ(num_tuples, num_scanned);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+}  // namespace bustub
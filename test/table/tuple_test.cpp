@@ -24,7 +24,7 @@
 
 namespace bustub {
 // NOLINTNEXTLINE
-TEST(TupleTest, DISABLED_TableHeapTest) {
+TEST(TupleTest, TableHeapTest) {
   // test1: parse create sql statement
   std::string create_stmt = "a varchar(20), b smallint, c bigint, d bool, e varchar(16)";
   Column col1{"a", TypeId::VARCHAR, 20};
@@ -67,8 +67,11 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   remove("test.db");  // remove db file
   remove("test.log");
   delete table;
+  delete log_manager;
+  delete lock_manager;
   delete buffer_pool_manager;
   delete disk_manager;
+  delete transaction;
 }
 
 }  // namespace bustub